@@ -82,11 +82,20 @@ typedef struct BcLexKeyword
 /// BcLexKeyword's data field.
 #define BC_LEX_CHAR_MSB(bit) ((bit) << (CHAR_BIT - 1))
 
+/// The bit in BcLexKeyword's data field that marks keywords that only the
+/// builtin math libraries can use.
+#define BC_LEX_KW_LIB_BIT (BC_LEX_CHAR_MSB(1) >> 1)
+
 /// Returns non-zero if the keyword is POSIX, zero otherwise.
 #define BC_LEX_KW_POSIX(kw) ((kw)->data & (BC_LEX_CHAR_MSB(1)))
 
+/// Returns non-zero if the keyword can only be used by the builtin math
+/// libraries, zero otherwise. Everywhere else, it is a name.
+#define BC_LEX_KW_LIB(kw) ((kw)->data & BC_LEX_KW_LIB_BIT)
+
 /// Returns the length of the keyword.
-#define BC_LEX_KW_LEN(kw) ((size_t) ((kw)->data & ~(BC_LEX_CHAR_MSB(1))))
+#define BC_LEX_KW_LEN(kw) \
+	((size_t) ((kw)->data & ~(BC_LEX_CHAR_MSB(1) | BC_LEX_KW_LIB_BIT)))
 
 /// A macro to easily build a keyword entry. See bc_lex_kws in src/data.c.
 #define BC_LEX_KW_ENTRY(a, b, c)                                              \
@@ -94,17 +103,25 @@ typedef struct BcLexKeyword
 		.data = ((b) & ~(BC_LEX_CHAR_MSB(1))) | BC_LEX_CHAR_MSB(c), .name = a \
 	}
 
+/// A macro to build the entry of a keyword that only the builtin math libraries
+/// can use. These back library functions with builtins without taking their
+/// names away from scripts. See bc_lex_kws in src/data.c.
+#define BC_LEX_KW_LIB_ENTRY(a, b)                  \
+	{                                              \
+		.data = (b) | BC_LEX_KW_LIB_BIT, .name = a \
+	}
+
 #if BC_ENABLE_EXTRA_MATH
 
 /// A macro for the number of keywords bc has. This has to be updated if any are
 /// added. This is for the redefined_kws field of the BcVm struct.
-#define BC_LEX_NKWS (37)
+#define BC_LEX_NKWS (44)
 
 #else // BC_ENABLE_EXTRA_MATH
 
 /// A macro for the number of keywords bc has. This has to be updated if any are
 /// added. This is for the redefined_kws field of the BcVm struct.
-#define BC_LEX_NKWS (33)
+#define BC_LEX_NKWS (40)
 
 #endif // BC_ENABLE_EXTRA_MATH
 
@@ -126,6 +126,21 @@ typedef enum BclError
 
 } BclError;
 
+typedef enum BclOp
+{
+	BCL_OP_ADD,
+	BCL_OP_SUB,
+	BCL_OP_MUL,
+	BCL_OP_DIV,
+	BCL_OP_MOD,
+	BCL_OP_POW,
+	BCL_OP_LSHIFT,
+	BCL_OP_RSHIFT,
+
+	BCL_OP_NELEMS,
+
+} BclOp;
+
 typedef struct BclNumber
 {
 	size_t i;
@@ -136,6 +151,14 @@ struct BclCtxt;
 
 typedef struct BclCtxt* BclContext;
 
+typedef void (*BclWriter)(const char* buf, size_t len, void* data);
+
+typedef bool (*BclProgress)(void* data);
+
+struct BclThreadPool;
+
+typedef struct BclThreadPool* BclPool;
+
 BclError
 bcl_start(void);
 
@@ -187,6 +210,24 @@ bcl_ctxt_free(BclContext ctxt);
 void
 bcl_ctxt_freeNums(BclContext ctxt);
 
+bool
+bcl_ctxt_arena(BclContext ctxt);
+
+void
+bcl_ctxt_setArena(BclContext ctxt, bool arena);
+
+void
+bcl_ctxt_cancel(BclContext ctxt);
+
+bool
+bcl_ctxt_cancelled(BclContext ctxt);
+
+void
+bcl_ctxt_clearCancel(BclContext ctxt);
+
+void
+bcl_ctxt_setProgress(BclContext ctxt, BclProgress progress, void* data);
+
 size_t
 bcl_ctxt_scale(BclContext ctxt);
 
@@ -208,12 +249,18 @@ bcl_ctxt_setObase(BclContext ctxt, size_t obase);
 BclError
 bcl_err(BclNumber n);
 
+BclError
+bcl_err_ctx(BclContext ctxt, BclNumber n);
+
 BclNumber
 bcl_num_create(void);
 
 void
 bcl_num_free(BclNumber n);
 
+void
+bcl_num_free_ctx(BclContext ctxt, BclNumber n);
+
 bool
 bcl_num_neg(BclNumber n);
 
@@ -244,6 +291,20 @@ bcl_bigdig_keep(BclNumber n, BclBigDig* result);
 BclNumber
 bcl_bigdig2num(BclBigDig val);
 
+BclError
+bcl_bytes(BclNumber n, unsigned char* buf, size_t cap, size_t* needed,
+          bool big_endian);
+
+BclError
+bcl_bytes_keep(BclNumber n, unsigned char* buf, size_t cap, size_t* needed,
+               bool big_endian);
+
+BclNumber
+bcl_bytes2num(const unsigned char* bytes, size_t len, bool big_endian);
+
+BclNumber
+bcl_words2num(const uint64_t* words, size_t len);
+
 BclNumber
 bcl_add(BclNumber a, BclNumber b);
 
@@ -292,12 +353,168 @@ bcl_rshift(BclNumber a, BclNumber b);
 BclNumber
 bcl_rshift_keep(BclNumber a, BclNumber b);
 
+BclError
+bcl_add_into(BclNumber a, BclNumber b, BclNumber c);
+
+BclError
+bcl_sub_into(BclNumber a, BclNumber b, BclNumber c);
+
+BclError
+bcl_mul_into(BclNumber a, BclNumber b, BclNumber c);
+
+BclError
+bcl_div_into(BclNumber a, BclNumber b, BclNumber c);
+
+BclError
+bcl_mod_into(BclNumber a, BclNumber b, BclNumber c);
+
+BclError
+bcl_pow_into(BclNumber a, BclNumber b, BclNumber c);
+
 BclNumber
 bcl_sqrt(BclNumber a);
 
 BclNumber
 bcl_sqrt_keep(BclNumber a);
 
+BclNumber
+bcl_add_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_add_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_sub_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_sub_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_mul_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_mul_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_div_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_div_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_mod_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_mod_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_pow_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_pow_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b);
+
+BclNumber
+bcl_sqrt_ctx(BclContext ctxt, BclNumber a);
+
+BclNumber
+bcl_sqrt_keep_ctx(BclContext ctxt, BclNumber a);
+
+BclNumber
+bcl_exp(BclNumber a);
+
+BclNumber
+bcl_exp_keep(BclNumber a);
+
+BclNumber
+bcl_ln(BclNumber a);
+
+BclNumber
+bcl_ln_keep(BclNumber a);
+
+BclNumber
+bcl_sin(BclNumber a);
+
+BclNumber
+bcl_sin_keep(BclNumber a);
+
+BclNumber
+bcl_cos(BclNumber a);
+
+BclNumber
+bcl_cos_keep(BclNumber a);
+
+BclNumber
+bcl_atan(BclNumber a);
+
+BclNumber
+bcl_atan_keep(BclNumber a);
+
+BclNumber
+bcl_log(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_log_keep(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_root(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_root_keep(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_gcd(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_gcd_keep(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_lcm(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_lcm_keep(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_modinv(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_modinv_keep(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_round(BclNumber a, size_t places);
+
+BclNumber
+bcl_round_keep(BclNumber a, size_t places);
+
+BclNumber
+bcl_ceil(BclNumber a, size_t places);
+
+BclNumber
+bcl_ceil_keep(BclNumber a, size_t places);
+
+BclNumber
+bcl_fact(BclNumber a);
+
+BclNumber
+bcl_fact_keep(BclNumber a);
+
+BclNumber
+bcl_fib(BclNumber a);
+
+BclNumber
+bcl_fib_keep(BclNumber a);
+
+BclNumber
+bcl_perm(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_perm_keep(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_comb(BclNumber a, BclNumber b);
+
+BclNumber
+bcl_comb_keep(BclNumber a, BclNumber b);
+
 BclError
 bcl_divmod(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d);
 
@@ -310,6 +527,50 @@ bcl_modexp(BclNumber a, BclNumber b, BclNumber c);
 BclNumber
 bcl_modexp_keep(BclNumber a, BclNumber b, BclNumber c);
 
+BclError
+bcl_batch(BclOp op, const BclNumber* a, const BclNumber* b, BclNumber* c,
+          size_t n);
+
+BclError
+bcl_batch_keep(BclOp op, const BclNumber* a, const BclNumber* b, BclNumber* c,
+               size_t n);
+
+BclPool
+bcl_pool_create(size_t nthreads);
+
+void
+bcl_pool_free(BclPool pool);
+
+size_t
+bcl_pool_threads(BclPool pool);
+
+BclError
+bcl_pool_batch(BclPool pool, BclContext ctxt, BclOp op, const char* const* a,
+               const char* const* b, char** c, BclError* errs, size_t n);
+
+BclError
+bcl_pool_modexp(BclPool pool, BclContext ctxt, const char* const* a,
+                const char* const* b, const char* const* m, char** c,
+                BclError* errs, size_t n);
+
+BclNumber
+bcl_fma(BclNumber a, BclNumber b, BclNumber c);
+
+BclNumber
+bcl_fma_keep(BclNumber a, BclNumber b, BclNumber c);
+
+BclNumber
+bcl_sum(const BclNumber* a, size_t n);
+
+BclNumber
+bcl_sum_keep(const BclNumber* a, size_t n);
+
+BclNumber
+bcl_dot(const BclNumber* a, const BclNumber* b, size_t n);
+
+BclNumber
+bcl_dot_keep(const BclNumber* a, const BclNumber* b, size_t n);
+
 ssize_t
 bcl_cmp(BclNumber a, BclNumber b);
 
@@ -322,12 +583,36 @@ bcl_one(BclNumber n);
 BclNumber
 bcl_parse(const char* restrict val);
 
+BclNumber
+bcl_parse_n(const char* restrict val, size_t len);
+
+BclNumber
+bcl_parse_ctx(BclContext ctxt, const char* restrict val);
+
 char*
 bcl_string(BclNumber n);
 
 char*
 bcl_string_keep(BclNumber n);
 
+char*
+bcl_string_ctx(BclContext ctxt, BclNumber n);
+
+char*
+bcl_string_keep_ctx(BclContext ctxt, BclNumber n);
+
+BclError
+bcl_string_into(BclNumber n, char* buf, size_t cap, size_t* needed);
+
+BclError
+bcl_string_into_keep(BclNumber n, char* buf, size_t cap, size_t* needed);
+
+BclError
+bcl_string_write(BclNumber n, BclWriter w, void* data);
+
+BclError
+bcl_string_write_keep(BclNumber n, BclWriter w, void* data);
+
 BclNumber
 bcl_irand(BclNumber a);
 
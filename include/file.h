@@ -79,6 +79,14 @@ typedef struct BcFile
 	// The capacity (max number of chars) of the buffer.
 	size_t cap;
 
+	// The capacity the buffer is allowed to grow to. If this is equal to cap,
+	// the buffer never grows, and writes that do not fit cause a flush.
+	size_t max;
+
+	// True if buf was allocated by the file itself (because it grew) and needs
+	// to be freed, false if it was given in bc_file_init().
+	bool alloc;
+
 } BcFile;
 
 #endif // BC_ENABLE_LINE_LIB
@@ -149,6 +157,17 @@ bc_file_init(BcFile* f, FILE* file, bool errors_fatal);
 void
 bc_file_init(BcFile* f, int fd, char* buf, size_t cap, bool errors_fatal);
 
+/**
+ * Allows a file's buffer to grow up to a maximum size instead of flushing when
+ * it fills up. This is meant for when output is not going to a terminal, where
+ * nobody is waiting on each line and fewer, larger writes are better.
+ * @param f    The file.
+ * @param max  The maximum capacity of the buffer. If this is not greater than
+ *             the current capacity, it does nothing.
+ */
+void
+bc_file_setMax(BcFile* f, size_t max);
+
 #endif // BC_ENABLE_LINE_LIB
 
 /**
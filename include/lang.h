@@ -143,6 +143,12 @@ typedef enum BcInst
 	/// Push a variable onto the results stack.
 	BC_INST_VAR,
 
+#if BC_ENABLED
+	/// Push a local variable of a bc function onto the results stack. Its index
+	/// is the offset of the local from the top of the locals vector.
+	BC_INST_LOCAL,
+#endif // BC_ENABLED
+
 	/// Push an array element onto the results stack.
 	BC_INST_ARRAY_ELEM,
 
@@ -186,6 +192,9 @@ typedef enum BcInst
 	BC_INST_IRAND,
 #endif // BC_ENABLE_EXTRA_MATH
 
+	/// Another builtin function.
+	BC_INST_FIB,
+
 	/// Asciify.
 	BC_INST_ASCIIFY,
 
@@ -272,6 +281,24 @@ typedef enum BcInst
 	/// Do divide and modulus at the same time.
 	BC_INST_DIVMOD,
 
+	/// Take the nth root of a number.
+	BC_INST_ROOT,
+
+	/// Greatest common divisor.
+	BC_INST_GCD,
+
+	/// Least common multiple.
+	BC_INST_LCM,
+
+	/// Modular inverse.
+	BC_INST_MODINV,
+
+	/// Permutations.
+	BC_INST_PERM,
+
+	/// Combinations.
+	BC_INST_COMB,
+
 	/// Turns a number into a string and prints it.
 	BC_INST_PRINT_STREAM,
 
@@ -380,6 +407,48 @@ typedef struct BcConst
 
 } BcConst;
 
+#if BC_ENABLED
+
+/// Returns the bit in the globals field of BcFunc for the global that @a inst
+/// pushes, which must be BC_INST_IBASE, BC_INST_OBASE, BC_INST_SCALE, or
+/// BC_INST_SEED. For ibase, obase, and scale, the bit is the same as the index
+/// in the globals array of BcProgram.
+#define BC_FUNC_GLOBAL(inst) ((uint8_t) (1 << ((inst) - BC_INST_IBASE)))
+
+/// The globals field for a function that could modify any global.
+#define BC_FUNC_GLOBALS_ALL (UINT8_MAX)
+
+/// The number of globals that a memoized result depends on. They are ibase,
+/// obase, and scale, which are the first ones in the globals array of
+/// BcProgram.
+#define BC_MEMO_GLOBALS (3)
+
+/// A memoized result of a pure function. The arguments and the result itself
+/// are in the memo_nums vector of the function.
+typedef struct BcMemo
+{
+	/// A hash of the arguments and the globals. Most mismatches are caught by
+	/// comparing it.
+	size_t hash;
+
+	/// The index of the next entry in the same bucket of the memo table, or
+	/// BC_MEMO_NONE if this is the last one.
+	size_t next;
+
+	/// The values of ibase, obase, and scale when the result was calculated.
+	BcBigDig globals[BC_MEMO_GLOBALS];
+
+	/// True if the entry was used since the clock hand last passed it. Entries
+	/// that were not are the ones that are replaced when the memo is full.
+	bool used;
+
+} BcMemo;
+
+/// The index that ends a bucket of a memo table.
+#define BC_MEMO_NONE (SIZE_MAX)
+
+#endif // BC_ENABLED
+
 /// A function. This is also used in dc, not just bc. The reason is that strings
 /// are executed in dc, and they are converted to functions in order to be
 /// executed.
@@ -401,6 +470,22 @@ typedef struct BcFunc
 	/// The number of parameters the function takes.
 	size_t nparams;
 
+	/// The memoized results of a pure function. This is a vector of BcMemo.
+	BcVec memo;
+
+	/// The arguments and results of the entries in memo. Each entry takes
+	/// nparams + 1 numbers, with the result last.
+	BcVec memo_nums;
+
+	/// The buckets of the hash table of memo. Each is the index of the first
+	/// entry in memo with a hash in that bucket. This is empty until the first
+	/// result is memoized.
+	BcVec memo_table;
+
+	/// The clock hand, the index of the next entry in memo to consider
+	/// replacing when the memo is full.
+	size_t memo_hand;
+
 #endif // BC_ENABLED
 
 	/// The function's name.
@@ -409,6 +494,14 @@ typedef struct BcFunc
 #if BC_ENABLED
 	/// True if the function is a void function.
 	bool voidfn;
+
+	/// True if the function was defined as pure and the parser found nothing
+	/// that would make memoizing its results wrong.
+	bool pure;
+
+	/// The globals (made with BC_FUNC_GLOBAL()) that the function can modify.
+	/// With global stacks, calls only save and restore these.
+	uint8_t globals;
 #endif // BC_ENABLED
 
 } BcFunc;
@@ -419,6 +512,11 @@ typedef enum BcResultType
 	/// Result is a variable.
 	BC_RESULT_VAR,
 
+#if BC_ENABLED
+	/// Result is a local variable in the frame of a bc function.
+	BC_RESULT_LOCAL,
+#endif // BC_ENABLED
+
 	/// Result is an array element.
 	BC_RESULT_ARRAY_ELEM,
 
@@ -542,6 +640,12 @@ typedef struct BcAuto
 	/// The type of the variable.
 	BcType type;
 
+	/// True if the variable lives in a slot in the frame of the function
+	/// instead of on its variable stack. Only variables that no other function
+	/// uses without declaring them can, because those functions must be able
+	/// to see the locals of their callers.
+	bool slot;
+
 } BcAuto;
 #endif // BC_ENABLED
 
@@ -578,6 +682,15 @@ bc_func_insert(BcFunc* f, struct BcProgram* p, char* name, BcType type,
 void
 bc_func_reset(BcFunc* f);
 
+#if BC_ENABLED
+/**
+ * Forgets all of the memoized results of a function.
+ * @param f  The function whose results should be forgotten.
+ */
+void
+bc_func_forget(BcFunc* f);
+#endif // BC_ENABLED
+
 #if BC_DEBUG
 /**
  * Frees a function. This is a destructor. This is only used in debug builds
@@ -350,6 +350,9 @@ typedef enum BcLexType
 
 #endif // BC_ENABLE_EXTRA_MATH
 
+	/// bc fib keyword.
+	BC_LEX_KW_FIB,
+
 	/// bc asciffy keyword.
 	BC_LEX_KW_ASCIIFY,
 
@@ -359,6 +362,24 @@ typedef enum BcLexType
 	/// bc divmod keyword.
 	BC_LEX_KW_DIVMOD,
 
+	/// bc root keyword.
+	BC_LEX_KW_ROOT,
+
+	/// bc gcd keyword.
+	BC_LEX_KW_GCD,
+
+	/// bc lcm keyword.
+	BC_LEX_KW_LCM,
+
+	/// bc modinv keyword.
+	BC_LEX_KW_MODINV,
+
+	/// bc perm keyword.
+	BC_LEX_KW_PERM,
+
+	/// bc comb keyword.
+	BC_LEX_KW_COMB,
+
 	/// bc quit keyword.
 	BC_LEX_KW_QUIT,
 
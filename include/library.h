@@ -47,11 +47,15 @@
 #include <num.h>
 #include <vm.h>
 
-#if BC_ENABLE_MEMCHECK
+#if BC_C11 && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#endif // BC_C11 && !defined(__STDC_NO_ATOMICS__)
 
 /**
- * A typedef for Valgrind builds. This is to add a generation index for error
- * checking.
+ * A slot in a context's table of numbers. The generation index is bumped every
+ * time the slot is freed, and it is also stored in the top byte of every
+ * BclNumber that refers to the slot, so stale BclNumbers can be caught with a
+ * single comparison.
  */
 typedef struct BclNum
 {
@@ -63,66 +67,80 @@ typedef struct BclNum
 
 } BclNum;
 
+/// The log base 2 of the number of slots in a slab of a context's numbers.
+#define BCL_NUMS_SLAB_SHIFT (8)
+
+/// The number of slots in a slab of a context's numbers.
+#define BCL_NUMS_SLAB ((size_t) 1 << BCL_NUMS_SLAB_SHIFT)
+
+/// The shift to the generation index in a BclNumber.
+#define BCL_GEN_SHIFT ((sizeof(size_t) - 1) * CHAR_BIT)
+
+/// The maximum number of slots in a context, which is limited by the bits that
+/// are left for the index after the generation index.
+#define BCL_NUMS_MAX (((size_t) 1 << BCL_GEN_SHIFT) - 1)
+
+/// The end of the free list of a context's numbers.
+#define BCL_NUMS_END (SIZE_MAX)
+
+/**
+ * Returns the index of the next free slot after a free slot. Free slots reuse
+ * the capacity of their number for the link.
+ * @param bn  The free slot.
+ * @return    The index of the next free slot, or BCL_NUMS_END.
+ */
+#define BCL_NUM_NEXT(bn) ((bn)->n.cap)
+
 /**
  * Clears the generation byte in a BclNumber and returns the value.
  * @param n  The BclNumber.
  * @return   The value of the index.
  */
-#define BCL_NO_GEN(n) \
-	((n).i & ~(((size_t) UCHAR_MAX) << ((sizeof(size_t) - 1) * CHAR_BIT)))
+#define BCL_NO_GEN(n) ((n).i & ~(((size_t) UCHAR_MAX) << BCL_GEN_SHIFT))
 
 /**
  * Gets the generation index in a BclNumber.
  * @param n  The BclNumber.
  * @return   The generation index.
  */
-#define BCL_GET_GEN(n) ((n).i >> ((sizeof(size_t) - 1) * CHAR_BIT))
+#define BCL_GET_GEN(n) ((n).i >> BCL_GEN_SHIFT)
+
+/**
+ * Turns an index into a pointer to its slot. Slabs never move, so the pointer
+ * stays valid until the number is freed.
+ * @param c  The context.
+ * @param i  The index.
+ */
+#define BCL_SLOT(c, i)                                      \
+	(((BclNum**) (c)->nums.v)[(i) >> BCL_NUMS_SLAB_SHIFT] + \
+	 ((i) & (BCL_NUMS_SLAB - 1)))
 
 /**
  * Turns a BclNumber into a BcNum.
  * @param c  The context.
  * @param n  The BclNumber.
  */
-#define BCL_NUM(c, n) ((BclNum*) bc_vec_item(&(c)->nums, BCL_NO_GEN(n)))
+#define BCL_NUM(c, n) BCL_SLOT(c, BCL_NO_GEN(n))
 
 /**
  * Clears the generation index top byte in the BclNumber.
  * @param n  The BclNumber.
  */
-#define BCL_CLEAR_GEN(n)                                                       \
-	do                                                                         \
-	{                                                                          \
-		(n).i &= ~(((size_t) UCHAR_MAX) << ((sizeof(size_t) - 1) * CHAR_BIT)); \
-	}                                                                          \
-	while (0)
-
-#define BCL_CHECK_NUM_GEN(c, bn)         \
-	do                                   \
-	{                                    \
-		size_t gen_ = BCL_GET_GEN(bn);   \
-		BclNum* ptr_ = BCL_NUM(c, bn);   \
-		if (BCL_NUM_ARRAY(ptr_) == NULL) \
-		{                                \
-			bcl_nonexistentNum();        \
-		}                                \
-		if (gen_ != ptr_->gen_idx)       \
-		{                                \
-			bcl_invalidGeneration();     \
-		}                                \
-	}                                    \
+#define BCL_CLEAR_GEN(n)                                   \
+	do                                                     \
+	{                                                      \
+		(n).i &= ~(((size_t) UCHAR_MAX) << BCL_GEN_SHIFT); \
+	}                                                      \
 	while (0)
 
-#define BCL_CHECK_NUM_VALID(c, bn)    \
-	do                                \
-	{                                 \
-		size_t idx_ = BCL_NO_GEN(bn); \
-		if ((c)->nums.len <= idx_)    \
-		{                             \
-			bcl_numIdxOutOfRange();   \
-		}                             \
-		BCL_CHECK_NUM_GEN(c, bn);     \
-	}                                 \
-	while (0)
+/**
+ * Returns true if the generation index of a BclNumber does not match its slot,
+ * which means that the number was freed. The index must be in range.
+ * @param c  The context.
+ * @param n  The BclNumber.
+ * @return   True if the BclNumber is stale, false otherwise.
+ */
+#define BCL_NUM_STALE(c, n) (BCL_NUM(c, n)->gen_idx != BCL_GET_GEN(n))
 
 /**
  * Returns the limb array of the number.
@@ -152,6 +170,36 @@ typedef struct BclNum
  */
 #define BCL_NUM_NUM_NP(bn) (&(bn).n)
 
+#if BC_ENABLE_MEMCHECK
+
+#define BCL_CHECK_NUM_GEN(c, bn)         \
+	do                                   \
+	{                                    \
+		size_t gen_ = BCL_GET_GEN(bn);   \
+		BclNum* ptr_ = BCL_NUM(c, bn);   \
+		if (BCL_NUM_ARRAY(ptr_) == NULL) \
+		{                                \
+			bcl_nonexistentNum();        \
+		}                                \
+		if (gen_ != ptr_->gen_idx)       \
+		{                                \
+			bcl_invalidGeneration();     \
+		}                                \
+	}                                    \
+	while (0)
+
+#define BCL_CHECK_NUM_VALID(c, bn)    \
+	do                                \
+	{                                 \
+		size_t idx_ = BCL_NO_GEN(bn); \
+		if ((c)->nnums <= idx_)       \
+		{                             \
+			bcl_numIdxOutOfRange();   \
+		}                             \
+		BCL_CHECK_NUM_GEN(c, bn);     \
+	}                                 \
+	while (0)
+
 // These functions only abort. They exist to give developers some idea of what
 // went wrong when bugs are found, if they look at the Valgrind stack trace.
 
@@ -166,24 +214,9 @@ bcl_numIdxOutOfRange(void);
 
 #else // BC_ENABLE_MEMCHECK
 
-/**
- * A typedef for non-Valgrind builds.
- */
-typedef BcNum BclNum;
-
-#define BCL_NO_GEN(n) ((n).i)
-#define BCL_NUM(c, n) ((BclNum*) bc_vec_item(&(c)->nums, (n).i))
-#define BCL_CLEAR_GEN(n) ((void) (n))
-
 #define BCL_CHECK_NUM_GEN(c, bn)
 #define BCL_CHECK_NUM_VALID(c, n)
 
-#define BCL_NUM_ARRAY(bn) ((bn)->num)
-#define BCL_NUM_ARRAY_NP(bn) ((bn).num)
-
-#define BCL_NUM_NUM(bn) (bn)
-#define BCL_NUM_NUM_NP(bn) (&(bn))
-
 #endif // BC_ENABLE_MEMCHECK
 
 /**
@@ -200,12 +233,15 @@ typedef BcNum BclNum;
 	while (0)
 
 /**
- * A footer for functions that do not return an error code.
+ * A footer for functions that do not return an error code. Errors never unwind
+ * past the library's entry points, so this also stops any unwinding; otherwise,
+ * the next error would pop a jmp_buf too many.
  */
 #define BC_FUNC_FOOTER_NO_ERR(vm) \
 	do                            \
 	{                             \
 		BC_UNSETJMP(vm);          \
+		vm->sig_pop = 0;          \
 	}                             \
 	while (0)
 
@@ -257,6 +293,26 @@ typedef BcNum BclNum;
 			n_num_.i = 0 - (size_t) BCL_ERROR_INVALID_CONTEXT; \
 			return n_num_;                                     \
 		}                                                      \
+		BCL_USE_CTXT(vm, c);                                   \
+	}                                                          \
+	while (0)
+
+/**
+ * A header to check a context passed in by the caller and return an error
+ * encoded in a number if it is bad.
+ * @param vm  The BcVm.
+ * @param c   The context.
+ */
+#define BC_CHECK_CTXT_PARAM(vm, c)                             \
+	do                                                         \
+	{                                                          \
+		if (BC_ERR((c) == NULL))                               \
+		{                                                      \
+			BclNumber n_num_;                                  \
+			n_num_.i = 0 - (size_t) BCL_ERROR_INVALID_CONTEXT; \
+			return n_num_;                                     \
+		}                                                      \
+		BCL_USE_CTXT(vm, c);                                   \
 	}                                                          \
 	while (0)
 
@@ -272,6 +328,7 @@ typedef BcNum BclNum;
 		{                                     \
 			return BCL_ERROR_INVALID_CONTEXT; \
 		}                                     \
+		BCL_USE_CTXT(vm, c);                  \
 	}                                         \
 	while (0)
 
@@ -284,6 +341,7 @@ typedef BcNum BclNum;
 	{                               \
 		c = bcl_contextHelper(vm);  \
 		assert(c != NULL);          \
+		BCL_USE_CTXT(vm, c);        \
 	}                               \
 	while (0)
 
@@ -297,7 +355,7 @@ typedef BcNum BclNum;
 	do                                                             \
 	{                                                              \
 		size_t no_gen_ = BCL_NO_GEN(n);                            \
-		if (BC_ERR(no_gen_ >= (c)->nums.len))                      \
+		if (BC_ERR(no_gen_ >= (c)->nnums))                         \
 		{                                                          \
 			if ((n).i > 0 - (size_t) BCL_ERROR_NELEMS) return (n); \
 			else                                                   \
@@ -308,6 +366,12 @@ typedef BcNum BclNum;
 			}                                                      \
 		}                                                          \
 		BCL_CHECK_NUM_GEN(c, n);                                   \
+		if (BC_ERR(BCL_NUM_STALE(c, n)))                           \
+		{                                                          \
+			BclNumber n_num_;                                      \
+			n_num_.i = 0 - (size_t) BCL_ERROR_INVALID_NUM;         \
+			return n_num_;                                         \
+		}                                                          \
 	}                                                              \
 	while (0)
 
@@ -323,7 +387,7 @@ typedef BcNum BclNum;
 	do                                                 \
 	{                                                  \
 		size_t no_gen_ = BCL_NO_GEN(n);                \
-		if (BC_ERR(no_gen_ >= (c)->nums.len))          \
+		if (BC_ERR(no_gen_ >= (c)->nnums))             \
 		{                                              \
 			if ((n).i > 0 - (size_t) BCL_ERROR_NELEMS) \
 			{                                          \
@@ -332,25 +396,43 @@ typedef BcNum BclNum;
 			else return BCL_ERROR_INVALID_NUM;         \
 		}                                              \
 		BCL_CHECK_NUM_GEN(c, n);                       \
+		if (BC_ERR(BCL_NUM_STALE(c, n)))               \
+		{                                              \
+			return BCL_ERROR_INVALID_NUM;              \
+		}                                              \
 	}                                                  \
 	while (0)
 
 //clang-format on
 
 /**
- * Grows the context's nums array if necessary.
+ * Returns the number of numbers that can be inserted into a context without
+ * allocating.
  * @param c  The context.
+ * @return   The number of free slots.
  */
-#define BCL_GROW_NUMS(c)                  \
-	do                                    \
-	{                                     \
-		if ((c)->free_nums.len == 0)      \
-		{                                 \
-			bc_vec_grow(&((c)->nums), 1); \
-		}                                 \
-	}                                     \
+#define BCL_NUMS_AVAIL(c) \
+	((c)->nfree + ((c)->nums.len << BCL_NUMS_SLAB_SHIFT) - (c)->nnums)
+
+/**
+ * Grows the context's table of numbers, if necessary, so that @a n numbers can
+ * be inserted without allocating.
+ * @param c  The context.
+ * @param n  The number of numbers that will be inserted.
+ */
+#define BCL_RESERVE_NUMS(c, n)                                \
+	do                                                        \
+	{                                                         \
+		if (BCL_NUMS_AVAIL(c) < (n)) bcl_nums_grow((c), (n)); \
+	}                                                         \
 	while (0)
 
+/**
+ * Grows the context's table of numbers if necessary.
+ * @param c  The context.
+ */
+#define BCL_GROW_NUMS(c) BCL_RESERVE_NUMS(c, 1)
+
 /**
  * Frees a BcNum for bcl. This is a destructor.
  * @param num  The BcNum to free, as a void pointer.
@@ -358,6 +440,196 @@ typedef BcNum BclNum;
 void
 bcl_num_destruct(void* num);
 
+/// The number of limbs in the first chunk of an arena. Each chunk after that is
+/// at least twice as big as the one before it.
+#define BCL_ARENA_CHUNK (1024)
+
+/// A chunk of limbs in an arena.
+typedef struct BclArenaChunk
+{
+	/// The next older chunk.
+	struct BclArenaChunk* next;
+
+	/// The limbs, which are right after the chunk in the same allocation.
+	BcDig* data;
+
+	/// The number of limbs in the chunk.
+	size_t size;
+
+	/// The number of limbs that have been handed out.
+	size_t used;
+
+} BclArenaChunk;
+
+/// A bump allocator for the limbs of the numbers in a context. Limbs are only
+/// given back when the arena is reset, unless they were the last ones handed
+/// out.
+typedef struct BclArena
+{
+	/// The newest chunk, which is the only one that limbs are taken from.
+	BclArenaChunk* chunks;
+
+} BclArena;
+
+/**
+ * Returns the arena of a context, or NULL if the context is not in arena mode.
+ * @param c  The context.
+ * @return   The arena that the context's limbs come from, or NULL.
+ */
+#define BCL_CTXT_ARENA(c) ((c)->use_arena ? &(c)->arena : NULL)
+
+/**
+ * Records the context that an operation is about to use in the BcVm, so that
+ * the number code can find its arena and check whether it was cancelled.
+ * @param vm  The BcVm.
+ * @param c   The context.
+ */
+#define BCL_USE_CTXT(vm, c)              \
+	do                                   \
+	{                                    \
+		(vm)->ctxt = (c);                \
+		(vm)->arena = BCL_CTXT_ARENA(c); \
+	}                                    \
+	while (0)
+
+/**
+ * Gives the context of the running operation a chance to stop it. If the
+ * context was cancelled, or its progress function asks to stop, this jumps
+ * with BCL_ERROR_SIGNAL. This is cheap when neither is set up, so it can be
+ * used in inner loops.
+ * @param vm  The BcVm.
+ */
+#define BCL_POLL(vm)                                              \
+	do                                                            \
+	{                                                             \
+		struct BclCtxt* c_ = (vm)->ctxt;                          \
+		if (c_ != NULL &&                                         \
+		    (BCL_CANCEL_GET(c_->cancel) || c_->progress != NULL)) \
+		{                                                         \
+			bcl_poll(vm, c_);                                     \
+		}                                                         \
+	}                                                             \
+	while (0)
+
+/**
+ * Allocates limbs from an arena.
+ * @param a  The arena.
+ * @param n  The number of limbs.
+ * @return   The limbs.
+ */
+BcDig*
+bcl_arena_alloc(BclArena* a, size_t n);
+
+/**
+ * Grows an array of limbs that came from an arena. The array is grown in place
+ * if it was the last one handed out and there is room.
+ * @param a    The arena.
+ * @param ptr  The limbs to grow.
+ * @param old  The current number of limbs in @a ptr.
+ * @param n    The new number of limbs.
+ * @return     The grown limbs.
+ */
+BcDig*
+bcl_arena_realloc(BclArena* a, BcDig* ptr, size_t old, size_t n);
+
+/**
+ * Gives limbs back to an arena. This only does something if they were the last
+ * ones handed out; otherwise, they are reclaimed when the arena is reset.
+ * @param a    The arena.
+ * @param ptr  The limbs.
+ * @param n    The number of limbs in @a ptr.
+ */
+void
+bcl_arena_free(BclArena* a, BcDig* ptr, size_t n);
+
+/**
+ * Returns true if an array of limbs came from an arena.
+ * @param a    The arena.
+ * @param ptr  The limbs.
+ * @return     True if @a ptr came from @a a, false otherwise.
+ */
+bool
+bcl_arena_owns(const BclArena* a, const BcDig* ptr);
+
+// A context can be cancelled from another thread, so its flag is accessed
+// atomically if the compiler can do that. Relaxed accesses are enough because
+// the flag does not publish any other data. Without atomics, the flag is a
+// volatile sig_atomic_t, and bcl_ctxt_cancel() must only be called from the
+// thread that uses the context or from a signal handler.
+#if BC_C11 && !defined(__STDC_NO_ATOMICS__)
+
+/// The type of the cancellation flag of a context.
+typedef atomic_int BclCancel;
+
+/**
+ * Reads a cancellation flag.
+ * @param f  The flag.
+ * @return   Nonzero if the flag is set.
+ */
+#define BCL_CANCEL_GET(f) atomic_load_explicit(&(f), memory_order_relaxed)
+
+/**
+ * Sets or clears a cancellation flag.
+ * @param f  The flag.
+ * @param v  The new value of the flag.
+ */
+#define BCL_CANCEL_SET(f, v) \
+	atomic_store_explicit(&(f), (v), memory_order_relaxed)
+
+/// True if contexts can be cancelled from any thread.
+#define BCL_CANCEL_ATOMIC (1)
+
+#elif defined(__GNUC__)
+
+/// The type of the cancellation flag of a context.
+typedef int BclCancel;
+
+/**
+ * Reads a cancellation flag.
+ * @param f  The flag.
+ * @return   Nonzero if the flag is set.
+ */
+#define BCL_CANCEL_GET(f) __atomic_load_n(&(f), __ATOMIC_RELAXED)
+
+/**
+ * Sets or clears a cancellation flag.
+ * @param f  The flag.
+ * @param v  The new value of the flag.
+ */
+#define BCL_CANCEL_SET(f, v) __atomic_store_n(&(f), (v), __ATOMIC_RELAXED)
+
+/// True if contexts can be cancelled from any thread.
+#define BCL_CANCEL_ATOMIC (1)
+
+#else // BC_C11 && !defined(__STDC_NO_ATOMICS__)
+
+/// The type of the cancellation flag of a context.
+typedef volatile sig_atomic_t BclCancel;
+
+/**
+ * Reads a cancellation flag.
+ * @param f  The flag.
+ * @return   Nonzero if the flag is set.
+ */
+#define BCL_CANCEL_GET(f) (f)
+
+/**
+ * Sets or clears a cancellation flag.
+ * @param f  The flag.
+ * @param v  The new value of the flag.
+ */
+#define BCL_CANCEL_SET(f, v) ((f) = (v))
+
+/// True if contexts can be cancelled from any thread.
+#define BCL_CANCEL_ATOMIC (0)
+
+#endif // BC_C11 && !defined(__STDC_NO_ATOMICS__)
+
+/// How many polls there are between calls to a progress function. Polls come
+/// from inner loops, like once per limb of a quotient, so the progress function
+/// is only called on some of them.
+#define BCL_PROGRESS_STRIDE (64)
+
 /// The actual context struct.
 typedef struct BclCtxt
 {
@@ -370,15 +642,92 @@ typedef struct BclCtxt
 	/// The context's obase.
 	size_t obase;
 
-	/// A vector of BcNum numbers.
+	/// A vector of pointers to slabs of BCL_NUMS_SLAB numbers each. Growing
+	/// the table only adds slabs, so numbers never move.
 	BcVec nums;
 
-	/// A vector of BclNumbers. These are the indices in nums that are currently
-	/// not used (because they were freed).
-	BcVec free_nums;
+	/// The number of slots that have been handed out, whether they are in use
+	/// or on the free list.
+	size_t nnums;
+
+	/// The index of the first slot on the free list, or BCL_NUMS_END.
+	size_t free_nums;
+
+	/// The number of slots on the free list.
+	size_t nfree;
+
+	/// A spare number for operations whose result is also an operand. It is
+	/// swapped with the result, so its storage is reused instead of freed.
+	BcNum spare;
+
+	/// The arena that limbs come from if the context is in arena mode.
+	BclArena arena;
+
+	/// Whether the context is in arena mode.
+	bool use_arena;
+
+	/// Nonzero if the context was cancelled. See BclCancel for which threads
+	/// can set this.
+	BclCancel cancel;
+
+	/// The number of polls since the progress function was last called.
+	size_t polls;
+
+#if BC_ENABLE_LIBRARY
+
+	/// The function that is called periodically during long operations, or
+	/// NULL.
+	BclProgress progress;
+
+	/// The data to pass to the progress function.
+	void* progress_data;
+
+#endif // BC_ENABLE_LIBRARY
 
 } BclCtxt;
 
+/**
+ * Does the slow part of BCL_POLL(): calls the progress function, if any, and
+ * jumps if the operation should stop.
+ * @param vm    The BcVm.
+ * @param ctxt  The context of the running operation.
+ */
+void
+bcl_poll(BcVm* vm, BclCtxt* ctxt);
+
+// If the compiler has thread-local storage, the library keeps each thread's
+// BcVm in a thread-local variable, which turns every lookup into a plain load
+// instead of a call to pthread_getspecific() or TlsGetValue(). Defining
+// BCL_HAS_THREAD_LOCAL to 0 forces the fallback.
+#ifndef BCL_HAS_THREAD_LOCAL
+#if BC_C11 || defined(__GNUC__) || defined(_MSC_VER)
+#define BCL_HAS_THREAD_LOCAL (1)
+#else // BC_C11 || defined(__GNUC__) || defined(_MSC_VER)
+#define BCL_HAS_THREAD_LOCAL (0)
+#endif // BC_C11 || defined(__GNUC__) || defined(_MSC_VER)
+#endif // BCL_HAS_THREAD_LOCAL
+
+#if BCL_HAS_THREAD_LOCAL
+
+#if BC_C11
+#define BCL_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define BCL_THREAD_LOCAL __declspec(thread)
+#else // defined(_MSC_VER)
+#define BCL_THREAD_LOCAL __thread
+#endif // BC_C11
+
+/// The @a BcVm for the current thread.
+extern BCL_THREAD_LOCAL BcVm* bcl_vm;
+
+/**
+ * Returns the @a BcVm for the current thread.
+ * @return  The vm for the current thread.
+ */
+#define bcl_getspecific() (bcl_vm)
+
+#else // BCL_HAS_THREAD_LOCAL
+
 /**
  * Returns the @a BcVm for the current thread.
  * @return  The vm for the current thread.
@@ -386,14 +735,113 @@ typedef struct BclCtxt
 BcVm*
 bcl_getspecific(void);
 
+#endif // BCL_HAS_THREAD_LOCAL
+
 #ifndef _WIN32
 
 typedef pthread_key_t BclTls;
 
+typedef pthread_t BclThread;
+
+typedef pthread_mutex_t BclMutex;
+
+typedef pthread_cond_t BclCond;
+
 #else // _WIN32
 
 typedef DWORD BclTls;
 
+typedef HANDLE BclThread;
+
+typedef CRITICAL_SECTION BclMutex;
+
+typedef CONDITION_VARIABLE BclCond;
+
 #endif // _WIN32
 
+#if BC_ENABLE_LIBRARY
+
+/// The actual thread pool struct. Everything after the threads is protected by
+/// the lock.
+typedef struct BclThreadPool
+{
+	/// The worker threads.
+	BclThread* threads;
+
+	/// The number of worker threads.
+	size_t nthreads;
+
+	/// The lock for the rest of the pool.
+	BclMutex lock;
+
+	/// Signaled when a batch is started or the pool is shutting down.
+	BclCond work;
+
+	/// Signaled when the workers are done starting or done with a batch.
+	BclCond done;
+
+	/// The number of the current batch. Workers use it to tell a new batch
+	/// from one that they have finished.
+	size_t batch;
+
+	/// The number of workers that have not finished starting or have not
+	/// finished the current batch.
+	size_t active;
+
+	/// The number of workers that could not start.
+	size_t failed;
+
+	/// True if the pool is shutting down.
+	bool quit;
+
+	/// The operator of the current batch.
+	BclOp op;
+
+	/// The first operands of the current batch.
+	const char* const* a;
+
+	/// The second operands of the current batch.
+	const char* const* b;
+
+	/// The moduli of the current batch, or NULL if it is not a batch of
+	/// modular exponentiations.
+	const char* const* m;
+
+	/// The results of the current batch.
+	char** c;
+
+	/// The errors of the current batch, or NULL.
+	BclError* errs;
+
+	/// The number of operations in the current batch.
+	size_t n;
+
+	/// The index of the next operation that a worker will take.
+	size_t next;
+
+	/// The index of the first operation that failed, or @a n.
+	size_t first;
+
+	/// The error of the first operation that failed.
+	BclError err;
+
+	/// The scale of the current batch.
+	size_t scale;
+
+	/// The ibase of the current batch.
+	size_t ibase;
+
+	/// The obase of the current batch.
+	size_t obase;
+
+	/// Whether the current batch prints leading zeroes.
+	bool leading_zeroes;
+
+	/// Whether the current batch clamps digits.
+	bool digit_clamp;
+
+} BclThreadPool;
+
+#endif // BC_ENABLE_LIBRARY
+
 #endif // LIBBC_PRIVATE_H
@@ -68,6 +68,10 @@ typedef BclBigDig BcBigDig;
 /// The max number + 1 that one limb can hold.
 #define BC_BASE_POW (1000000000)
 
+/// The number of bits in one word of the binary form of a number. Words are
+/// stored in BcBigDig's, and this leaves room to multiply one by BC_BASE_POW.
+#define BC_NUM_BIN_BITS (32)
+
 /// An alias for portability.
 #define BC_NUM_BIGDIG_C UINT64_C
 
@@ -89,6 +93,10 @@ typedef int_least32_t BcDig;
 /// The max number + 1 that one limb can hold.
 #define BC_BASE_POW (10000)
 
+/// The number of bits in one word of the binary form of a number. Words are
+/// stored in BcBigDig's, and this leaves room to multiply one by BC_BASE_POW.
+#define BC_NUM_BIN_BITS (16)
+
 /// An alias for portability.
 #define BC_NUM_BIGDIG_C UINT32_C
 
@@ -109,6 +117,16 @@ typedef int_least16_t BcDig;
 /// The default (and minimum) number of limbs when allocating a number.
 #define BC_NUM_DEF_SIZE (8)
 
+/// The mask for one word of the binary form of a number.
+#define BC_NUM_BIN_MASK ((BC_NUM_BIGDIG_C(1) << BC_NUM_BIN_BITS) - 1)
+
+/**
+ * Returns true if the base @a b is a power of two.
+ * @param b  The base to test.
+ * @return   True if @a b is a power of two, false otherwise.
+ */
+#define BC_NUM_POW2(b) (((b) & ((b) - 1)) == 0)
+
 /// The actual number struct. This is where the magic happens.
 typedef struct BcNum
 {
@@ -147,6 +165,9 @@ struct BcRNG;
 
 #endif // BC_ENABLE_EXTRA_MATH
 
+// Forward declaration
+struct BclArena;
+
 /// The minimum obase.
 #define BC_NUM_MIN_BASE (BC_NUM_BIGDIG_C(2))
 
@@ -165,6 +186,10 @@ struct BcRNG;
 /// The base for printing streams from numbers.
 #define BC_NUM_STREAM_BASE (256)
 
+/// The size of the buffer that decimal digits are formatted into before they
+/// are printed.
+#define BC_NUM_PRINT_BUF_SIZE (1 << 11)
+
 // This sets a default for the Karatsuba length.
 #ifndef BC_NUM_KARATSUBA_LEN
 #define BC_NUM_KARATSUBA_LEN (BC_NUM_BIGDIG_C(32))
@@ -176,6 +201,18 @@ struct BcRNG;
 // the size required for ibase and obase BcNum's.
 #define BC_NUM_BIGDIG_LOG10 (BC_NUM_DEF_SIZE)
 
+/// The number of levels in a product tree. A tree with this many levels can
+/// hold more leaves than there can be factors in a product.
+#define BC_NUM_PROD_DEPTH (sizeof(size_t) * CHAR_BIT)
+
+/// The largest n that factorials are factored into primes for. Above this, the
+/// sieve of primes would be too big, and products are taken term by term.
+#define BC_NUM_SIEVE_MAX (BC_NUM_BIGDIG_C(1) << 28)
+
+/// Falling factorials a!/(a-k)! are factored into primes if k is at least
+/// a / BC_NUM_FALLING_RATIO. Otherwise, their terms are multiplied directly.
+#define BC_NUM_FALLING_RATIO (BC_NUM_BIGDIG_C(32))
+
 /**
  * Returns non-zero if the BcNum @a n is non-zero.
  * @param n  The number to test.
@@ -394,6 +431,15 @@ typedef void (*BcNumBinOp)(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale);
 typedef size_t (*BcNumBinaryOpReq)(const BcNum* a, const BcNum* b,
                                    size_t scale);
 
+/**
+ * A function type for unary operators.
+ * @param a      The parameter.
+ * @param b      The return value.
+ * @param scale  The current scale.
+ */
+typedef void (*BcNumUnaryOp)(BcNum* restrict a, BcNum* restrict b,
+                             size_t scale);
+
 /**
  * A function type for printing a "digit." Functions of this type will print one
  * digit in a number. Digits are printed differently based on the base, which is
@@ -425,6 +471,18 @@ typedef void (*BcNumShiftAddOp)(BcDig* restrict a, const BcDig* restrict b,
 void
 bc_num_init(BcNum* restrict n, size_t req);
 
+/**
+ * Initializes @a n with @a req limbs in its array, like @a bc_num_init(), but
+ * takes the limbs from @a arena if it is not NULL. The library uses this to
+ * pass down an arena that it already looked up instead of looking it up for
+ * every number.
+ * @param n      The number to initialize.
+ * @param req    The number of limbs @a n must have in its limb array.
+ * @param arena  The arena to take the limbs from, or NULL.
+ */
+void
+bc_num_initArena(BcNum* restrict n, size_t req, struct BclArena* arena);
+
 /**
  * Initializes (sets up) @a n with the preallocated limb array @a num that has
  * size @a cap. This is called by @a bc_num_init(), but it is also used by parts
@@ -478,6 +536,15 @@ bc_num_clear(BcNum* restrict n);
 void
 bc_num_free(void* num);
 
+/**
+ * Frees @a n, like @a bc_num_free(), but gives its limbs back to @a arena if
+ * they came from it.
+ * @param n      The number to free.
+ * @param arena  The arena of the running operation, or NULL.
+ */
+void
+bc_num_freeArena(BcNum* restrict n, struct BclArena* arena);
+
 /**
  * Returns the scale of @a n.
  * @param n  The number.
@@ -809,19 +876,36 @@ bc_num_cmpZero(const BcNum* n);
  * is only used for debug asserts because the parsers should get the numbers
  * parsed right, which should ensure they are always valid.
  * @param val  The string to check.
+ * @param len  The length of @a val. The string does not need to have a nul
+ *             byte within this length.
  * @return     True if the string is a valid number, false otherwise.
  */
 bool
-bc_num_strValid(const char* restrict val);
+bc_num_strValid(const char* restrict val, size_t len);
+
+/**
+ * Returns the length of the run of decimal digits ('0' to '9') at the start of
+ * a string. It checks eight characters at a time, so it is used to skip over
+ * long numbers quickly in the parsers and lexer.
+ * @param str  The string.
+ * @param len  The max number of characters to check. The string does not need
+ *             to have a nul byte within this length.
+ * @return     The number of decimal digits at the start of @a str.
+ */
+size_t
+bc_num_digitRun(const char* restrict str, size_t len);
 
 /**
  * Parses a number string into the number @a n according to @a base.
  * @param n     The number to set to the parsed value.
  * @param val   The number string to parse.
+ * @param len   The length of @a val. The string does not need to have a nul
+ *              byte within this length.
  * @param base  The base to parse the number string by.
  */
 void
-bc_num_parse(BcNum* restrict n, const char* restrict val, BcBigDig base);
+bc_num_parse(BcNum* restrict n, const char* restrict val, size_t len,
+             BcBigDig base);
 
 /**
  * Prints the number @a n according to @a base.
@@ -841,6 +925,91 @@ bc_num_print(BcNum* restrict n, BcBigDig base, bool newline);
  */
 #define bc_num_inv(a, b, scale) bc_num_div(&vm->one, (a), (b), (scale))
 
+/**
+ * The @a b-th root of @a a, the root() builtin. @a b is truncated to an
+ * integer. Like root() in the extended math library used to, this returns @a a
+ * unchanged if it is zero or if @a b is 1, and returns the square root if @a b
+ * is 2. Otherwise, the result is the root truncated to @a scale places. This
+ * is a BcNumBinaryOp function, and unlike bc_num_sqrt(), it expects its result
+ * to be preallocated.
+ * @param a      The first parameter.
+ * @param b      The degree of the root.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale.
+ */
+void
+bc_num_root(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The greatest common divisor of the integer parts of @a a and @a b, gcd(a,b)
+ * in bc. If @a b is zero, this returns @a a unchanged. This is a
+ * BcNumBinaryOp function.
+ * @param a      The first parameter.
+ * @param b      The second parameter.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale. It is unused.
+ */
+void
+bc_num_gcd(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The least common multiple of the integer parts of @a a and @a b, lcm(a,b)
+ * in bc. This is a BcNumBinaryOp function.
+ * @param a      The first parameter.
+ * @param b      The second parameter.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale. It is unused.
+ */
+void
+bc_num_lcm(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The inverse of @a a modulo @a b, modinv(a,b) in bc. The result is in
+ * [0, |b|). @a a and @a b must be integers, @a b must be non-zero, and @a a
+ * and @a b must be coprime. This is a BcNumBinaryOp function.
+ * @param a      The number to invert.
+ * @param b      The modulus.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale. It is unused.
+ */
+void
+bc_num_modinv(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The number of permutations of @a b items out of @a a, perm(a,b) in bc. Both
+ * are truncated and made positive, like the old math library function, and the
+ * result is 0 if @a b is greater than @a a. This is a BcNumBinaryOp function.
+ * @param a      The number of items.
+ * @param b      The number of items to pick.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale. It is unused.
+ */
+void
+bc_num_perm(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The number of combinations of @a b items out of @a a, comb(a,b) in bc. Both
+ * are truncated and made positive, like the old math library function, and the
+ * result is 0 if @a b is greater than @a a. This is a BcNumBinaryOp function.
+ * @param a      The number of items.
+ * @param b      The number of items to pick.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale. It is unused.
+ */
+void
+bc_num_comb(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * The Fibonacci number of @a a, fib(a) in bc. Like the old math library
+ * function, @a a is truncated and made positive, but fib(0) is 0 while anything
+ * that truncates to 0 otherwise is 1. This is a BcNumUnaryOp function.
+ * @param a      The index of the Fibonacci number.
+ * @param b      The return value. It must not be @a a.
+ * @param scale  The current scale. It is unused.
+ */
+void
+bc_num_fib(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
 #if !BC_ENABLE_LIBRARY
 
 /**
@@ -852,6 +1021,141 @@ bc_num_stream(BcNum* restrict n);
 
 #endif // !BC_ENABLE_LIBRARY
 
+#if BC_ENABLE_LIBRARY
+
+/**
+ * Sets a number to the integer in an array of bytes.
+ * @param n      The number to set. It must be preallocated.
+ * @param bytes  The bytes.
+ * @param len    The number of bytes.
+ * @param big    True if the most significant byte is first, false if the
+ *               least significant byte is first.
+ */
+void
+bc_num_importBytes(BcNum* restrict n, const uchar* restrict bytes, size_t len,
+                   bool big);
+
+/**
+ * Sets a number to the integer in an array of 64-bit words, least significant
+ * word first.
+ * @param n      The number to set. It must be preallocated.
+ * @param words  The words.
+ * @param len    The number of words.
+ */
+void
+bc_num_importWords(BcNum* restrict n, const uint64_t* restrict words,
+                   size_t len);
+
+/**
+ * Puts the integer part of a number into an array of bytes, using as few bytes
+ * as possible. Nothing is written if @a cap is too small. This throws an error
+ * if the number is negative.
+ * @param n    The number to export.
+ * @param buf  The array to put the bytes into.
+ * @param cap  The capacity of @a buf.
+ * @param big  True if the most significant byte should be first, false if the
+ *             least significant byte should be first.
+ * @return     The number of bytes needed.
+ */
+size_t
+bc_num_exportBytes(const BcNum* restrict n, uchar* restrict buf, size_t cap,
+                   bool big);
+
+// The functions below are native versions of the functions in the bc math
+// library. They do the same operations at the same scales, so their results
+// match the math library's to the last digit. Unlike bc_num_sqrt(), they
+// expect their results to be preallocated.
+
+/**
+ * The exponential function, e(x) in the math library. This is a BcNumUnaryOp
+ * function.
+ * @param a      The parameter.
+ * @param b      The return value. It must not be @a a.
+ * @param scale  The current scale.
+ */
+void
+bc_num_exp(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
+/**
+ * The natural logarithm, l(x) in the math library. This is a BcNumUnaryOp
+ * function.
+ * @param a      The parameter.
+ * @param b      The return value. It must not be @a a.
+ * @param scale  The current scale.
+ */
+void
+bc_num_ln(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
+/**
+ * Sine, s(x) in the math library. This is a BcNumUnaryOp function.
+ * @param a      The parameter, in radians.
+ * @param b      The return value. It must not be @a a.
+ * @param scale  The current scale.
+ */
+void
+bc_num_sin(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
+/**
+ * Cosine, c(x) in the math library. This is a BcNumUnaryOp function.
+ * @param a      The parameter, in radians.
+ * @param b      The return value. It must not be @a a.
+ * @param scale  The current scale.
+ */
+void
+bc_num_cos(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
+/**
+ * Arctangent, a(x) in the math library. This is a BcNumUnaryOp function.
+ * @param a      The parameter.
+ * @param b      The return value, in radians. It must not be @a a.
+ * @param scale  The current scale.
+ */
+void
+bc_num_atan(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
+/**
+ * The logarithm of @a a in base @a b, log(x,b) in the extended math library.
+ * This is a BcNumBinaryOp function.
+ * @param a      The first parameter.
+ * @param b      The base.
+ * @param c      The return value. It must not be @a a or @a b.
+ * @param scale  The current scale.
+ */
+void
+bc_num_log(BcNum* a, BcNum* b, BcNum* c, size_t scale);
+
+/**
+ * Rounds half away from zero to @a places decimal places, r(x,p) in the
+ * extended math library.
+ * @param a       The parameter.
+ * @param b       The return value. It must not be @a a.
+ * @param places  The number of places.
+ */
+void
+bc_num_round(BcNum* restrict a, BcNum* restrict b, size_t places);
+
+/**
+ * Rounds away from zero to @a places decimal places, ceil(x,p) in the extended
+ * math library.
+ * @param a       The parameter.
+ * @param b       The return value. It must not be @a a.
+ * @param places  The number of places.
+ */
+void
+bc_num_ceil(BcNum* restrict a, BcNum* restrict b, size_t places);
+
+/**
+ * The factorial of the integer part of the absolute value of @a a, f(n) in the
+ * extended math library. This is a BcNumUnaryOp function.
+ * @param a      The parameter.
+ * @param b      The return value. It must not be @a a.
+ * @param scale  The current scale.
+ */
+void
+bc_num_fact(BcNum* restrict a, BcNum* restrict b, size_t scale);
+
+#endif // BC_ENABLE_LIBRARY
+
 #if BC_DEBUG_CODE
 
 /**
@@ -894,6 +1198,9 @@ bc_num_dump(const char* varname, const BcNum* n);
 /// A reference to an array of hex digits for easy conversion for printing.
 extern const char bc_num_hex_digits[];
 
+/// A reference to the strings of 00 to 99, for printing two digits at a time.
+extern const char bc_num_dec_pairs[];
+
 /// An array of powers of 10 for easy conversion from number of digits to
 /// powers.
 extern const BcBigDig bc_num_pow10[BC_BASE_DIGS + 1];
@@ -64,6 +64,56 @@
 /// The length of the globals array.
 #define BC_PROG_GLOBALS_LEN (3 + BC_ENABLE_EXTRA_MATH)
 
+#if BC_ENABLED
+
+/// The most results that a pure function memoizes. After that, one that has not
+/// been used recently is replaced. This is also the number of buckets in the
+/// memo table, so it must be a power of two.
+#define BC_PROG_MEMO_MAX (1024)
+
+/**
+ * Returns the bucket of the memo table that a memo hash goes in. Higher bits
+ * are folded in so that hashes that only differ there do not share a bucket.
+ * @param h  The hash.
+ * @return   The index of the bucket.
+ */
+#define BC_PROG_MEMO_BUCKET(h) \
+	(((h) ^ ((h) >> 10) ^ ((h) >> 20)) & (BC_PROG_MEMO_MAX - 1))
+
+/// A call to a pure function that is executing and whose result may be
+/// memoized when it returns.
+typedef struct BcMemoCall
+{
+	/// The length of the execution stack while the call executes. This is how
+	/// bc_program_return() knows that it is returning from this call.
+	size_t stack_len;
+
+	/// The hash of the arguments and the globals.
+	size_t hash;
+
+	/// The values of ibase, obase, and scale when the call was made.
+	BcBigDig globals[BC_MEMO_GLOBALS];
+
+	/// True if the call did something that means its result cannot be
+	/// memoized, like calling a function that is not pure.
+	bool impure;
+
+} BcMemoCall;
+
+/// A run of tail calls that replaced the frames of functions instead of
+/// pushing new ones. These are kept so that stack traces can show them.
+typedef struct BcTailCall
+{
+	/// The length of the execution stack where the tail calls happened.
+	size_t stack_len;
+
+	/// The number of frames that were replaced.
+	size_t calls;
+
+} BcTailCall;
+
+#endif // BC_ENABLED
+
 typedef struct BcProgram
 {
 	/// The array of globals values.
@@ -143,6 +193,26 @@ typedef struct BcProgram
 	/// The last printed value for bc.
 	BcNum last;
 
+	/// The calls to pure functions that are executing. This is a vector of
+	/// BcMemoCall.
+	BcVec memos;
+
+	/// The arguments of the calls in memos, in order.
+	BcVec memo_args;
+
+	/// The frames of the functions that are executing, one after the other.
+	/// Each function has one BcNum per local, and the ones that are in slots
+	/// hold the values of those locals.
+	BcVec locals;
+
+	/// One bool per variable in vars, true if a function uses the variable
+	/// without declaring it. Locals with that name can never be in slots.
+	BcVec var_dyn;
+
+	/// The tail calls that have replaced frames on the execution stack. This
+	/// is a vector of BcTailCall, with at most one per frame.
+	BcVec tails;
+
 #endif // BC_ENABLED
 
 	// The BcDig array for strmb. This uses BC_NUM_LONG_LOG10 because it is used
@@ -359,6 +429,41 @@ bc_program_printStackDebug(BcProgram* p);
 size_t
 bc_program_search(BcProgram* p, const char* name, bool var);
 
+#if BC_ENABLED
+
+/**
+ * Returns true if the variable at index @a idx is used by a function that does
+ * not declare it. Locals with that name must be on the variable stack.
+ * @param p    The program.
+ * @param idx  The index of the variable.
+ * @return     True if the variable is used without being declared.
+ */
+#define BC_PROG_VAR_DYN(p, idx) (*((bool*) bc_vec_item(&(p)->var_dyn, (idx))))
+
+/**
+ * Marks a variable as used by a function that does not declare it, which
+ * moves all locals with its name out of their slots. This must only be called
+ * when no function is executing.
+ * @param p    The program.
+ * @param idx  The index of the variable.
+ */
+void
+bc_program_dynVar(BcProgram* p, size_t idx);
+
+/**
+ * Returns the offset, from the top of the locals, of the local variable that
+ * a read() expression sees for a variable, or BC_VEC_INVALID_IDX if it should
+ * use the variable stack. The stack of functions is searched from the top like
+ * the variable stacks would be.
+ * @param p    The program.
+ * @param idx  The index of the variable.
+ * @return     The offset of the local, or BC_VEC_INVALID_IDX.
+ */
+size_t
+bc_program_readLocal(const BcProgram* p, size_t idx);
+
+#endif // BC_ENABLED
+
 /**
  * Adds a string to the program and returns the string's index in the program.
  * @param p    The program.
@@ -445,6 +550,9 @@ extern const BcNumBinaryOp bc_program_ops[];
 /// A reference to an array of binary operator allocation request functions.
 extern const BcNumBinaryOpReq bc_program_opReqs[];
 
+/// A reference to an array of functions for builtins that take two numbers.
+extern const BcNumBinaryOp bc_program_funcs[];
+
 /// A reference to an array of unary operator functions.
 extern const BcProgramUnary bc_program_unarys[];
 
@@ -566,6 +674,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_ASSIGN_NO_VAL,                    \
 		&&lbl_BC_INST_NUM,                              \
 		&&lbl_BC_INST_VAR,                              \
+		&&lbl_BC_INST_LOCAL,                            \
 		&&lbl_BC_INST_ARRAY_ELEM,                       \
 		&&lbl_BC_INST_ARRAY,                            \
 		&&lbl_BC_INST_ZERO,                             \
@@ -582,6 +691,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_IS_NUMBER,                        \
 		&&lbl_BC_INST_IS_STRING,                        \
 		&&lbl_BC_INST_IRAND,                            \
+		&&lbl_BC_INST_FIB,                              \
 		&&lbl_BC_INST_ASCIIFY,                          \
 		&&lbl_BC_INST_READ,                             \
 		&&lbl_BC_INST_RAND,                             \
@@ -607,6 +717,12 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_SWAP,                             \
 		&&lbl_BC_INST_MODEXP,                           \
 		&&lbl_BC_INST_DIVMOD,                           \
+		&&lbl_BC_INST_ROOT,                             \
+		&&lbl_BC_INST_GCD,                              \
+		&&lbl_BC_INST_LCM,                              \
+		&&lbl_BC_INST_MODINV,                           \
+		&&lbl_BC_INST_PERM,                             \
+		&&lbl_BC_INST_COMB,                             \
 		&&lbl_BC_INST_PRINT_STREAM,                     \
 		&&lbl_BC_INST_EXTENDED_REGISTERS,               \
 		&&lbl_BC_INST_POP_EXEC,                         \
@@ -664,6 +780,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_ASSIGN_NO_VAL,                    \
 		&&lbl_BC_INST_NUM,                              \
 		&&lbl_BC_INST_VAR,                              \
+		&&lbl_BC_INST_LOCAL,                            \
 		&&lbl_BC_INST_ARRAY_ELEM,                       \
 		&&lbl_BC_INST_ARRAY,                            \
 		&&lbl_BC_INST_ZERO,                             \
@@ -678,6 +795,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_ABS,                              \
 		&&lbl_BC_INST_IS_NUMBER,                        \
 		&&lbl_BC_INST_IS_STRING,                        \
+		&&lbl_BC_INST_FIB,                              \
 		&&lbl_BC_INST_ASCIIFY,                          \
 		&&lbl_BC_INST_READ,                             \
 		&&lbl_BC_INST_MAXIBASE,                         \
@@ -701,6 +819,12 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_SWAP,                             \
 		&&lbl_BC_INST_MODEXP,                           \
 		&&lbl_BC_INST_DIVMOD,                           \
+		&&lbl_BC_INST_ROOT,                             \
+		&&lbl_BC_INST_GCD,                              \
+		&&lbl_BC_INST_LCM,                              \
+		&&lbl_BC_INST_MODINV,                           \
+		&&lbl_BC_INST_PERM,                             \
+		&&lbl_BC_INST_COMB,                             \
 		&&lbl_BC_INST_PRINT_STREAM,                     \
 		&&lbl_BC_INST_EXTENDED_REGISTERS,               \
 		&&lbl_BC_INST_POP_EXEC,                         \
@@ -772,6 +896,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_ASSIGN_NO_VAL,                    \
 		&&lbl_BC_INST_NUM,                              \
 		&&lbl_BC_INST_VAR,                              \
+		&&lbl_BC_INST_LOCAL,                            \
 		&&lbl_BC_INST_ARRAY_ELEM,                       \
 		&&lbl_BC_INST_ARRAY,                            \
 		&&lbl_BC_INST_ZERO,                             \
@@ -788,6 +913,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_IS_NUMBER,                        \
 		&&lbl_BC_INST_IS_STRING,                        \
 		&&lbl_BC_INST_IRAND,                            \
+		&&lbl_BC_INST_FIB,                              \
 		&&lbl_BC_INST_ASCIIFY,                          \
 		&&lbl_BC_INST_READ,                             \
 		&&lbl_BC_INST_RAND,                             \
@@ -813,6 +939,12 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_SWAP,                             \
 		&&lbl_BC_INST_MODEXP,                           \
 		&&lbl_BC_INST_DIVMOD,                           \
+		&&lbl_BC_INST_ROOT,                             \
+		&&lbl_BC_INST_GCD,                              \
+		&&lbl_BC_INST_LCM,                              \
+		&&lbl_BC_INST_MODINV,                           \
+		&&lbl_BC_INST_PERM,                             \
+		&&lbl_BC_INST_COMB,                             \
 		&&lbl_BC_INST_PRINT_STREAM,                     \
 		&&lbl_BC_INST_INVALID,                          \
 	}
@@ -855,6 +987,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_ASSIGN_NO_VAL,                    \
 		&&lbl_BC_INST_NUM,                              \
 		&&lbl_BC_INST_VAR,                              \
+		&&lbl_BC_INST_LOCAL,                            \
 		&&lbl_BC_INST_ARRAY_ELEM,                       \
 		&&lbl_BC_INST_ARRAY,                            \
 		&&lbl_BC_INST_ZERO,                             \
@@ -869,6 +1002,7 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_ABS,                              \
 		&&lbl_BC_INST_IS_NUMBER,                        \
 		&&lbl_BC_INST_IS_STRING,                        \
+		&&lbl_BC_INST_FIB,                              \
 		&&lbl_BC_INST_ASCIIFY,                          \
 		&&lbl_BC_INST_READ,                             \
 		&&lbl_BC_INST_MAXIBASE,                         \
@@ -892,6 +1026,12 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_SWAP,                             \
 		&&lbl_BC_INST_MODEXP,                           \
 		&&lbl_BC_INST_DIVMOD,                           \
+		&&lbl_BC_INST_ROOT,                             \
+		&&lbl_BC_INST_GCD,                              \
+		&&lbl_BC_INST_LCM,                              \
+		&&lbl_BC_INST_MODINV,                           \
+		&&lbl_BC_INST_PERM,                             \
+		&&lbl_BC_INST_COMB,                             \
 		&&lbl_BC_INST_PRINT_STREAM,                     \
 		&&lbl_BC_INST_INVALID,                          \
 	}
@@ -925,15 +1065,19 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_SCALE_FUNC,    &&lbl_BC_INST_SQRT,               \
 		&&lbl_BC_INST_ABS,           &&lbl_BC_INST_IS_NUMBER,          \
 		&&lbl_BC_INST_IS_STRING,     &&lbl_BC_INST_IRAND,              \
-		&&lbl_BC_INST_ASCIIFY,       &&lbl_BC_INST_READ,               \
-		&&lbl_BC_INST_RAND,          &&lbl_BC_INST_MAXIBASE,           \
-		&&lbl_BC_INST_MAXOBASE,      &&lbl_BC_INST_MAXSCALE,           \
-		&&lbl_BC_INST_MAXRAND,       &&lbl_BC_INST_LINE_LENGTH,        \
-		&&lbl_BC_INST_LEADING_ZERO,  &&lbl_BC_INST_PRINT,              \
-		&&lbl_BC_INST_PRINT_POP,     &&lbl_BC_INST_STR,                \
-		&&lbl_BC_INST_POP,           &&lbl_BC_INST_SWAP,               \
-		&&lbl_BC_INST_MODEXP,        &&lbl_BC_INST_DIVMOD,             \
-		&&lbl_BC_INST_PRINT_STREAM,  &&lbl_BC_INST_EXTENDED_REGISTERS, \
+		&&lbl_BC_INST_FIB,           &&lbl_BC_INST_ASCIIFY,            \
+		&&lbl_BC_INST_READ,          &&lbl_BC_INST_RAND,               \
+		&&lbl_BC_INST_MAXIBASE,      &&lbl_BC_INST_MAXOBASE,           \
+		&&lbl_BC_INST_MAXSCALE,      &&lbl_BC_INST_MAXRAND,            \
+		&&lbl_BC_INST_LINE_LENGTH,   &&lbl_BC_INST_LEADING_ZERO,       \
+		&&lbl_BC_INST_PRINT,         &&lbl_BC_INST_PRINT_POP,          \
+		&&lbl_BC_INST_STR,           &&lbl_BC_INST_POP,                \
+		&&lbl_BC_INST_SWAP,          &&lbl_BC_INST_MODEXP,             \
+		&&lbl_BC_INST_DIVMOD,        &&lbl_BC_INST_ROOT,               \
+		&&lbl_BC_INST_GCD,           &&lbl_BC_INST_LCM,                \
+		&&lbl_BC_INST_MODINV,        &&lbl_BC_INST_PERM,               \
+		&&lbl_BC_INST_COMB,          &&lbl_BC_INST_PRINT_STREAM,       \
+		&&lbl_BC_INST_EXTENDED_REGISTERS,                              \
 		&&lbl_BC_INST_POP_EXEC,      &&lbl_BC_INST_EXECUTE,            \
 		&&lbl_BC_INST_EXEC_COND,     &&lbl_BC_INST_PRINT_STACK,        \
 		&&lbl_BC_INST_CLEAR_STACK,   &&lbl_BC_INST_REG_STACK_LEN,      \
@@ -964,14 +1108,18 @@ extern const char bc_program_esc_seqs[];
 		&&lbl_BC_INST_LENGTH,        &&lbl_BC_INST_SCALE_FUNC,         \
 		&&lbl_BC_INST_SQRT,          &&lbl_BC_INST_ABS,                \
 		&&lbl_BC_INST_IS_NUMBER,     &&lbl_BC_INST_IS_STRING,          \
-		&&lbl_BC_INST_ASCIIFY,       &&lbl_BC_INST_READ,               \
-		&&lbl_BC_INST_MAXIBASE,      &&lbl_BC_INST_MAXOBASE,           \
-		&&lbl_BC_INST_MAXSCALE,      &&lbl_BC_INST_LINE_LENGTH,        \
-		&&lbl_BC_INST_LEADING_ZERO,  &&lbl_BC_INST_PRINT,              \
-		&&lbl_BC_INST_PRINT_POP,     &&lbl_BC_INST_STR,                \
-		&&lbl_BC_INST_POP,           &&lbl_BC_INST_SWAP,               \
-		&&lbl_BC_INST_MODEXP,        &&lbl_BC_INST_DIVMOD,             \
-		&&lbl_BC_INST_PRINT_STREAM,  &&lbl_BC_INST_EXTENDED_REGISTERS, \
+		&&lbl_BC_INST_FIB,           &&lbl_BC_INST_ASCIIFY,            \
+		&&lbl_BC_INST_READ,          &&lbl_BC_INST_MAXIBASE,           \
+		&&lbl_BC_INST_MAXOBASE,      &&lbl_BC_INST_MAXSCALE,           \
+		&&lbl_BC_INST_LINE_LENGTH,   &&lbl_BC_INST_LEADING_ZERO,       \
+		&&lbl_BC_INST_PRINT,         &&lbl_BC_INST_PRINT_POP,          \
+		&&lbl_BC_INST_STR,           &&lbl_BC_INST_POP,                \
+		&&lbl_BC_INST_SWAP,          &&lbl_BC_INST_MODEXP,             \
+		&&lbl_BC_INST_DIVMOD,        &&lbl_BC_INST_ROOT,               \
+		&&lbl_BC_INST_GCD,           &&lbl_BC_INST_LCM,                \
+		&&lbl_BC_INST_MODINV,        &&lbl_BC_INST_PERM,               \
+		&&lbl_BC_INST_COMB,          &&lbl_BC_INST_PRINT_STREAM,       \
+		&&lbl_BC_INST_EXTENDED_REGISTERS,                              \
 		&&lbl_BC_INST_POP_EXEC,      &&lbl_BC_INST_EXECUTE,            \
 		&&lbl_BC_INST_EXEC_COND,     &&lbl_BC_INST_PRINT_STACK,        \
 		&&lbl_BC_INST_CLEAR_STACK,   &&lbl_BC_INST_REG_STACK_LEN,      \
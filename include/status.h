@@ -868,24 +868,23 @@ typedef enum BcMode
 #define BC_SIG_TRYUNLOCK(lock)
 #define BC_SIG_ASSERT_LOCKED
 
-/// Returns true if an exception is in flight, false otherwise.
-#define BC_SIG_EXC(vm) \
-	BC_UNLIKELY(vm->status != (sig_atomic_t) BC_STATUS_SUCCESS)
+/// Returns true if an exception is in flight, false otherwise. The library
+/// has no signals, and bc_vm_handleError() only sets the error code.
+#define BC_SIG_EXC(vm) BC_UNLIKELY((vm)->err != BCL_ERROR_NONE)
 
 /// Returns true if there is *no* exception in flight, false otherwise.
-#define BC_NO_SIG_EXC(vm) \
-	BC_LIKELY(vm->status == (sig_atomic_t) BC_STATUS_SUCCESS)
+#define BC_NO_SIG_EXC(vm) BC_LIKELY((vm)->err == BCL_ERROR_NONE)
 
 /// Used after cleanup labels set by BC_SETJMP and BC_SETJMP_LOCKED to jump to
 /// the next place. This is what continues the stack unwinding. This basically
 /// copies BC_SIG_UNLOCK into itself, but that is because its condition for
 /// jumping is BC_SIG_EXC, not just that a signal happened.
-#define BC_LONGJMP_CONT(vm)         \
-	do                              \
-	{                               \
-		bc_vec_pop(&vm->jmp_bufs);  \
-		if (BC_SIG_EXC(vm)) BC_JMP; \
-	}                               \
+#define BC_LONGJMP_CONT(vm)                          \
+	do                                               \
+	{                                                \
+		if (!vm->sig_pop) bc_vec_pop(&vm->jmp_bufs); \
+		if (BC_SIG_EXC(vm)) BC_JMP;                  \
+	}                                                \
 	while (0)
 
 #endif // !BC_ENABLE_LIBRARY
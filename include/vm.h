@@ -477,6 +477,14 @@
 /// The amount of the global buffer allocated to stdin.
 #define BC_VM_STDIN_BUF_SIZE (BC_VM_STDERR_BUF_SIZE - 1)
 
+// This sets the max size the stdout buffer can grow to when stdout is not a
+// TTY. It can be set at build time.
+#ifndef BC_VM_STDOUT_BUF_MAX
+#define BC_VM_STDOUT_BUF_MAX (1 << 16)
+#elif BC_VM_STDOUT_BUF_MAX < (1 << 11)
+#error BC_VM_STDOUT_BUF_MAX must be at least 2048.
+#endif // BC_VM_STDOUT_BUF_MAX
+
 #endif // BC_ENABLE_LINE_LIB
 
 /// The max number of temporary BcNums that can be kept.
@@ -560,6 +568,14 @@ typedef struct BcVm
 	/// The vector for creating strings to pass to the client.
 	BcVec out;
 
+	/// The arena of the context that is being used, or NULL if that context
+	/// is not in arena mode. Limbs come from this arena instead of malloc().
+	struct BclArena* arena;
+
+	/// The context of the operation that is running, or NULL. Long operations
+	/// check it to see if they should stop.
+	struct BclCtxt* ctxt;
+
 #if BC_ENABLE_EXTRA_MATH
 
 	/// The PRNG.
@@ -638,7 +654,8 @@ typedef struct BcVm
 #if BC_ENABLED
 
 	/// True if keywords should not be redefined. This is only true for the
-	/// builtin math libraries for bc.
+	/// builtin math libraries for bc, which are also the only code that can use
+	/// library keywords (see BC_LEX_KW_LIB()).
 	bool no_redefine;
 
 #endif // BC_ENABLED
@@ -844,11 +861,13 @@ bc_vm_freeTemps(void);
  * matter if history does not exist.
  */
 #define bc_vm_putchar(c, t) bc_vm_putchar_impl(c)
+#define bc_vm_write(b, n, t) bc_vm_write_impl(b, n)
 
 #else // !BC_ENABLE_HISTORY || BC_ENABLE_LINE_LIB || BC_ENABLE_LIBRARY
 
 // This is here to satisfy a clang warning about recursive macros.
 #define bc_vm_putchar(c, t) bc_vm_putchar_impl(c, t)
+#define bc_vm_write(b, n, t) bc_vm_write_impl(b, n, t)
 
 #endif // !BC_ENABLE_HISTORY || BC_ENABLE_LINE_LIB || BC_ENABLE_LIBRARY
 
@@ -867,6 +886,17 @@ bc_vm_printf(const char* fmt, ...);
 void
 bc_vm_putchar(int c, BcFlushType type);
 
+/**
+ * Puts a run of chars into the stdout buffer all at once. The chars must not
+ * include a newline because this counts all of them as being on the current
+ * line.
+ * @param buf   The chars to put on the stdout buffer.
+ * @param n     The number of chars in @a buf.
+ * @param type  The flush type.
+ */
+void
+bc_vm_write(const char* buf, size_t n, BcFlushType type);
+
 /**
  * Multiplies @a n and @a size and throws an allocation error if overflow
  * occurs.
@@ -96,8 +96,9 @@ bc_args_builtin(const char* arg)
 	bool strvalid;
 	BcNum n;
 	BcBigDig res;
+	size_t len = strlen(arg);
 
-	strvalid = bc_num_strValid(arg);
+	strvalid = bc_num_strValid(arg, len);
 
 	if (BC_ERR(!strvalid))
 	{
@@ -106,7 +107,7 @@ bc_args_builtin(const char* arg)
 
 	bc_num_init(&n, 0);
 
-	bc_num_parse(&n, arg, 10);
+	bc_num_parse(&n, arg, len, 10);
 
 	res = bc_num_bigdig(&n);
 
@@ -135,7 +136,8 @@ bc_args_redefine(const char* keyword)
 
 		if (!strcmp(keyword, kw->name))
 		{
-			if (BC_LEX_KW_POSIX(kw)) break;
+			// Library keywords are already names in scripts.
+			if (BC_LEX_KW_POSIX(kw) || BC_LEX_KW_LIB(kw)) break;
 
 			vm->redefined_kws[i] = true;
 
@@ -275,7 +277,7 @@ bc_args(int argc, char* argv[], bool exit_exprs, BcBigDig* scale,
 #if BC_ENABLE_EXTRA_MATH
 			case 'E':
 			{
-				if (BC_ERR(!bc_num_strValid(opts.optarg)))
+				if (BC_ERR(!bc_num_strValid(opts.optarg, strlen(opts.optarg))))
 				{
 					bc_verr(BC_ERR_FATAL_ARG, opts.optarg);
 				}
@@ -393,7 +395,7 @@ bc_args(int argc, char* argv[], bool exit_exprs, BcBigDig* scale,
 
 		BC_SIG_UNLOCK;
 
-		bc_num_parse(&n, seed, BC_BASE);
+		bc_num_parse(&n, seed, strlen(seed), BC_BASE);
 
 		bc_program_assignSeed(&vm->prog, &n);
 
@@ -68,6 +68,9 @@ bc_lex_identifier(BcLex* l)
 			// ensure that only non-POSIX keywords get redefined.
 			if (!vm->no_redefine && vm->redefined_kws[i]) break;
 
+			// Library keywords are names outside of the builtin libraries.
+			if (BC_LEX_KW_LIB(kw) && !vm->no_redefine) break;
+
 			l->t = BC_LEX_KW_AUTO + (BcLexType) i;
 
 			// Warn or error, as appropriate for the mode, if the keyword is not
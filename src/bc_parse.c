@@ -392,6 +392,89 @@ bc_parse_call(BcParse* p, const char* name, uint8_t flags)
 	bc_lex_next(&p->l);
 }
 
+/**
+ * Records that the function being parsed can modify the global that @a inst
+ * pushes, if it pushes one of the globals with a stack. With global stacks, a
+ * call only saves and restores the globals that the function can modify, and
+ * this is how the parser finds them. rand() and irand() do not count for seed
+ * because, until seed is assigned to, the PRNG of a function passes its changes
+ * on to its caller anyway.
+ * @param p     The parser.
+ * @param inst  The instruction that was assigned to.
+ */
+static void
+bc_parse_modGlobal(BcParse* p, BcInst inst)
+{
+#if BC_ENABLE_EXTRA_MATH
+	if (inst >= BC_INST_IBASE && inst <= BC_INST_SEED)
+#else // BC_ENABLE_EXTRA_MATH
+	if (inst >= BC_INST_IBASE && inst <= BC_INST_SCALE)
+#endif // BC_ENABLE_EXTRA_MATH
+	{
+		p->func->globals |= BC_FUNC_GLOBAL(inst);
+	}
+}
+
+/**
+ * Pushes the instruction for a variable, an array, or an array element, and the
+ * index of its name. Locals of the function being parsed are pushed as
+ * BC_INST_LOCAL with their offset from the top of the locals instead.
+ *
+ * If the function being parsed is pure, this also checks that the name is one
+ * of its locals because a pure function that touches globals cannot be
+ * memoized.
+ * @param p     The parser.
+ * @param name  The name.
+ * @param inst  The instruction; BC_INST_VAR, BC_INST_ARRAY_ELEM, or
+ *              BC_INST_ARRAY.
+ */
+static void
+bc_parse_pushVar(BcParse* p, char* name, BcInst inst)
+{
+	size_t i, idx, len = p->func->autos.len;
+	bool var = (inst == BC_INST_VAR);
+	BcType t = var ? BC_TYPE_VAR : BC_TYPE_ARRAY;
+
+	idx = bc_program_search(p->prog, name, var);
+
+	// Find the local with the name, if any. Locals are always declared before
+	// they are used, so len will not change.
+	for (i = 0; i < len; ++i)
+	{
+		BcAuto* a = bc_vec_item(&p->func->autos, i);
+		if (a->idx == idx && a->type == t) break;
+	}
+
+	if (i == len) p->func->pure = false;
+	else if (var)
+	{
+		bc_parse_push(p, BC_INST_LOCAL);
+		bc_parse_pushIndex(p, len - 1 - i);
+		return;
+	}
+
+	if (var && p->fidx == BC_PROG_READ)
+	{
+		// read() expressions see the locals of the functions calling them, and
+		// they are parsed right before they are executed, so the local can be
+		// found now.
+		size_t off = bc_program_readLocal(p->prog, idx);
+
+		if (off != BC_VEC_INVALID_IDX)
+		{
+			bc_parse_push(p, BC_INST_LOCAL);
+			bc_parse_pushIndex(p, off);
+			return;
+		}
+	}
+	// A function using a variable it does not declare can see the locals of
+	// its callers with that name, so those have to stay on the variable stack.
+	else if (var && p->fidx != BC_PROG_MAIN) bc_program_dynVar(p->prog, idx);
+
+	bc_parse_push(p, inst);
+	bc_parse_pushIndex(p, idx);
+}
+
 /**
  * Parses a name/identifier-based expression. It could be a variable, an array
  * element, an array itself (for function arguments), a function call, etc.
@@ -456,8 +539,7 @@ bc_parse_name(BcParse* p, BcInst* type, bool* can_assign, uint8_t flags)
 		bc_lex_next(&p->l);
 
 		// Push the instruction and the name of the identifier.
-		bc_parse_push(p, *type);
-		bc_parse_pushName(p, name, false);
+		bc_parse_pushVar(p, name, *type);
 	}
 	else if (p->l.t == BC_LEX_LPAREN)
 	{
@@ -477,8 +559,7 @@ bc_parse_name(BcParse* p, BcInst* type, bool* can_assign, uint8_t flags)
 		// Just a variable.
 		*type = BC_INST_VAR;
 		*can_assign = true;
-		bc_parse_push(p, BC_INST_VAR);
-		bc_parse_pushName(p, name, true);
+		bc_parse_pushVar(p, name, BC_INST_VAR);
 	}
 
 err:
@@ -553,8 +634,9 @@ bc_parse_builtin(BcParse* p, BcLexType type, uint8_t flags, BcInst* prev)
 }
 
 /**
- * Parses a builtin function that takes 3 arguments. This includes modexp() and
- * divmod().
+ * Parses a builtin function that takes more than one argument. This includes
+ * modexp() and divmod(), which take 3, and root(), gcd(), lcm(), modinv(),
+ * perm(), and comb(), which take 2.
  * @param p      The parser.
  * @param type   The lex token.
  * @param flags  The expression parsing flags for parsing the argument.
@@ -563,7 +645,7 @@ bc_parse_builtin(BcParse* p, BcLexType type, uint8_t flags, BcInst* prev)
 static void
 bc_parse_builtin3(BcParse* p, BcLexType type, uint8_t flags, BcInst* prev)
 {
-	assert(type == BC_LEX_KW_MODEXP || type == BC_LEX_KW_DIVMOD);
+	assert(type >= BC_LEX_KW_MODEXP && type <= BC_LEX_KW_COMB);
 
 	// Must have a left paren.
 	bc_lex_next(&p->l);
@@ -582,42 +664,56 @@ bc_parse_builtin3(BcParse* p, BcLexType type, uint8_t flags, BcInst* prev)
 
 	bc_lex_next(&p->l);
 
-	bc_parse_expr_status(p, flags, bc_parse_next_builtin);
-
-	// Must have a comma.
-	if (BC_ERR(p->l.t != BC_LEX_COMMA)) bc_parse_err(p, BC_ERR_PARSE_TOKEN);
-
-	bc_lex_next(&p->l);
-
-	// If it is a divmod, parse an array name. Otherwise, just parse another
-	// expression.
-	if (type == BC_LEX_KW_DIVMOD)
+	// Only modexp() and divmod() take three arguments.
+	if (type != BC_LEX_KW_MODEXP && type != BC_LEX_KW_DIVMOD)
 	{
-		// Must have a name.
-		if (BC_ERR(p->l.t != BC_LEX_NAME)) bc_parse_err(p, BC_ERR_PARSE_TOKEN);
+		bc_parse_expr_status(p, flags, bc_parse_next_rel);
+	}
+	else
+	{
+		bc_parse_expr_status(p, flags, bc_parse_next_builtin);
+
+		// Must have a comma.
+		if (BC_ERR(p->l.t != BC_LEX_COMMA)) bc_parse_err(p, BC_ERR_PARSE_TOKEN);
 
-		// This is safe because the next token should not overwrite the name.
 		bc_lex_next(&p->l);
 
-		// Must have a left bracket.
-		if (BC_ERR(p->l.t != BC_LEX_LBRACKET))
+		// If it is a divmod, parse an array name. Otherwise, just parse another
+		// expression.
+		if (type == BC_LEX_KW_DIVMOD)
 		{
-			bc_parse_err(p, BC_ERR_PARSE_TOKEN);
-		}
+			// Must have a name.
+			if (BC_ERR(p->l.t != BC_LEX_NAME))
+			{
+				bc_parse_err(p, BC_ERR_PARSE_TOKEN);
+			}
 
-		// This is safe because the next token should not overwrite the name.
-		bc_lex_next(&p->l);
+			// This is safe because the next token should not overwrite the
+			// name.
+			bc_lex_next(&p->l);
 
-		// Must have a right bracket.
-		if (BC_ERR(p->l.t != BC_LEX_RBRACKET))
-		{
-			bc_parse_err(p, BC_ERR_PARSE_TOKEN);
-		}
+			// Must have a left bracket.
+			if (BC_ERR(p->l.t != BC_LEX_LBRACKET))
+			{
+				bc_parse_err(p, BC_ERR_PARSE_TOKEN);
+			}
 
-		// This is safe because the next token should not overwrite the name.
-		bc_lex_next(&p->l);
+			// This is safe because the next token should not overwrite the
+			// name.
+			bc_lex_next(&p->l);
+
+			// Must have a right bracket.
+			if (BC_ERR(p->l.t != BC_LEX_RBRACKET))
+			{
+				bc_parse_err(p, BC_ERR_PARSE_TOKEN);
+			}
+
+			// This is safe because the next token should not overwrite the
+			// name.
+			bc_lex_next(&p->l);
+		}
+		else bc_parse_expr_status(p, flags, bc_parse_next_rel);
 	}
-	else bc_parse_expr_status(p, flags, bc_parse_next_rel);
 
 	// Must have a right paren.
 	if (BC_ERR(p->l.t != BC_LEX_RPAREN)) bc_parse_err(p, BC_ERR_PARSE_TOKEN);
@@ -632,10 +728,9 @@ bc_parse_builtin3(BcParse* p, BcLexType type, uint8_t flags, BcInst* prev)
 	{
 		// The zeroth element.
 		bc_parse_push(p, BC_INST_ZERO);
-		bc_parse_push(p, BC_INST_ARRAY_ELEM);
 
 		// Push the array.
-		bc_parse_pushName(p, p->l.str.v, false);
+		bc_parse_pushVar(p, p->l.str.v, BC_INST_ARRAY_ELEM);
 
 		// Swap them and assign. After this, the top item on the stack should
 		// be the quotient.
@@ -724,6 +819,8 @@ bc_parse_incdec(BcParse* p, BcInst* prev, bool* can_assign, size_t* nexs,
 		// If so, this is a postfix operator.
 		if (!*can_assign) bc_parse_err(p, BC_ERR_PARSE_ASSIGN);
 
+		bc_parse_modGlobal(p, etype);
+
 		// Only postfix uses BC_INST_INC and BC_INST_DEC.
 		*prev = inst = BC_INST_INC + (p->l.t != BC_LEX_OP_INC);
 		bc_parse_push(p, inst);
@@ -753,7 +850,12 @@ bc_parse_incdec(BcParse* p, BcInst* prev, bool* can_assign, size_t* nexs,
 		// Is the next token a global?
 		else if (type >= BC_LEX_KW_LAST && type <= BC_LEX_KW_OBASE)
 		{
-			bc_parse_push(p, type - BC_LEX_KW_LAST + BC_INST_LAST);
+			// last is a global that pure functions cannot touch.
+			if (type == BC_LEX_KW_LAST) p->func->pure = false;
+
+			etype = (BcInst) (type - BC_LEX_KW_LAST + BC_INST_LAST);
+			bc_parse_modGlobal(p, etype);
+			bc_parse_push(p, etype);
 			bc_lex_next(&p->l);
 		}
 		// Is the next token specifically scale, which needs special treatment?
@@ -766,7 +868,9 @@ bc_parse_incdec(BcParse* p, BcInst* prev, bool* can_assign, size_t* nexs,
 			{
 				bc_parse_err(p, BC_ERR_PARSE_TOKEN);
 			}
-			else bc_parse_push(p, BC_INST_SCALE);
+
+			bc_parse_modGlobal(p, BC_INST_SCALE);
+			bc_parse_push(p, BC_INST_SCALE);
 		}
 		// Now we know we have an error.
 		else bc_parse_err(p, BC_ERR_PARSE_TOKEN);
@@ -815,6 +919,9 @@ bc_parse_minus(BcParse* p, BcInst* prev, size_t ops_bgn, bool rparen,
 static void
 bc_parse_str(BcParse* p, BcInst inst)
 {
+	// Printing is a side effect, so a pure function cannot do it.
+	p->func->pure = false;
+
 	bc_parse_addString(p);
 	bc_parse_push(p, inst);
 	bc_lex_next(&p->l);
@@ -832,6 +939,9 @@ bc_parse_print(BcParse* p, BcLexType type)
 	BcInst inst = type == BC_LEX_KW_STREAM ? BC_INST_PRINT_STREAM :
 	                                         BC_INST_PRINT_POP;
 
+	// Printing is a side effect, so a pure function cannot do it.
+	p->func->pure = false;
+
 	bc_lex_next(&p->l);
 
 	t = p->l.t;
@@ -1369,7 +1479,7 @@ bc_parse_loopExit(BcParse* p, BcLexType type)
 static void
 bc_parse_func(BcParse* p)
 {
-	bool comma = false, voidfn;
+	bool comma = false, voidfn, pure;
 	uint16_t flags;
 	size_t idx;
 
@@ -1382,18 +1492,25 @@ bc_parse_func(BcParse* p)
 	voidfn = (!BC_IS_POSIX && p->l.t == BC_LEX_NAME &&
 	          !strcmp(p->l.str.v, "void"));
 
+	// Same for "pure".
+	pure = (!BC_IS_POSIX && p->l.t == BC_LEX_NAME &&
+	        !strcmp(p->l.str.v, "pure"));
+
 	// We can safely do this because the expected token should not overwrite the
 	// function name.
 	bc_lex_next(&p->l);
 
-	// If we *don't* have another name, then void is the name of the function.
+	// If we *don't* have another name, then void or pure is the name of the
+	// function.
 	voidfn = (voidfn && p->l.t == BC_LEX_NAME);
+	pure = (pure && p->l.t == BC_LEX_NAME);
 
-	// With a void function, allow POSIX to complain and get a new token.
-	if (voidfn)
-	{
-		bc_parse_err(p, BC_ERR_POSIX_VOID);
+	// With a void function, allow POSIX to complain.
+	if (voidfn) bc_parse_err(p, BC_ERR_POSIX_VOID);
 
+	// Get a new token for the actual name.
+	if (voidfn || pure)
+	{
 		// We can safely do this because the expected token should not overwrite
 		// the function name.
 		bc_lex_next(&p->l);
@@ -1412,8 +1529,10 @@ bc_parse_func(BcParse* p)
 	assert(idx);
 
 	// Update the function pointer and stuff in the parser and set its void.
+	// Parsing the body may find that a pure function is not pure after all.
 	bc_parse_updateFunc(p, idx);
 	p->func->voidfn = voidfn;
+	p->func->pure = pure;
 
 	bc_lex_next(&p->l);
 
@@ -1470,6 +1589,9 @@ bc_parse_func(BcParse* p)
 		comma = (p->l.t == BC_LEX_COMMA);
 		if (comma) bc_lex_next(&p->l);
 
+		// Memoizing arrays is not worth it, and references are side effects.
+		if (t != BC_TYPE_VAR) p->func->pure = false;
+
 		// Insert the parameter into the function.
 		bc_func_insert(p->func, p->prog, p->buf.v, t, p->l.line);
 	}
@@ -1717,9 +1839,16 @@ bc_parse_stmt(BcParse* p)
 #if BC_ENABLE_EXTRA_MATH
 		case BC_LEX_KW_IRAND:
 #endif // BC_ENABLE_EXTRA_MATH
+		case BC_LEX_KW_FIB:
 		case BC_LEX_KW_ASCIIFY:
 		case BC_LEX_KW_MODEXP:
 		case BC_LEX_KW_DIVMOD:
+		case BC_LEX_KW_ROOT:
+		case BC_LEX_KW_GCD:
+		case BC_LEX_KW_LCM:
+		case BC_LEX_KW_MODINV:
+		case BC_LEX_KW_PERM:
+		case BC_LEX_KW_COMB:
 		case BC_LEX_KW_READ:
 #if BC_ENABLE_EXTRA_MATH
 		case BC_LEX_KW_RAND:
@@ -2122,6 +2251,8 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 					bc_parse_err(p, BC_ERR_PARSE_ASSIGN);
 				}
 
+				bc_parse_modGlobal(p, prev);
+
 				// Fallthrough.
 				BC_FALLTHROUGH
 			}
@@ -2302,6 +2433,13 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 					bc_parse_err(p, BC_ERR_PARSE_EXPR);
 				}
 
+				// Pure functions can use ibase and obase, but not the other
+				// globals.
+				if (t != BC_LEX_KW_IBASE && t != BC_LEX_KW_OBASE)
+				{
+					p->func->pure = false;
+				}
+
 				prev = t - BC_LEX_KW_LAST + BC_INST_LAST;
 				bc_parse_push(p, prev);
 
@@ -2321,6 +2459,7 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 #if BC_ENABLE_EXTRA_MATH
 			case BC_LEX_KW_IRAND:
 #endif // BC_ENABLE_EXTRA_MATH
+			case BC_LEX_KW_FIB:
 			case BC_LEX_KW_ASCIIFY:
 			{
 				// All of these are leaves and cannot come right after a leaf.
@@ -2329,6 +2468,11 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 					bc_parse_err(p, BC_ERR_PARSE_EXPR);
 				}
 
+#if BC_ENABLE_EXTRA_MATH
+				// irand() is not pure.
+				if (t == BC_LEX_KW_IRAND) p->func->pure = false;
+#endif // BC_ENABLE_EXTRA_MATH
+
 				bc_parse_builtin(p, t, flags, &prev);
 
 				rprn = get_token = bin_last = incdec = can_assign = false;
@@ -2364,6 +2508,9 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 					bc_parse_err(p, BC_ERR_EXEC_REC_READ);
 				}
 
+				// read() and rand(), which come first, are not pure.
+				if (t < BC_LEX_KW_MAXIBASE) p->func->pure = false;
+
 				prev = t - BC_LEX_KW_READ + BC_INST_READ;
 				bc_parse_noArgBuiltin(p, prev);
 
@@ -2395,6 +2542,12 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 
 			case BC_LEX_KW_MODEXP:
 			case BC_LEX_KW_DIVMOD:
+			case BC_LEX_KW_ROOT:
+			case BC_LEX_KW_GCD:
+			case BC_LEX_KW_LCM:
+			case BC_LEX_KW_MODINV:
+			case BC_LEX_KW_PERM:
+			case BC_LEX_KW_COMB:
 			{
 				// This is a leaf and cannot come right after a leaf.
 				if (BC_ERR(BC_PARSE_LEAF(prev, bin_last, rprn)))
@@ -2564,7 +2717,11 @@ bc_parse_expr_err(BcParse* p, uint8_t flags, BcParseNext next)
 	{
 		// With a paren first or the last operator not being an assignment, we
 		// *do* want to print.
-		if (pfirst || !assign) bc_parse_push(p, BC_INST_PRINT);
+		if (pfirst || !assign)
+		{
+			bc_parse_push(p, BC_INST_PRINT);
+			p->func->pure = false;
+		}
 	}
 	// We need to make sure to push a pop instruction for assignment statements
 	// that will not print. The print will pop, but without it, we need to pop.
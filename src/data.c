@@ -694,6 +694,9 @@ const char* bc_inst_names[] = {
 
 	"BC_INST_NUM",
 	"BC_INST_VAR",
+#if BC_ENABLED
+	"BC_INST_LOCAL",
+#endif // BC_ENABLED
 	"BC_INST_ARRAY_ELEM",
 	"BC_INST_ARRAY",
 
@@ -718,6 +721,7 @@ const char* bc_inst_names[] = {
 #if BC_ENABLE_EXTRA_MATH
 	"BC_INST_IRAND",
 #endif // BC_ENABLE_EXTRA_MATH
+	"BC_INST_FIB",
 	"BC_INST_ASCIIFY",
 	"BC_INST_READ",
 #if BC_ENABLE_EXTRA_MATH
@@ -752,6 +756,12 @@ const char* bc_inst_names[] = {
 	"BC_INST_SWAP",
 	"BC_INST_MODEXP",
 	"BC_INST_DIVMOD",
+	"BC_INST_ROOT",
+	"BC_INST_GCD",
+	"BC_INST_LCM",
+	"BC_INST_MODINV",
+	"BC_INST_PERM",
+	"BC_INST_COMB",
 	"BC_INST_PRINT_STREAM",
 
 #if DC_ENABLED
@@ -817,9 +827,16 @@ const BcLexKeyword bc_lex_kws[] = {
 #if BC_ENABLE_EXTRA_MATH
 	BC_LEX_KW_ENTRY("irand", 5, false),
 #endif // BC_ENABLE_EXTRA_MATH
+	BC_LEX_KW_LIB_ENTRY("bc_fib", 6),
 	BC_LEX_KW_ENTRY("asciify", 7, false),
 	BC_LEX_KW_ENTRY("modexp", 6, false),
 	BC_LEX_KW_ENTRY("divmod", 6, false),
+	BC_LEX_KW_LIB_ENTRY("bc_root", 7),
+	BC_LEX_KW_LIB_ENTRY("bc_gcd", 6),
+	BC_LEX_KW_LIB_ENTRY("bc_lcm", 6),
+	BC_LEX_KW_LIB_ENTRY("bc_modinv", 9),
+	BC_LEX_KW_LIB_ENTRY("bc_perm", 7),
+	BC_LEX_KW_LIB_ENTRY("bc_comb", 7),
 	BC_LEX_KW_ENTRY("quit", 4, true),
 	BC_LEX_KW_ENTRY("read", 4, false),
 #if BC_ENABLE_EXTRA_MATH
@@ -888,11 +905,14 @@ const uint8_t bc_parse_exprs[] = {
 	// Starts with BC_LEX_KW_SQRT.
 	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, true, true),
 
-	// Starts with BC_LEX_KW_QUIT.
-	BC_PARSE_EXPR_ENTRY(false, true, true, true, true, true, true, true),
+	// Starts with BC_LEX_KW_DIVMOD.
+	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, true, false),
+
+	// Starts with BC_LEX_KW_READ.
+	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, true, true),
 
-	// Starts with BC_LEX_KW_GLOBAL_STACKS.
-	BC_PARSE_EXPR_ENTRY(true, true, false, false, 0, 0, 0, 0)
+	// Starts with BC_LEX_KW_LEADING_ZERO.
+	BC_PARSE_EXPR_ENTRY(true, false, false, 0, 0, 0, 0, 0)
 
 #else // BC_ENABLE_EXTRA_MATH
 
@@ -909,13 +929,13 @@ const uint8_t bc_parse_exprs[] = {
 	BC_PARSE_EXPR_ENTRY(false, false, true, true, true, true, true, false),
 
 	// Starts with BC_LEX_KW_SQRT.
-	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, true, false),
+	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, true, true),
 
-	// Starts with BC_LEX_KW_MAXIBASE.
-	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, true, false),
+	// Starts with BC_LEX_KW_ROOT.
+	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, false, true),
 
-	// Starts with  BC_LEX_KW_ELSE.
-	BC_PARSE_EXPR_ENTRY(false, 0, 0, 0, 0, 0, 0, 0)
+	// Starts with BC_LEX_KW_MAXIBASE.
+	BC_PARSE_EXPR_ENTRY(true, true, true, true, true, true, false, false)
 
 #endif // BC_ENABLE_EXTRA_MATH
 };
@@ -1018,7 +1038,7 @@ const uchar dc_lex_tokens[] = {
 	BC_LEX_INVALID,
 #endif // BC_ENABLE_EXTRA_MATH
 	BC_LEX_OP_MODULUS,
-	BC_LEX_INVALID,
+	BC_LEX_KW_GCD,
 #if BC_ENABLE_EXTRA_MATH
 	BC_LEX_KW_RAND,
 #else // BC_ENABLE_EXTRA_MATH
@@ -1096,7 +1116,7 @@ const uchar dc_lex_tokens[] = {
 	BC_LEX_INVALID,
 	BC_LEX_OP_POWER,
 	BC_LEX_NEG,
-	BC_LEX_INVALID,
+	BC_LEX_KW_MODINV,
 	BC_LEX_KW_ASCIIFY,
 	BC_LEX_KW_ABS,
 	BC_LEX_CLEAR_STACK,
@@ -1127,7 +1147,7 @@ const uchar dc_lex_tokens[] = {
 	BC_LEX_KW_IS_STRING,
 	BC_LEX_KW_IS_NUMBER,
 	BC_LEX_KW_SQRT,
-	BC_LEX_INVALID,
+	BC_LEX_KW_ROOT,
 	BC_LEX_EXECUTE,
 	BC_LEX_REG_STACK_LEVEL,
 	BC_LEX_STACK_LEVEL,
@@ -1197,9 +1217,12 @@ const uchar dc_parse_insts[] = {
 #if BC_ENABLE_EXTRA_MATH
 	BC_INST_IRAND,
 #endif // BC_ENABLE_EXTRA_MATH
-	BC_INST_ASCIIFY,      BC_INST_MODEXP,
-	BC_INST_DIVMOD,       BC_INST_QUIT,
-	BC_INST_INVALID,
+	BC_INST_INVALID,      BC_INST_ASCIIFY,
+	BC_INST_MODEXP,       BC_INST_DIVMOD,
+	BC_INST_ROOT,         BC_INST_GCD,
+	BC_INST_INVALID,      BC_INST_MODINV,
+	BC_INST_INVALID,      BC_INST_INVALID,
+	BC_INST_QUIT,         BC_INST_INVALID,
 #if BC_ENABLE_EXTRA_MATH
 	BC_INST_RAND,
 #endif // BC_ENABLE_EXTRA_MATH
@@ -1293,6 +1316,19 @@ const char bc_num_hex_digits[] = "0123456789ABCDEF";
 
 // clang-format off
 
+/// The decimal strings of 00 to 99, back to back, for converting two digits at
+/// a time.
+const char bc_num_dec_pairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+// clang-format on
+
+// clang-format off
+
 /// An array for easy conversion from exponent to power of 10.
 const BcBigDig bc_num_pow10[BC_BASE_DIGS + 1] = {
 	1,
@@ -1323,6 +1359,17 @@ const BcNumBinaryOp bc_program_ops[] = {
 #endif // BC_ENABLE_EXTRA_MATH
 };
 
+/// An array of functions for the builtins that take two numbers, root() through
+/// comb(), corresponding to the order of their instructions.
+const BcNumBinaryOp bc_program_funcs[] = {
+	bc_num_root,
+	bc_num_gcd,
+	bc_num_lcm,
+	bc_num_modinv,
+	bc_num_perm,
+	bc_num_comb,
+};
+
 /// An array of functions for binary operators allocation requests corresponding
 /// to the order of the instructions for the operators.
 const BcNumBinaryOpReq bc_program_opReqs[] = {
@@ -329,9 +329,16 @@ dc_parse_token(BcParse* p, BcLexType t, uint8_t flags)
 #if BC_ENABLE_EXTRA_MATH
 		case BC_LEX_KW_IRAND:
 #endif // BC_ENABLE_EXTRA_MATH
+		case BC_LEX_KW_FIB:
 		case BC_LEX_KW_ASCIIFY:
 		case BC_LEX_KW_MODEXP:
 		case BC_LEX_KW_DIVMOD:
+		case BC_LEX_KW_ROOT:
+		case BC_LEX_KW_GCD:
+		case BC_LEX_KW_LCM:
+		case BC_LEX_KW_MODINV:
+		case BC_LEX_KW_PERM:
+		case BC_LEX_KW_COMB:
 		case BC_LEX_KW_QUIT:
 #if BC_ENABLE_EXTRA_MATH
 		case BC_LEX_KW_RAND:
@@ -35,9 +35,11 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifndef _WIN32
+#include <sys/uio.h>
 #include <unistd.h>
 #endif // _WIN32
 
@@ -117,6 +119,125 @@ bc_file_output(int fd, const char* buf, size_t n)
 	return BC_STATUS_SUCCESS;
 }
 
+/**
+ * Output two buffers to the file directly, one after the other. Where writev()
+ * is available, this only takes one system call in the common case.
+ * @param fd    The file descriptor.
+ * @param buf1  The first buffer of data to output.
+ * @param n1    The number of bytes in the first buffer.
+ * @param buf2  The second buffer of data to output.
+ * @param n2    The number of bytes in the second buffer.
+ * @return      A status indicating error or success. We could have a fatal I/O
+ *              error or EOF.
+ */
+static BcStatus
+bc_file_outputv(int fd, const char* buf1, size_t n1, const char* buf2,
+                size_t n2)
+{
+#ifndef _WIN32
+
+	struct iovec iov[2];
+	sig_atomic_t lock;
+
+	BC_SIG_TRYLOCK(lock);
+
+	// The casts are fine because writev() does not actually write to these.
+	iov[0].iov_base = (void*) buf1;
+	iov[0].iov_len = n1;
+	iov[1].iov_base = (void*) buf2;
+	iov[1].iov_len = n2;
+
+	// While there is still something in the second buffer...
+	while (iov[1].iov_len)
+	{
+		// Skip the first buffer if it has already been written.
+		int first = (iov[0].iov_len == 0);
+		ssize_t written = writev(fd, iov + first, 2 - first);
+		size_t bytes;
+
+		// Check for error and return, if any.
+		if (BC_ERR(written == -1))
+		{
+			BC_SIG_TRYUNLOCK(lock);
+
+			return errno == EPIPE ? BC_STATUS_EOF : BC_STATUS_ERROR_FATAL;
+		}
+
+		bytes = (size_t) written;
+
+		// Advance past what was written. A partial write can stop anywhere.
+		if (bytes < iov[0].iov_len)
+		{
+			iov[0].iov_base = ((char*) iov[0].iov_base) + bytes;
+			iov[0].iov_len -= bytes;
+		}
+		else
+		{
+			bytes -= iov[0].iov_len;
+			iov[0].iov_len = 0;
+			iov[1].iov_base = ((char*) iov[1].iov_base) + bytes;
+			iov[1].iov_len -= bytes;
+		}
+	}
+
+	BC_SIG_TRYUNLOCK(lock);
+
+	return BC_STATUS_SUCCESS;
+
+#else // _WIN32
+
+	BcStatus s = bc_file_output(fd, buf1, n1);
+
+	if (BC_NO_ERR(!s)) s = bc_file_output(fd, buf2, n2);
+
+	return s;
+
+#endif // _WIN32
+}
+
+/**
+ * Tries to grow the buffer of a file so that it can fit @a n more bytes. It
+ * does nothing if the file is not allowed to grow or if @a n would not fit even
+ * at the maximum capacity. Failing to allocate is not an error either; it just
+ * means we flush like we would have anyway.
+ * @param f  The file whose buffer should grow.
+ * @param n  The number of bytes that need to fit.
+ */
+static void
+bc_file_grow(BcFile* restrict f, size_t n)
+{
+	size_t cap = f->cap;
+	char* buf;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	// No point in growing if it will never fit.
+	if (f->cap >= f->max || n > f->max) return;
+
+	// Double until it fits or we hit the max. If it won't fit with the data
+	// already in the buffer, growing to the max still makes the flush worth
+	// more.
+	while (cap < f->max && cap - f->len < n)
+	{
+		cap = cap > f->max / 2 ? f->max : cap * 2;
+	}
+
+	if (f->alloc) buf = realloc(f->buf, cap);
+	else
+	{
+		buf = malloc(cap);
+
+		// NOLINTNEXTLINE
+		if (buf != NULL) memcpy(buf, f->buf, f->len);
+	}
+
+	if (buf == NULL) return;
+
+	f->buf = buf;
+	f->cap = cap;
+	f->alloc = true;
+}
+
 #endif // !BC_ENABLE_LINE_LIB
 
 BcStatus
@@ -212,8 +333,6 @@ bc_file_flush(BcFile* restrict f, BcFlushType type)
 	BC_SIG_TRYUNLOCK(lock);
 }
 
-#if !BC_ENABLE_LINE_LIB
-
 void
 bc_file_write(BcFile* restrict f, BcFlushType type, const char* buf, size_t n)
 {
@@ -221,18 +340,53 @@ bc_file_write(BcFile* restrict f, BcFlushType type, const char* buf, size_t n)
 
 	BC_SIG_TRYLOCK(lock);
 
-	// If we have enough to flush, do it.
-	if (n > f->cap - f->len)
+#if BC_ENABLE_LINE_LIB
+
+	if (BC_ERR(fwrite(buf, 1, n, f->f) != n))
 	{
-		bc_file_flush(f, type);
-		assert(!f->len);
+		// This is here to prevent a stack overflow from unbounded recursion.
+		if (f->f == stderr) exit(BC_STATUS_ERROR_FATAL);
+
+		bc_err(BC_ERR_FATAL_IO_ERR);
 	}
 
-	// If the output is large enough to flush by itself, just output it.
-	// Otherwise, put it into the buffer.
-	if (BC_UNLIKELY(n > f->cap - f->len))
+#else // BC_ENABLE_LINE_LIB
+
+	// If it does not fit, see if we can make room instead of flushing.
+	if (n > f->cap - f->len) bc_file_grow(f, n);
+
+	// If it fits, put it into the buffer. If it will fit once the buffer is
+	// flushed, flush and then put it in the buffer.
+	if (BC_LIKELY(n <= f->cap))
+	{
+		if (n > f->cap - f->len)
+		{
+			bc_file_flush(f, type);
+			assert(!f->len);
+		}
+
+		// NOLINTNEXTLINE
+		memcpy(f->buf + f->len, buf, n);
+		f->len += n;
+	}
+	// Otherwise, the output is large enough to go out by itself, along with
+	// whatever is in the buffer.
+	else
 	{
-		BcStatus s = bc_file_output(f->fd, buf, n);
+		BcStatus s;
+
+#if BC_ENABLE_HISTORY
+		// History needs to see what is in the buffer when it is flushed, so it
+		// cannot be combined with the rest.
+		if (BC_TTY)
+		{
+			bc_file_flush(f, type);
+			assert(!f->len);
+		}
+#endif // BC_ENABLE_HISTORY
+
+		s = bc_file_outputv(f->fd, f->buf, f->len, buf, n);
+		f->len = 0;
 
 		if (BC_ERR(s))
 		{
@@ -252,18 +406,12 @@ bc_file_write(BcFile* restrict f, BcFlushType type, const char* buf, size_t n)
 			else exit(BC_STATUS_ERROR_FATAL);
 		}
 	}
-	else
-	{
-		// NOLINTNEXTLINE
-		memcpy(f->buf + f->len, buf, n);
-		f->len += n;
-	}
+
+#endif // BC_ENABLE_LINE_LIB
 
 	BC_SIG_TRYUNLOCK(lock);
 }
 
-#endif // BC_ENABLE_LINE_LIB
-
 void
 bc_file_printf(BcFile* restrict f, const char* fmt, ...)
 {
@@ -441,7 +589,12 @@ bc_file_putchar(BcFile* restrict f, BcFlushType type, uchar c)
 
 #else // BC_ENABLE_LINE_LIB
 
-	if (f->len == f->cap) bc_file_flush(f, type);
+	// Try to grow before flushing.
+	if (f->len == f->cap)
+	{
+		bc_file_grow(f, 1);
+		if (f->len == f->cap) bc_file_flush(f, type);
+	}
 
 	assert(f->len < f->cap);
 
@@ -474,14 +627,34 @@ bc_file_init(BcFile* f, int fd, char* buf, size_t cap, bool errors_fatal)
 	f->buf = buf;
 	f->len = 0;
 	f->cap = cap;
+	f->max = cap;
+	f->alloc = false;
 	f->errors_fatal = errors_fatal;
 }
 
+void
+bc_file_setMax(BcFile* f, size_t max)
+{
+	if (max > f->cap) f->max = max;
+}
+
 #endif // BC_ENABLE_LINE_LIB
 
 void
 bc_file_free(BcFile* f)
 {
 	BC_SIG_ASSERT_LOCKED;
+
 	bc_file_flush(f, bc_flush_none);
+
+#if !BC_ENABLE_LINE_LIB
+	// Free the buffer if it grew.
+	if (f->alloc)
+	{
+		free(f->buf);
+		f->buf = NULL;
+		f->len = f->cap = f->max = 0;
+		f->alloc = false;
+	}
+#endif // !BC_ENABLE_LINE_LIB
 }
@@ -81,9 +81,11 @@ bc_func_insert(BcFunc* f, BcProgram* p, char* name, BcType type, size_t line)
 		}
 	}
 
-	// Set the auto.
+	// Set the auto. Variables go in slots unless some function needs to see
+	// them on their variable stack.
 	a.idx = idx;
 	a.type = type;
+	a.slot = (type == BC_TYPE_VAR && !BC_PROG_VAR_DYN(p, idx));
 
 	// Push it.
 	bc_vec_push(&f->autos, &a);
@@ -106,9 +108,15 @@ bc_func_init(BcFunc* f, const char* name)
 	{
 		bc_vec_init(&f->autos, sizeof(BcAuto), BC_DTOR_NONE);
 		bc_vec_init(&f->labels, sizeof(size_t), BC_DTOR_NONE);
+		bc_vec_init(&f->memo, sizeof(BcMemo), BC_DTOR_NONE);
+		bc_vec_init(&f->memo_nums, sizeof(BcNum), BC_DTOR_NUM);
+		bc_vec_init(&f->memo_table, sizeof(size_t), BC_DTOR_NONE);
 
 		f->nparams = 0;
+		f->memo_hand = 0;
 		f->voidfn = false;
+		f->pure = false;
+		f->globals = 0;
 	}
 
 #endif // BC_ENABLED
@@ -129,13 +137,31 @@ bc_func_reset(BcFunc* f)
 	{
 		bc_vec_popAll(&f->autos);
 		bc_vec_popAll(&f->labels);
+		bc_func_forget(f);
 
 		f->nparams = 0;
 		f->voidfn = false;
+		f->pure = false;
+		f->globals = 0;
 	}
 #endif // BC_ENABLED
 }
 
+#if BC_ENABLED
+void
+bc_func_forget(BcFunc* f)
+{
+	BC_SIG_ASSERT_LOCKED;
+	assert(f != NULL);
+
+	bc_vec_popAll(&f->memo);
+	bc_vec_popAll(&f->memo_nums);
+	bc_vec_popAll(&f->memo_table);
+
+	f->memo_hand = 0;
+}
+#endif // BC_ENABLED
+
 #if BC_DEBUG
 void
 bc_func_free(void* func)
@@ -152,6 +178,9 @@ bc_func_free(void* func)
 	{
 		bc_vec_free(&f->autos);
 		bc_vec_free(&f->labels);
+		bc_vec_free(&f->memo);
+		bc_vec_free(&f->memo_nums);
+		bc_vec_free(&f->memo_table);
 	}
 #endif // BC_ENABLED
 }
@@ -276,6 +305,9 @@ bc_result_copy(BcResult* d, BcResult* src)
 		}
 
 		case BC_RESULT_VAR:
+#if BC_ENABLED
+		case BC_RESULT_LOCAL:
+#endif // BC_ENABLED
 		case BC_RESULT_ARRAY:
 		case BC_RESULT_ARRAY_ELEM:
 		{
@@ -336,6 +368,9 @@ bc_result_free(void* result)
 		}
 
 		case BC_RESULT_VAR:
+#if BC_ENABLED
+		case BC_RESULT_LOCAL:
+#endif // BC_ENABLED
 		case BC_RESULT_ARRAY:
 		case BC_RESULT_ARRAY_ELEM:
 		case BC_RESULT_STR:
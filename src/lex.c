@@ -152,7 +152,7 @@ static size_t
 bc_lex_num(BcLex* l, char start, bool int_only)
 {
 	const char* buf = l->buf + l->i;
-	size_t i;
+	size_t i, len = l->len - l->i;
 	char c;
 	bool last_pt, pt = (start == '.');
 
@@ -164,6 +164,17 @@ bc_lex_num(BcLex* l, char start, bool int_only)
 	                             (c == '\\' && buf[i + 1] == '\n'));
 	     ++i)
 	{
+		// Long runs of plain digits are pushed all at once. The last one is
+		// left to go through the normal path.
+		size_t run = bc_num_digitRun(buf + i, len - i);
+
+		if (run > 1)
+		{
+			bc_vec_npush(&l->str, run - 1, buf + i);
+			i += run - 1;
+			c = buf[i];
+		}
+
 		// I don't need to test that the next character is a newline because
 		// the loop condition above ensures that.
 		if (c == '\\')
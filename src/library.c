@@ -35,6 +35,7 @@
 
 #if BC_ENABLE_LIBRARY
 
+#include <ctype.h>
 #include <setjmp.h>
 #include <string.h>
 #include <time.h>
@@ -47,6 +48,7 @@
 
 #ifndef _WIN32
 #include <pthread.h>
+#include <unistd.h>
 #endif // _WIN32
 
 // The asserts in this file are important to testing; in many cases, the test
@@ -82,6 +84,39 @@ bcl_numIdxOutOfRange(void)
 
 #endif // BC_ENABLE_MEMCHECK
 
+#if BCL_HAS_THREAD_LOCAL
+
+BCL_THREAD_LOCAL BcVm* bcl_vm = NULL;
+
+// With thread-local storage, there is no key to create, so this only records
+// that the library was started.
+static bool tls = false;
+
+BclError
+bcl_start(void)
+{
+	tls = true;
+
+	return BCL_ERROR_NONE;
+}
+
+/**
+ * Sets the thread-specific data for the thread.
+ * @param vm  The @a BcVm to set as the thread data.
+ * @return    An error code, if any.
+ */
+static BclError
+bcl_setspecific(BcVm* vm)
+{
+	assert(tls);
+
+	bcl_vm = vm;
+
+	return BCL_ERROR_NONE;
+}
+
+#else // BCL_HAS_THREAD_LOCAL
+
 static BclTls* tls = NULL;
 static BclTls tls_real;
 
@@ -163,13 +198,15 @@ bcl_getspecific(void)
 	return vm;
 }
 
+#endif // BCL_HAS_THREAD_LOCAL
+
 BclError
 bcl_init(void)
 {
 	BclError e = BCL_ERROR_NONE;
 	BcVm* vm;
 
-	assert(tls != NULL);
+	assert(tls);
 
 	vm = bcl_getspecific();
 	if (vm != NULL)
@@ -311,6 +348,12 @@ bcl_free(void)
 void
 bcl_end(void)
 {
+#if BCL_HAS_THREAD_LOCAL
+
+	tls = false;
+
+#else // BCL_HAS_THREAD_LOCAL
+
 #ifndef _WIN32
 
 	// We ignore the return value.
@@ -324,6 +367,8 @@ bcl_end(void)
 #endif // _WIN32
 
 	tls = NULL;
+
+#endif // BCL_HAS_THREAD_LOCAL
 }
 
 void
@@ -392,8 +437,21 @@ bcl_ctxt_create(void)
 	// malloc() is appropriate here.
 	ctxt = bc_vm_malloc(sizeof(BclCtxt));
 
-	bc_vec_init(&ctxt->nums, sizeof(BclNum), BC_DTOR_BCL_NUM);
-	bc_vec_init(&ctxt->free_nums, sizeof(BclNumber), BC_DTOR_NONE);
+	bc_vec_init(&ctxt->nums, sizeof(BclNum*), BC_DTOR_NONE);
+
+	ctxt->nnums = 0;
+	ctxt->free_nums = BCL_NUMS_END;
+	ctxt->nfree = 0;
+
+	bc_num_clear(&ctxt->spare);
+
+	ctxt->arena.chunks = NULL;
+	ctxt->use_arena = false;
+
+	BCL_CANCEL_SET(ctxt->cancel, 0);
+	ctxt->polls = 0;
+	ctxt->progress = NULL;
+	ctxt->progress_data = NULL;
 
 	ctxt->scale = 0;
 	ctxt->ibase = 10;
@@ -413,19 +471,318 @@ err:
 	return ctxt;
 }
 
+BcDig*
+bcl_arena_alloc(BclArena* a, size_t n)
+{
+	BclArenaChunk* chunk = a->chunks;
+	BcDig* ptr;
+
+	if (chunk == NULL || n > chunk->size - chunk->used)
+	{
+		size_t size = chunk == NULL ? BCL_ARENA_CHUNK : chunk->size;
+
+		// Double the size to keep the number of chunks logarithmic.
+		if (chunk != NULL) size = bc_vm_growSize(size, size);
+		if (size < n) size = n;
+
+		chunk = bc_vm_malloc(bc_vm_growSize(sizeof(BclArenaChunk),
+		                                    bc_vm_arraySize(size,
+		                                                    sizeof(BcDig))));
+
+		chunk->next = a->chunks;
+		chunk->data = (BcDig*) (chunk + 1);
+		chunk->size = size;
+		chunk->used = 0;
+
+		a->chunks = chunk;
+	}
+
+	ptr = chunk->data + chunk->used;
+	chunk->used += n;
+
+	return ptr;
+}
+
+BcDig*
+bcl_arena_realloc(BclArena* a, BcDig* ptr, size_t old, size_t n)
+{
+	BclArenaChunk* chunk = a->chunks;
+	BcDig* res;
+
+	assert(n > old);
+
+	// If the limbs are the last ones handed out, and there is room, they can
+	// just be extended.
+	if (ptr + old == chunk->data + chunk->used &&
+	    n - old <= chunk->size - chunk->used)
+	{
+		chunk->used += n - old;
+		return ptr;
+	}
+
+	res = bcl_arena_alloc(a, n);
+
+	// NOLINTNEXTLINE
+	memcpy(res, ptr, BC_NUM_SIZE(old));
+
+	return res;
+}
+
+void
+bcl_arena_free(BclArena* a, BcDig* ptr, size_t n)
+{
+	BclArenaChunk* chunk = a->chunks;
+
+	// Only the last limbs handed out can be given back.
+	if (ptr + n == chunk->data + chunk->used) chunk->used -= n;
+}
+
+bool
+bcl_arena_owns(const BclArena* a, const BcDig* ptr)
+{
+	const BclArenaChunk* chunk;
+
+	for (chunk = a->chunks; chunk != NULL; chunk = chunk->next)
+	{
+		if (ptr >= chunk->data && ptr < chunk->data + chunk->size) return true;
+	}
+
+	return false;
+}
+
+/**
+ * Gives back all of the limbs in an arena at once. Only the newest chunk, which
+ * is the biggest, is kept.
+ * @param a  The arena.
+ */
+static void
+bcl_arena_reset(BclArena* a)
+{
+	BclArenaChunk* chunk = a->chunks;
+
+	if (chunk == NULL) return;
+
+	while (chunk->next != NULL)
+	{
+		BclArenaChunk* next = chunk->next;
+		chunk->next = next->next;
+		free(next);
+	}
+
+	chunk->used = 0;
+}
+
+/**
+ * Frees all of the chunks of an arena.
+ * @param a  The arena.
+ */
+static void
+bcl_arena_destroy(BclArena* a)
+{
+	while (a->chunks != NULL)
+	{
+		BclArenaChunk* next = a->chunks->next;
+		free(a->chunks);
+		a->chunks = next;
+	}
+}
+
 void
 bcl_ctxt_free(BclContext ctxt)
 {
-	bc_vec_free(&ctxt->free_nums);
+	size_t i;
+	BcVm* vm = bcl_getspecific();
+
+	bcl_ctxt_freeNums(ctxt);
+
+	if (ctxt->spare.num != NULL) bc_num_free(&ctxt->spare);
+
+	for (i = 0; i < ctxt->nums.len; ++i)
+	{
+		free(*((BclNum**) bc_vec_item(&ctxt->nums, i)));
+	}
+
+	// Make sure that the BcVm does not keep using the context or its arena.
+	if (vm->ctxt == ctxt) vm->ctxt = NULL;
+	if (vm->arena == &ctxt->arena) vm->arena = NULL;
+
+	bcl_arena_destroy(&ctxt->arena);
+
 	bc_vec_free(&ctxt->nums);
 	free(ctxt);
 }
 
+/**
+ * Frees the number in a slot and bumps the slot's generation index so that
+ * BclNumbers that refer to it are caught.
+ * @param ctxt  The context that the slot is in.
+ * @param num   The slot.
+ */
+static void
+bcl_num_release(BclContext ctxt, BclNum* restrict num)
+{
+	if (ctxt->use_arena && bcl_arena_owns(&ctxt->arena, BCL_NUM_ARRAY(num)))
+	{
+		bcl_arena_free(&ctxt->arena, BCL_NUM_ARRAY(num), num->n.cap);
+		bc_num_clear(BCL_NUM_NUM(num));
+	}
+	else bcl_num_destruct(num);
+
+	num->gen_idx += 1;
+
+	if (num->gen_idx == UCHAR_MAX)
+	{
+		num->gen_idx = 0;
+	}
+}
+
 void
 bcl_ctxt_freeNums(BclContext ctxt)
 {
-	bc_vec_popAll(&ctxt->nums);
-	bc_vec_popAll(&ctxt->free_nums);
+	size_t i;
+
+	for (i = 0; i < ctxt->nnums; ++i)
+	{
+		BclNum* num = BCL_SLOT(ctxt, i);
+
+		// Free slots have already been released.
+		if (BCL_NUM_ARRAY(num) != NULL) bcl_num_release(ctxt, num);
+	}
+
+	// In arena mode, all of the limbs, including those of the spare and of any
+	// temporaries that were not given back, go at once.
+	if (ctxt->use_arena)
+	{
+		bc_num_clear(&ctxt->spare);
+		bcl_arena_reset(&ctxt->arena);
+	}
+
+	// The slabs are kept for reuse, and because the generation indices were
+	// bumped, old BclNumbers will not match the new numbers in them.
+	ctxt->nnums = 0;
+	ctxt->free_nums = BCL_NUMS_END;
+	ctxt->nfree = 0;
+}
+
+/**
+ * Adds slabs to a context's table of numbers until @a n numbers can be inserted
+ * without allocating. Existing slabs are never moved.
+ * @param ctxt  The context.
+ * @param n     The number of numbers that will be inserted.
+ */
+static void
+bcl_nums_grow(BclContext ctxt, size_t n)
+{
+	assert(BCL_NUMS_AVAIL(ctxt) < n);
+
+	// The index has to leave room for the generation index.
+	if (BC_ERR(n - ctxt->nfree > BCL_NUMS_MAX - ctxt->nnums))
+	{
+		bc_vm_fatalError(BC_ERR_FATAL_ALLOC_ERR);
+	}
+
+	while (BCL_NUMS_AVAIL(ctxt) < n)
+	{
+		BclNum* slab;
+
+		// Make room for the pointer first so that the slab cannot leak.
+		if (ctxt->nums.len == ctxt->nums.cap) bc_vec_grow(&ctxt->nums, 1);
+
+		slab = bc_vm_malloc(bc_vm_arraySize(BCL_NUMS_SLAB, sizeof(BclNum)));
+
+		// This makes every slot empty with a generation index of 0.
+		// NOLINTNEXTLINE
+		memset(slab, 0, BCL_NUMS_SLAB * sizeof(BclNum));
+
+		bc_vec_push(&ctxt->nums, &slab);
+	}
+}
+
+bool
+bcl_ctxt_arena(BclContext ctxt)
+{
+	return ctxt->use_arena;
+}
+
+void
+bcl_ctxt_setArena(BclContext ctxt, bool arena)
+{
+	BcVm* vm = bcl_getspecific();
+
+	if (arena == ctxt->use_arena) return;
+
+	// Numbers cannot move between malloc() and the arena, so they all go.
+	bcl_ctxt_freeNums(ctxt);
+
+	if (ctxt->spare.num != NULL)
+	{
+		vm->arena = NULL;
+		bc_num_free(&ctxt->spare);
+		bc_num_clear(&ctxt->spare);
+	}
+
+	ctxt->use_arena = arena;
+
+	if (!arena)
+	{
+		if (vm->arena == &ctxt->arena) vm->arena = NULL;
+		bcl_arena_destroy(&ctxt->arena);
+	}
+}
+
+void
+bcl_ctxt_cancel(BclContext ctxt)
+{
+	BCL_CANCEL_SET(ctxt->cancel, 1);
+}
+
+bool
+bcl_ctxt_cancelled(BclContext ctxt)
+{
+	return BCL_CANCEL_GET(ctxt->cancel) != 0;
+}
+
+void
+bcl_ctxt_clearCancel(BclContext ctxt)
+{
+	BCL_CANCEL_SET(ctxt->cancel, 0);
+}
+
+void
+bcl_ctxt_setProgress(BclContext ctxt, BclProgress progress, void* data)
+{
+	ctxt->progress = progress;
+	ctxt->progress_data = data;
+}
+
+void
+bcl_poll(BcVm* vm, BclCtxt* ctxt)
+{
+	// Errors in the library only unwind to the nearest cleanup, so once an
+	// operation is stopping, every poll has to jump again until it is out.
+	if (vm->err == BCL_ERROR_NONE)
+	{
+		if (!BCL_CANCEL_GET(ctxt->cancel))
+		{
+			if (ctxt->progress == NULL) return;
+
+			// The progress function is only called every so often.
+			ctxt->polls += 1;
+			if (ctxt->polls < BCL_PROGRESS_STRIDE) return;
+
+			ctxt->polls = 0;
+
+			if (ctxt->progress(ctxt->progress_data)) return;
+		}
+
+		vm->err = BCL_ERROR_SIGNAL;
+	}
+
+	// The cleanup that caught the last jump popped its own jmp_buf, so the top
+	// one is the right one to jump to.
+	vm->sig_pop = 0;
+
+	BC_JMP;
 }
 
 size_t
@@ -469,23 +826,25 @@ bcl_ctxt_setObase(BclContext ctxt, size_t obase)
 BclError
 bcl_err(BclNumber n)
 {
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
-
-	BC_CHECK_CTXT_ERR(vm, ctxt);
+	return bcl_err_ctx(bcl_context(), n);
+}
 
-	// We need to clear the top byte in memcheck mode. We can do this because
-	// the parameter is a copy.
-	BCL_CLEAR_GEN(n);
+BclError
+bcl_err_ctx(BclContext ctxt, BclNumber n)
+{
+	if (BC_ERR(ctxt == NULL)) return BCL_ERROR_INVALID_CONTEXT;
 
 	// Errors are encoded as (0 - error_code). If the index is in that range, it
-	// is an encoded error.
-	if (n.i >= ctxt->nums.len)
+	// is an encoded error. This has to be checked before the generation index
+	// is removed because the top byte is part of the error.
+	if (n.i > 0 - (size_t) BCL_ERROR_NELEMS) return (BclError) (0 - n.i);
+
+	if (BCL_NO_GEN(n) >= ctxt->nnums || BCL_NUM_STALE(ctxt, n))
 	{
-		if (n.i > 0 - (size_t) BCL_ERROR_NELEMS) return (BclError) (0 - n.i);
-		else return BCL_ERROR_INVALID_NUM;
+		return BCL_ERROR_INVALID_NUM;
 	}
-	else return BCL_ERROR_NONE;
+
+	return BCL_ERROR_NONE;
 }
 
 /**
@@ -498,46 +857,35 @@ static BclNumber
 bcl_num_insert(BclContext ctxt, BclNum* restrict n)
 {
 	BclNumber idx;
+	BclNum* ptr;
 
-	// If there is a free spot...
-	if (ctxt->free_nums.len)
-	{
-		BclNum* ptr;
-
-		// Get the index of the free spot and remove it.
-		idx = *((BclNumber*) bc_vec_top(&ctxt->free_nums));
-		bc_vec_pop(&ctxt->free_nums);
-
-		// Copy the number into the spot.
-		ptr = bc_vec_item(&ctxt->nums, idx.i);
-
-		memcpy(BCL_NUM_NUM(ptr), n, sizeof(BcNum));
-
-#if BC_ENABLE_MEMCHECK
-
-		ptr->gen_idx += 1;
-
-		if (ptr->gen_idx == UCHAR_MAX)
-		{
-			ptr->gen_idx = 0;
-		}
+	// The caller must have reserved the space.
+	assert(BCL_NUMS_AVAIL(ctxt) != 0);
 
-		idx.i |= (ptr->gen_idx << ((sizeof(size_t) - 1) * CHAR_BIT));
+	// If there is a free spot, take it off the free list. Otherwise, take the
+	// next spot that has never been used.
+	if (ctxt->nfree)
+	{
+		idx.i = ctxt->free_nums;
+		ptr = BCL_SLOT(ctxt, idx.i);
 
-#endif // BC_ENABLE_MEMCHECK
+		ctxt->free_nums = BCL_NUM_NEXT(ptr);
+		ctxt->nfree -= 1;
 	}
 	else
 	{
-#if BC_ENABLE_MEMCHECK
-		n->gen_idx = 0;
-#endif // BC_ENABLE_MEMCHECK
+		idx.i = ctxt->nnums;
+		ptr = BCL_SLOT(ctxt, idx.i);
 
-		// Just push the number onto the vector because the generation index is
-		// 0.
-		idx.i = ctxt->nums.len;
-		bc_vec_push(&ctxt->nums, n);
+		ctxt->nnums += 1;
 	}
 
+	// Copy the number into the spot.
+	// NOLINTNEXTLINE
+	memcpy(BCL_NUM_NUM(ptr), BCL_NUM_NUM(n), sizeof(BcNum));
+
+	idx.i |= ptr->gen_idx << BCL_GEN_SHIFT;
+
 	return idx;
 }
 
@@ -579,26 +927,43 @@ bcl_num_dtor(BclContext ctxt, BclNumber n, BclNum* restrict num)
 
 	BCL_CLEAR_GEN(n);
 
-	bcl_num_destruct(num);
-	bc_vec_push(&ctxt->free_nums, &n);
+	bcl_num_release(ctxt, num);
 
-#if BC_ENABLE_MEMCHECK
-	num->n.num = NULL;
-#endif // BC_ENABLE_MEMCHECK
+	// Push the spot onto the free list.
+	BCL_NUM_NEXT(num) = ctxt->free_nums;
+	ctxt->free_nums = n.i;
+	ctxt->nfree += 1;
 }
 
 void
 bcl_num_free(BclNumber n)
 {
-	BclNum* num;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
 	BC_CHECK_CTXT_ASSERT(vm, ctxt);
 
+	bcl_num_free_ctx(ctxt, n);
+}
+
+void
+bcl_num_free_ctx(BclContext ctxt, BclNumber n)
+{
+	BclNum* num;
+	BcVm* vm = bcl_getspecific();
+
+	assert(ctxt != NULL);
+
+	BCL_USE_CTXT(vm, ctxt);
+
 	BCL_CHECK_NUM_VALID(ctxt, n);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	// Freeing a number twice is harmless because the generation index will
+	// not match.
+	if (BC_ERR(BCL_NO_GEN(n) >= ctxt->nnums || BCL_NUM_STALE(ctxt, n)))
+	{
+		return;
+	}
 
 	num = BCL_NUM(ctxt, n);
 
@@ -616,13 +981,13 @@ bcl_copy(BclNumber d, BclNumber s)
 
 	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	BCL_CHECK_NUM_VALID(ctxt, d);
-	BCL_CHECK_NUM_VALID(ctxt, s);
+	BC_CHECK_NUM_ERR(ctxt, d);
+	BC_CHECK_NUM_ERR(ctxt, s);
 
 	BC_FUNC_HEADER(vm, err);
 
-	assert(BCL_NO_GEN(d) < ctxt->nums.len);
-	assert(BCL_NO_GEN(s) < ctxt->nums.len);
+	assert(BCL_NO_GEN(d) < ctxt->nnums);
+	assert(BCL_NO_GEN(s) < ctxt->nnums);
 
 	dest = BCL_NUM(ctxt, d);
 	src = BCL_NUM(ctxt, s);
@@ -650,13 +1015,13 @@ bcl_dup(BclNumber s)
 
 	BC_CHECK_CTXT(vm, ctxt);
 
-	BCL_CHECK_NUM_VALID(ctxt, s);
+	BC_CHECK_NUM(ctxt, s);
 
 	BC_FUNC_HEADER(vm, err);
 
 	BCL_GROW_NUMS(ctxt);
 
-	assert(BCL_NO_GEN(s) < ctxt->nums.len);
+	assert(BCL_NO_GEN(s) < ctxt->nnums);
 
 	src = BCL_NUM(ctxt, s);
 
@@ -698,7 +1063,7 @@ bcl_num_neg(BclNumber n)
 
 	BCL_CHECK_NUM_VALID(ctxt, n);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 
 	num = BCL_NUM(ctxt, n);
 
@@ -718,7 +1083,7 @@ bcl_num_setNeg(BclNumber n, bool neg)
 
 	BCL_CHECK_NUM_VALID(ctxt, n);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 
 	num = BCL_NUM(ctxt, n);
 
@@ -738,7 +1103,7 @@ bcl_num_scale(BclNumber n)
 
 	BCL_CHECK_NUM_VALID(ctxt, n);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 
 	num = BCL_NUM(ctxt, n);
 
@@ -763,7 +1128,7 @@ bcl_num_setScale(BclNumber n, size_t scale)
 
 	BC_FUNC_HEADER(vm, err);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 
 	nptr = BCL_NUM(ctxt, n);
 
@@ -796,7 +1161,7 @@ bcl_num_len(BclNumber n)
 
 	BCL_CHECK_NUM_VALID(ctxt, n);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 
 	num = BCL_NUM(ctxt, n);
 
@@ -815,11 +1180,11 @@ bcl_bigdig_helper(BclNumber n, BclBigDig* result, bool destruct)
 
 	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	BCL_CHECK_NUM_VALID(ctxt, n);
+	BC_CHECK_NUM_ERR(ctxt, n);
 
 	BC_FUNC_HEADER(vm, err);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 	assert(result != NULL);
 
 	num = BCL_NUM(ctxt, n);
@@ -877,43 +1242,156 @@ err:
 	return idx;
 }
 
-/**
- * Sets up and executes a binary operator operation.
- * @param a         The first operand.
- * @param b         The second operand.
- * @param op        The operation.
- * @param req       The function to get the size of the result for
- *                  preallocation.
- * @param destruct  True if the parameters should be consumed, false otherwise.
- * @return          The result of the operation.
- */
-static BclNumber
-bcl_binary(BclNumber a, BclNumber b, const BcNumBinaryOp op,
-           const BcNumBinaryOpReq req, bool destruct)
+static BclError
+bcl_bytes_helper(BclNumber n, unsigned char* buf, size_t cap, size_t* needed,
+                 bool big_endian, bool destruct)
 {
 	BclError e = BCL_ERROR_NONE;
-	BclNum* aptr;
-	BclNum* bptr;
-	BclNum c;
-	BclNumber idx;
+	size_t len;
+	BclNum* num;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT(vm, ctxt);
+	BC_CHECK_CTXT_ERR(vm, ctxt);
 
-	BC_CHECK_NUM(ctxt, a);
-	BC_CHECK_NUM(ctxt, b);
+	BC_CHECK_NUM_ERR(ctxt, n);
 
 	BC_FUNC_HEADER(vm, err);
 
-	BCL_GROW_NUMS(ctxt);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
+	assert(buf != NULL || !cap);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+	num = BCL_NUM(ctxt, n);
 
-	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
+	assert(num != NULL && BCL_NUM_ARRAY(num) != NULL);
 
-	assert(aptr != NULL && bptr != NULL);
+	len = bc_num_exportBytes(BCL_NUM_NUM(num), buf, cap, big_endian);
+
+	if (needed != NULL) *needed = len;
+
+	// Nothing was written if it did not fit.
+	if (BC_ERR(len > cap)) vm->err = BCL_ERROR_MATH_OVERFLOW;
+
+err:
+
+	if (destruct)
+	{
+		bcl_num_dtor(ctxt, n, num);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+BclError
+bcl_bytes(BclNumber n, unsigned char* buf, size_t cap, size_t* needed,
+          bool big_endian)
+{
+	return bcl_bytes_helper(n, buf, cap, needed, big_endian, true);
+}
+
+BclError
+bcl_bytes_keep(BclNumber n, unsigned char* buf, size_t cap, size_t* needed,
+               bool big_endian)
+{
+	return bcl_bytes_helper(n, buf, cap, needed, big_endian, false);
+}
+
+/**
+ * Creates a number from binary data, either bytes or 64-bit words.
+ * @param bytes       The bytes, or NULL if @a words should be used.
+ * @param words       The words, if @a bytes is NULL.
+ * @param len         The number of bytes or words.
+ * @param big_endian  True if the most significant byte is first. This is only
+ *                    used for bytes.
+ * @return            The number.
+ */
+static BclNumber
+bcl_bin2num(const unsigned char* bytes, const uint64_t* words, size_t len,
+            bool big_endian)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum n;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	bc_num_clear(BCL_NUM_NUM_NP(n));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(bytes != NULL || words != NULL || !len);
+
+	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
+
+	if (bytes != NULL)
+	{
+		bc_num_importBytes(BCL_NUM_NUM_NP(n), bytes, len, big_endian);
+	}
+	else if (words != NULL) bc_num_importWords(BCL_NUM_NUM_NP(n), words, len);
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, n, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_bytes2num(const unsigned char* bytes, size_t len, bool big_endian)
+{
+	return bcl_bin2num(bytes, NULL, len, big_endian);
+}
+
+BclNumber
+bcl_words2num(const uint64_t* words, size_t len)
+{
+	return bcl_bin2num(NULL, words, len, false);
+}
+
+/**
+ * Sets up and executes a binary operator operation.
+ * @param ctxt      The context that the operands belong to.
+ * @param a         The first operand.
+ * @param b         The second operand.
+ * @param op        The operation.
+ * @param req       The function to get the size of the result for
+ *                  preallocation.
+ * @param destruct  True if the parameters should be consumed, false otherwise.
+ * @return          The result of the operation.
+ */
+static BclNumber
+bcl_binary(BclContext ctxt, BclNumber a, BclNumber b, const BcNumBinaryOp op,
+           const BcNumBinaryOpReq req, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum c;
+	BclNumber idx;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_PARAM(vm, ctxt);
+
+	BC_CHECK_NUM(ctxt, a);
+	BC_CHECK_NUM(ctxt, b);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(BCL_NO_GEN(a) < ctxt->nnums && BCL_NO_GEN(b) < ctxt->nnums);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+
+	assert(aptr != NULL && bptr != NULL);
 	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
 
 	// Clear and initialize the result.
@@ -941,157 +1419,120 @@ err:
 BclNumber
 bcl_add(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_add, bc_num_addReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_add, bc_num_addReq, true);
 }
 
 BclNumber
 bcl_add_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_add, bc_num_addReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_add, bc_num_addReq, false);
 }
 
 BclNumber
 bcl_sub(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_sub, bc_num_addReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_sub, bc_num_addReq, true);
 }
 
 BclNumber
 bcl_sub_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_sub, bc_num_addReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_sub, bc_num_addReq, false);
 }
 
 BclNumber
 bcl_mul(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_mul, bc_num_mulReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_mul, bc_num_mulReq, true);
 }
 
 BclNumber
 bcl_mul_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_mul, bc_num_mulReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_mul, bc_num_mulReq, false);
 }
 
 BclNumber
 bcl_div(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_div, bc_num_divReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_div, bc_num_divReq, true);
 }
 
 BclNumber
 bcl_div_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_div, bc_num_divReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_div, bc_num_divReq, false);
 }
 
 BclNumber
 bcl_mod(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_mod, bc_num_divReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_mod, bc_num_divReq, true);
 }
 
 BclNumber
 bcl_mod_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_mod, bc_num_divReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_mod, bc_num_divReq, false);
 }
 
 BclNumber
 bcl_pow(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_pow, bc_num_powReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_pow, bc_num_powReq, true);
 }
 
 BclNumber
 bcl_pow_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_pow, bc_num_powReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_pow, bc_num_powReq, false);
 }
 
 BclNumber
 bcl_lshift(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_lshift, bc_num_placesReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_lshift, bc_num_placesReq,
+	                  true);
 }
 
 BclNumber
 bcl_lshift_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_lshift, bc_num_placesReq, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_lshift, bc_num_placesReq,
+	                  false);
 }
 
 BclNumber
 bcl_rshift(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_rshift, bc_num_placesReq, true);
+	return bcl_binary(bcl_context(), a, b, bc_num_rshift, bc_num_placesReq,
+	                  true);
 }
 
 BclNumber
 bcl_rshift_keep(BclNumber a, BclNumber b)
 {
-	return bcl_binary(a, b, bc_num_rshift, bc_num_placesReq, false);
-}
-
-static BclNumber
-bcl_sqrt_helper(BclNumber a, bool destruct)
-{
-	BclError e = BCL_ERROR_NONE;
-	BclNum* aptr;
-	BclNum b;
-	BclNumber idx;
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
-
-	BC_CHECK_CTXT(vm, ctxt);
-
-	BC_CHECK_NUM(ctxt, a);
-
-	BC_FUNC_HEADER(vm, err);
-
-	BCL_GROW_NUMS(ctxt);
-
-	assert(BCL_NO_GEN(a) < ctxt->nums.len);
-
-	aptr = BCL_NUM(ctxt, a);
-
-	bc_num_sqrt(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), ctxt->scale);
-
-err:
-
-	if (destruct)
-	{
-		bcl_num_dtor(ctxt, a, aptr);
-	}
-
-	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, b, idx);
-
-	return idx;
-}
-
-BclNumber
-bcl_sqrt(BclNumber a)
-{
-	return bcl_sqrt_helper(a, true);
-}
-
-BclNumber
-bcl_sqrt_keep(BclNumber a)
-{
-	return bcl_sqrt_helper(a, false);
+	return bcl_binary(bcl_context(), a, b, bc_num_rshift, bc_num_placesReq,
+	                  false);
 }
 
+/**
+ * Executes a binary operator operation and puts the result in a number that is
+ * already in the context, reusing its storage.
+ * @param a   The first operand.
+ * @param b   The second operand.
+ * @param c   The result. It may be the same as @a a or @a b.
+ * @param op  The operation.
+ * @return    An error code, if any.
+ */
 static BclError
-bcl_divmod_helper(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d,
-                  bool destruct)
+bcl_binary_into(BclNumber a, BclNumber b, BclNumber c, const BcNumBinaryOp op)
 {
 	BclError e = BCL_ERROR_NONE;
-	size_t req;
 	BclNum* aptr;
 	BclNum* bptr;
-	BclNum cnum, dnum;
+	BclNum* cptr;
+	BcNum temp;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
@@ -1099,322 +1540,1879 @@ bcl_divmod_helper(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d,
 
 	BC_CHECK_NUM_ERR(ctxt, a);
 	BC_CHECK_NUM_ERR(ctxt, b);
+	BC_CHECK_NUM_ERR(ctxt, c);
 
 	BC_FUNC_HEADER(vm, err);
 
-	BCL_GROW_NUMS(ctxt);
-
-	assert(c != NULL && d != NULL);
+	assert(BCL_NO_GEN(a) < ctxt->nnums && BCL_NO_GEN(b) < ctxt->nnums);
+	assert(BCL_NO_GEN(c) < ctxt->nnums);
 
 	aptr = BCL_NUM(ctxt, a);
 	bptr = BCL_NUM(ctxt, b);
+	cptr = BCL_NUM(ctxt, c);
 
-	assert(aptr != NULL && bptr != NULL);
-	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
-
-	bc_num_clear(BCL_NUM_NUM_NP(cnum));
-	bc_num_clear(BCL_NUM_NUM_NP(dnum));
+	assert(aptr != NULL && bptr != NULL && cptr != NULL);
+	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL &&
+	       BCL_NUM_ARRAY(cptr) != NULL);
 
-	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale);
+	if (c.i != a.i && c.i != b.i)
+	{
+		// The ops only expand the result, so its storage is reused.
+		op(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM(cptr),
+		   ctxt->scale);
+	}
+	else
+	{
+		// The ops would allocate a new result and free the old one if the
+		// result is also an operand. Instead, calculate into the spare and
+		// swap, which keeps both allocations for the next call. This also
+		// leaves the result untouched on error.
+		if (ctxt->spare.num == NULL)
+		{
+			bc_num_init(&ctxt->spare, BC_NUM_DEF_SIZE);
+		}
 
-	// Initialize the numbers.
-	bc_num_init(BCL_NUM_NUM_NP(cnum), req);
-	BC_UNSETJMP(vm);
-	BC_SETJMP(vm, err);
-	bc_num_init(BCL_NUM_NUM_NP(dnum), req);
+		op(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), &ctxt->spare, ctxt->scale);
 
-	bc_num_divmod(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(cnum),
-	              BCL_NUM_NUM_NP(dnum), ctxt->scale);
+		// NOLINTNEXTLINE
+		memcpy(&temp, BCL_NUM_NUM(cptr), sizeof(BcNum));
+		// NOLINTNEXTLINE
+		memcpy(BCL_NUM_NUM(cptr), &ctxt->spare, sizeof(BcNum));
+		// NOLINTNEXTLINE
+		memcpy(&ctxt->spare, &temp, sizeof(BcNum));
+	}
 
 err:
 
-	if (destruct)
-	{
-		// Eat the operands.
-		bcl_num_dtor(ctxt, a, aptr);
-		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
-	}
+	BC_FUNC_FOOTER(vm, e);
 
-	// If there was an error...
-	if (BC_ERR(vm->err))
-	{
-		// Free the results.
-		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&cnum);
-		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&dnum);
+	return e;
+}
 
-		// Make sure the return values are invalid.
-		c->i = 0 - (size_t) BCL_ERROR_INVALID_NUM;
-		d->i = c->i;
+BclError
+bcl_add_into(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_binary_into(a, b, c, bc_num_add);
+}
 
-		BC_FUNC_FOOTER(vm, e);
-	}
-	else
-	{
-		BC_FUNC_FOOTER(vm, e);
+BclError
+bcl_sub_into(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_binary_into(a, b, c, bc_num_sub);
+}
 
-		// Insert the results into the context.
-		*c = bcl_num_insert(ctxt, &cnum);
-		*d = bcl_num_insert(ctxt, &dnum);
-	}
+BclError
+bcl_mul_into(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_binary_into(a, b, c, bc_num_mul);
+}
 
-	return e;
+BclError
+bcl_div_into(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_binary_into(a, b, c, bc_num_div);
 }
 
 BclError
-bcl_divmod(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+bcl_mod_into(BclNumber a, BclNumber b, BclNumber c)
 {
-	return bcl_divmod_helper(a, b, c, d, true);
+	return bcl_binary_into(a, b, c, bc_num_mod);
 }
 
 BclError
-bcl_divmod_keep(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+bcl_pow_into(BclNumber a, BclNumber b, BclNumber c)
 {
-	return bcl_divmod_helper(a, b, c, d, false);
+	return bcl_binary_into(a, b, c, bc_num_pow);
 }
 
 static BclNumber
-bcl_modexp_helper(BclNumber a, BclNumber b, BclNumber c, bool destruct)
+bcl_sqrt_helper(BclContext ctxt, BclNumber a, bool destruct)
 {
 	BclError e = BCL_ERROR_NONE;
-	size_t req;
 	BclNum* aptr;
-	BclNum* bptr;
-	BclNum* cptr;
-	BclNum d;
+	BclNum b;
 	BclNumber idx;
-	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT(vm, ctxt);
+	BC_CHECK_CTXT_PARAM(vm, ctxt);
 
 	BC_CHECK_NUM(ctxt, a);
-	BC_CHECK_NUM(ctxt, b);
-	BC_CHECK_NUM(ctxt, c);
+
+	// Clear the result first because bc_num_sqrt() does not initialize it if
+	// the number is negative.
+	bc_num_clear(BCL_NUM_NUM_NP(b));
 
 	BC_FUNC_HEADER(vm, err);
 
 	BCL_GROW_NUMS(ctxt);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
-	assert(BCL_NO_GEN(c) < ctxt->nums.len);
+	assert(BCL_NO_GEN(a) < ctxt->nnums);
 
 	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
-	cptr = BCL_NUM(ctxt, c);
-
-	assert(aptr != NULL && bptr != NULL && cptr != NULL);
-	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr) != NULL &&
-	       BCL_NUM_NUM(cptr) != NULL);
-
-	// Prepare the result.
-	bc_num_clear(BCL_NUM_NUM_NP(d));
-
-	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(cptr), 0);
 
-	// Initialize the result.
-	bc_num_init(BCL_NUM_NUM_NP(d), req);
-
-	bc_num_modexp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM(cptr),
-	              BCL_NUM_NUM_NP(d));
+	bc_num_sqrt(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), ctxt->scale);
 
 err:
 
 	if (destruct)
 	{
-		// Eat the operands.
 		bcl_num_dtor(ctxt, a, aptr);
-		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
-		if (c.i != a.i && c.i != b.i) bcl_num_dtor(ctxt, c, cptr);
 	}
 
 	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, d, idx);
+	BC_MAYBE_SETUP(ctxt, e, b, idx);
 
 	return idx;
 }
 
 BclNumber
-bcl_modexp(BclNumber a, BclNumber b, BclNumber c)
+bcl_sqrt(BclNumber a)
 {
-	return bcl_modexp_helper(a, b, c, true);
+	return bcl_sqrt_helper(bcl_context(), a, true);
 }
 
 BclNumber
-bcl_modexp_keep(BclNumber a, BclNumber b, BclNumber c)
+bcl_sqrt_keep(BclNumber a)
 {
-	return bcl_modexp_helper(a, b, c, false);
+	return bcl_sqrt_helper(bcl_context(), a, false);
 }
 
-ssize_t
-bcl_cmp(BclNumber a, BclNumber b)
+BclNumber
+bcl_add_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_add, bc_num_addReq, true);
+}
+
+BclNumber
+bcl_add_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_add, bc_num_addReq, false);
+}
+
+BclNumber
+bcl_sub_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_sub, bc_num_addReq, true);
+}
+
+BclNumber
+bcl_sub_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_sub, bc_num_addReq, false);
+}
+
+BclNumber
+bcl_mul_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_mul, bc_num_mulReq, true);
+}
+
+BclNumber
+bcl_mul_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_mul, bc_num_mulReq, false);
+}
+
+BclNumber
+bcl_div_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_div, bc_num_divReq, true);
+}
+
+BclNumber
+bcl_div_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b)
 {
+	return bcl_binary(ctxt, a, b, bc_num_div, bc_num_divReq, false);
+}
+
+BclNumber
+bcl_mod_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_mod, bc_num_divReq, true);
+}
+
+BclNumber
+bcl_mod_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_mod, bc_num_divReq, false);
+}
+
+BclNumber
+bcl_pow_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_pow, bc_num_powReq, true);
+}
+
+BclNumber
+bcl_pow_keep_ctx(BclContext ctxt, BclNumber a, BclNumber b)
+{
+	return bcl_binary(ctxt, a, b, bc_num_pow, bc_num_powReq, false);
+}
+
+BclNumber
+bcl_sqrt_ctx(BclContext ctxt, BclNumber a)
+{
+	return bcl_sqrt_helper(ctxt, a, true);
+}
+
+BclNumber
+bcl_sqrt_keep_ctx(BclContext ctxt, BclNumber a)
+{
+	return bcl_sqrt_helper(ctxt, a, false);
+}
+
+/**
+ * Runs a unary math function on a number and returns the result.
+ * @param a         The number.
+ * @param op        The function.
+ * @param destruct  True if the number should be consumed, false otherwise.
+ * @return          The result.
+ */
+static BclNumber
+bcl_unary(BclNumber a, const BcNumUnaryOp op, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
 	BclNum* aptr;
-	BclNum* bptr;
+	BclNum b;
+	BclNumber idx;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+	BC_CHECK_CTXT(vm, ctxt);
 
-	BCL_CHECK_NUM_VALID(ctxt, a);
-	BCL_CHECK_NUM_VALID(ctxt, b);
+	BC_CHECK_NUM(ctxt, a);
+
+	bc_num_clear(BCL_NUM_NUM_NP(b));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len && BCL_NO_GEN(b) < ctxt->nums.len);
+	assert(BCL_NO_GEN(a) < ctxt->nnums);
 
 	aptr = BCL_NUM(ctxt, a);
-	bptr = BCL_NUM(ctxt, b);
 
-	assert(aptr != NULL && bptr != NULL);
-	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr));
+	assert(aptr != NULL && BCL_NUM_ARRAY(aptr) != NULL);
 
-	return bc_num_cmp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr));
+	bc_num_init(BCL_NUM_NUM_NP(b), BC_NUM_DEF_SIZE);
+
+	op(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), ctxt->scale);
+
+err:
+
+	if (destruct)
+	{
+		bcl_num_dtor(ctxt, a, aptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, b, idx);
+
+	return idx;
 }
 
-void
-bcl_zero(BclNumber n)
+BclNumber
+bcl_exp(BclNumber a)
 {
-	BclNum* nptr;
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
+	return bcl_unary(a, bc_num_exp, true);
+}
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+BclNumber
+bcl_exp_keep(BclNumber a)
+{
+	return bcl_unary(a, bc_num_exp, false);
+}
 
-	BCL_CHECK_NUM_VALID(ctxt, n);
+BclNumber
+bcl_ln(BclNumber a)
+{
+	return bcl_unary(a, bc_num_ln, true);
+}
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+BclNumber
+bcl_ln_keep(BclNumber a)
+{
+	return bcl_unary(a, bc_num_ln, false);
+}
 
-	nptr = BCL_NUM(ctxt, n);
+BclNumber
+bcl_sin(BclNumber a)
+{
+	return bcl_unary(a, bc_num_sin, true);
+}
 
-	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+BclNumber
+bcl_sin_keep(BclNumber a)
+{
+	return bcl_unary(a, bc_num_sin, false);
+}
 
-	bc_num_zero(BCL_NUM_NUM(nptr));
+BclNumber
+bcl_cos(BclNumber a)
+{
+	return bcl_unary(a, bc_num_cos, true);
 }
 
-void
-bcl_one(BclNumber n)
+BclNumber
+bcl_cos_keep(BclNumber a)
 {
-	BclNum* nptr;
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
+	return bcl_unary(a, bc_num_cos, false);
+}
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+BclNumber
+bcl_atan(BclNumber a)
+{
+	return bcl_unary(a, bc_num_atan, true);
+}
 
-	BCL_CHECK_NUM_VALID(ctxt, n);
+BclNumber
+bcl_atan_keep(BclNumber a)
+{
+	return bcl_unary(a, bc_num_atan, false);
+}
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+BclNumber
+bcl_fact(BclNumber a)
+{
+	return bcl_unary(a, bc_num_fact, true);
+}
 
-	nptr = BCL_NUM(ctxt, n);
+BclNumber
+bcl_fact_keep(BclNumber a)
+{
+	return bcl_unary(a, bc_num_fact, false);
+}
 
-	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+BclNumber
+bcl_fib(BclNumber a)
+{
+	return bcl_unary(a, bc_num_fib, true);
+}
 
-	bc_num_one(BCL_NUM_NUM(nptr));
+BclNumber
+bcl_fib_keep(BclNumber a)
+{
+	return bcl_unary(a, bc_num_fib, false);
+}
+
+/**
+ * Returns the preallocation for the results of the math library functions.
+ * They grow their results as needed, so this is just the default. This is a
+ * BcNumBinaryOpReq function.
+ * @param a      The first operand.
+ * @param b      The second operand.
+ * @param scale  The current scale.
+ * @return       The default size of a number.
+ */
+static size_t
+bcl_mathReq(const BcNum* a, const BcNum* b, size_t scale)
+{
+	BC_UNUSED(a);
+	BC_UNUSED(b);
+	BC_UNUSED(scale);
+
+	return BC_NUM_DEF_SIZE;
 }
 
 BclNumber
-bcl_parse(const char* restrict val)
+bcl_log(BclNumber a, BclNumber b)
 {
-	BclError e = BCL_ERROR_NONE;
-	BclNum n;
-	BclNumber idx;
-	BclContext ctxt;
-	BcVm* vm = bcl_getspecific();
-	bool neg;
+	return bcl_binary(bcl_context(), a, b, bc_num_log, bcl_mathReq, true);
+}
 
-	BC_CHECK_CTXT(vm, ctxt);
+BclNumber
+bcl_log_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_log, bcl_mathReq, false);
+}
 
-	BC_FUNC_HEADER(vm, err);
+BclNumber
+bcl_root(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_root, bcl_mathReq, true);
+}
 
-	BCL_GROW_NUMS(ctxt);
+BclNumber
+bcl_root_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_root, bcl_mathReq, false);
+}
 
-	assert(val != NULL);
+BclNumber
+bcl_gcd(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_gcd, bcl_mathReq, true);
+}
 
-	// We have to take care of negative here because bc's number parsing does
-	// not.
-	neg = (val[0] == '-');
+BclNumber
+bcl_gcd_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_gcd, bcl_mathReq, false);
+}
 
-	if (neg) val += 1;
+BclNumber
+bcl_lcm(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_lcm, bcl_mathReq, true);
+}
 
-	if (!bc_num_strValid(val))
-	{
-		vm->err = BCL_ERROR_PARSE_INVALID_STR;
-		goto err;
-	}
+BclNumber
+bcl_lcm_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_lcm, bcl_mathReq, false);
+}
 
-	// Clear and initialize the number.
-	bc_num_clear(BCL_NUM_NUM_NP(n));
-	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
+BclNumber
+bcl_modinv(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_modinv, bcl_mathReq, true);
+}
 
-	bc_num_parse(BCL_NUM_NUM_NP(n), val, (BcBigDig) ctxt->ibase);
+BclNumber
+bcl_modinv_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_modinv, bcl_mathReq, false);
+}
 
-	// Set the negative.
-#if BC_ENABLE_MEMCHECK
-	n.n.rdx = BC_NUM_NEG_VAL(BCL_NUM_NUM_NP(n), neg);
-#else // BC_ENABLE_MEMCHECK
-	n.rdx = BC_NUM_NEG_VAL_NP(n, neg);
-#endif // BC_ENABLE_MEMCHECK
+BclNumber
+bcl_perm(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_perm, bcl_mathReq, true);
+}
 
-err:
+BclNumber
+bcl_perm_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_perm, bcl_mathReq, false);
+}
 
-	BC_FUNC_FOOTER(vm, e);
-	BC_MAYBE_SETUP(ctxt, e, n, idx);
+BclNumber
+bcl_comb(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_comb, bcl_mathReq, true);
+}
 
-	return idx;
+BclNumber
+bcl_comb_keep(BclNumber a, BclNumber b)
+{
+	return bcl_binary(bcl_context(), a, b, bc_num_comb, bcl_mathReq, false);
 }
 
-static char*
-bcl_string_helper(BclNumber n, bool destruct)
+/**
+ * Rounds a number to a number of places.
+ * @param a         The number.
+ * @param places    The number of places.
+ * @param up        True to round away from zero, false to round to nearest.
+ * @param destruct  True if the number should be consumed, false otherwise.
+ * @return          The rounded number.
+ */
+static BclNumber
+bcl_round_helper(BclNumber a, size_t places, bool up, bool destruct)
 {
-	BclNum* nptr;
-	char* str = NULL;
+	BclError e = BCL_ERROR_NONE;
+	BclNum* aptr;
+	BclNum b;
+	BclNumber idx;
 	BclContext ctxt;
 	BcVm* vm = bcl_getspecific();
 
-	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+	BC_CHECK_CTXT(vm, ctxt);
 
-	BCL_CHECK_NUM_VALID(ctxt, n);
+	BC_CHECK_NUM(ctxt, a);
 
-	if (BC_ERR(BCL_NO_GEN(n) >= ctxt->nums.len)) return str;
+	bc_num_clear(BCL_NUM_NUM_NP(b));
 
 	BC_FUNC_HEADER(vm, err);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	BCL_GROW_NUMS(ctxt);
 
-	nptr = BCL_NUM(ctxt, n);
+	assert(BCL_NO_GEN(a) < ctxt->nnums);
 
-	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+	aptr = BCL_NUM(ctxt, a);
 
-	// Clear the buffer.
-	bc_vec_popAll(&vm->out);
+	assert(aptr != NULL && BCL_NUM_ARRAY(aptr) != NULL);
 
-	// Print to the buffer.
-	bc_num_print(BCL_NUM_NUM(nptr), (BcBigDig) ctxt->obase, false);
-	bc_vec_pushByte(&vm->out, '\0');
+	bc_num_init(BCL_NUM_NUM_NP(b), BC_NUM_DEF_SIZE);
 
-	// Just dup the string; the caller is responsible for it.
-	str = bc_vm_strdup(vm->out.v);
+	if (up) bc_num_ceil(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), places);
+	else bc_num_round(BCL_NUM_NUM(aptr), BCL_NUM_NUM_NP(b), places);
 
 err:
 
 	if (destruct)
 	{
-		// Eat the operand.
-		bcl_num_dtor(ctxt, n, nptr);
+		bcl_num_dtor(ctxt, a, aptr);
 	}
 
-	BC_FUNC_FOOTER_NO_ERR(vm);
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, b, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_round(BclNumber a, size_t places)
+{
+	return bcl_round_helper(a, places, false, true);
+}
+
+BclNumber
+bcl_round_keep(BclNumber a, size_t places)
+{
+	return bcl_round_helper(a, places, false, false);
+}
+
+BclNumber
+bcl_ceil(BclNumber a, size_t places)
+{
+	return bcl_round_helper(a, places, true, true);
+}
+
+BclNumber
+bcl_ceil_keep(BclNumber a, size_t places)
+{
+	return bcl_round_helper(a, places, true, false);
+}
+
+static BclError
+bcl_divmod_helper(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d,
+                  bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t req;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum cnum, dnum;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	BC_CHECK_NUM_ERR(ctxt, a);
+	BC_CHECK_NUM_ERR(ctxt, b);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(c != NULL && d != NULL);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+
+	assert(aptr != NULL && bptr != NULL);
+	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+
+	bc_num_clear(BCL_NUM_NUM_NP(cnum));
+	bc_num_clear(BCL_NUM_NUM_NP(dnum));
+
+	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale);
+
+	// Initialize the numbers.
+	bc_num_init(BCL_NUM_NUM_NP(cnum), req);
+	BC_UNSETJMP(vm);
+	BC_SETJMP(vm, err);
+	bc_num_init(BCL_NUM_NUM_NP(dnum), req);
+
+	bc_num_divmod(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(cnum),
+	              BCL_NUM_NUM_NP(dnum), ctxt->scale);
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_num_dtor(ctxt, a, aptr);
+		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+	}
+
+	// If there was an error...
+	if (BC_ERR(vm->err))
+	{
+		// Free the results.
+		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&cnum);
+		if (BCL_NUM_ARRAY_NP(cnum) != NULL) bc_num_free(&dnum);
+
+		// Make sure the return values are invalid.
+		c->i = 0 - (size_t) BCL_ERROR_INVALID_NUM;
+		d->i = c->i;
+
+		BC_FUNC_FOOTER(vm, e);
+	}
+	else
+	{
+		BC_FUNC_FOOTER(vm, e);
+
+		// Insert the results into the context.
+		*c = bcl_num_insert(ctxt, &cnum);
+		*d = bcl_num_insert(ctxt, &dnum);
+	}
+
+	return e;
+}
+
+BclError
+bcl_divmod(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+{
+	return bcl_divmod_helper(a, b, c, d, true);
+}
+
+BclError
+bcl_divmod_keep(BclNumber a, BclNumber b, BclNumber* c, BclNumber* d)
+{
+	return bcl_divmod_helper(a, b, c, d, false);
+}
+
+static BclNumber
+bcl_modexp_helper(BclNumber a, BclNumber b, BclNumber c, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t req;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum* cptr;
+	BclNum d;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	BC_CHECK_NUM(ctxt, a);
+	BC_CHECK_NUM(ctxt, b);
+	BC_CHECK_NUM(ctxt, c);
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(BCL_NO_GEN(a) < ctxt->nnums && BCL_NO_GEN(b) < ctxt->nnums);
+	assert(BCL_NO_GEN(c) < ctxt->nnums);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+	cptr = BCL_NUM(ctxt, c);
+
+	assert(aptr != NULL && bptr != NULL && cptr != NULL);
+	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr) != NULL &&
+	       BCL_NUM_NUM(cptr) != NULL);
+
+	// Prepare the result.
+	bc_num_clear(BCL_NUM_NUM_NP(d));
+
+	req = bc_num_divReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(cptr), 0);
+
+	// Initialize the result.
+	bc_num_init(BCL_NUM_NUM_NP(d), req);
+
+	bc_num_modexp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM(cptr),
+	              BCL_NUM_NUM_NP(d));
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_num_dtor(ctxt, a, aptr);
+		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+		if (c.i != a.i && c.i != b.i) bcl_num_dtor(ctxt, c, cptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, d, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_modexp(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_modexp_helper(a, b, c, true);
+}
+
+BclNumber
+bcl_modexp_keep(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_modexp_helper(a, b, c, false);
+}
+
+/// The binary operator functions, in the order of BclOp.
+static const BcNumBinaryOp bcl_ops[] = {
+	bc_num_add,    bc_num_sub, bc_num_mul,    bc_num_div,
+	bc_num_mod,    bc_num_pow, bc_num_lshift, bc_num_rshift,
+};
+
+/// The functions to get the size of the result of the binary operators, in the
+/// order of BclOp.
+static const BcNumBinaryOpReq bcl_opReqs[] = {
+	bc_num_addReq, bc_num_addReq, bc_num_mulReq,    bc_num_divReq,
+	bc_num_divReq, bc_num_powReq, bc_num_placesReq, bc_num_placesReq,
+};
+
+/**
+ * Destroys an array of operands. A number that appears more than once is only
+ * destroyed once.
+ * @param ctxt  The context.
+ * @param nums  The array of operands.
+ * @param n     The length of @a nums.
+ */
+static void
+bcl_nums_dtor(BclContext ctxt, const BclNumber* nums, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; ++i)
+	{
+		BclNum* ptr = BCL_NUM(ctxt, nums[i]);
+
+		if (BCL_NUM_ARRAY(ptr) != NULL) bcl_num_dtor(ctxt, nums[i], ptr);
+	}
+}
+
+/**
+ * Applies a binary operator to arrays of operands. Everything that the single
+ * operations do per call (getting the thread data, checking the context,
+ * setting a jump, and growing the numbers) is done once for the whole batch.
+ * @param op        The operator.
+ * @param a         The array of first operands.
+ * @param b         The array of second operands.
+ * @param c         The array to put the results in.
+ * @param n         The length of the arrays.
+ * @param destruct  True if the operands should be consumed, false otherwise.
+ * @return          An error code, if any.
+ */
+static BclError
+bcl_batch_helper(BclOp op, const BclNumber* a, const BclNumber* b,
+                 BclNumber* c, size_t n, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t i;
+	BclNum res;
+	BcNumBinaryOp fn;
+	BcNumBinaryOpReq req;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	assert(op < BCL_OP_NELEMS);
+	assert(n == 0 || (a != NULL && b != NULL && c != NULL));
+
+	for (i = 0; i < n; ++i)
+	{
+		BC_CHECK_NUM_ERR(ctxt, a[i]);
+		BC_CHECK_NUM_ERR(ctxt, b[i]);
+	}
+
+	fn = bcl_ops[op];
+	req = bcl_opReqs[op];
+
+	// The outputs start as errors so that the ones that were set can be found
+	// if there is an error part way through.
+	for (i = 0; i < n; ++i)
+	{
+		c[i].i = 0 - (size_t) BCL_ERROR_SIGNAL;
+	}
+
+	bc_num_clear(BCL_NUM_NUM_NP(res));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_RESERVE_NUMS(ctxt, n);
+
+	for (i = 0; i < n; ++i)
+	{
+		BclNum* aptr = BCL_NUM(ctxt, a[i]);
+		BclNum* bptr = BCL_NUM(ctxt, b[i]);
+
+		assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL);
+
+		bc_num_init(BCL_NUM_NUM_NP(res),
+		            req(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), ctxt->scale));
+
+		fn(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), BCL_NUM_NUM_NP(res),
+		   ctxt->scale);
+
+		// This cannot allocate because the space was reserved above.
+		c[i] = bcl_num_insert(ctxt, &res);
+		bc_num_clear(BCL_NUM_NUM_NP(res));
+	}
+
+err:
+
+	if (BC_ERR(vm->err != BCL_ERROR_NONE))
+	{
+		if (BCL_NUM_ARRAY_NP(res) != NULL) bc_num_free(BCL_NUM_NUM_NP(res));
+
+		// Throw away the partial results.
+		for (i = 0; i < n; ++i)
+		{
+			if (c[i].i <= 0 - (size_t) BCL_ERROR_NELEMS)
+			{
+				bcl_num_dtor(ctxt, c[i], BCL_NUM(ctxt, c[i]));
+			}
+
+			c[i].i = 0 - (size_t) vm->err;
+		}
+	}
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_nums_dtor(ctxt, a, n);
+		bcl_nums_dtor(ctxt, b, n);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+BclError
+bcl_batch(BclOp op, const BclNumber* a, const BclNumber* b, BclNumber* c,
+          size_t n)
+{
+	return bcl_batch_helper(op, a, b, c, n, true);
+}
+
+BclError
+bcl_batch_keep(BclOp op, const BclNumber* a, const BclNumber* b, BclNumber* c,
+               size_t n)
+{
+	return bcl_batch_helper(op, a, b, c, n, false);
+}
+
+static BclNumber
+bcl_fma_helper(BclNumber a, BclNumber b, BclNumber c, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* aptr;
+	BclNum* bptr;
+	BclNum* cptr;
+	BcNum prod;
+	BclNum d;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	BC_CHECK_NUM(ctxt, a);
+	BC_CHECK_NUM(ctxt, b);
+	BC_CHECK_NUM(ctxt, c);
+
+	bc_num_clear(&prod);
+	bc_num_clear(BCL_NUM_NUM_NP(d));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(BCL_NO_GEN(a) < ctxt->nnums && BCL_NO_GEN(b) < ctxt->nnums);
+	assert(BCL_NO_GEN(c) < ctxt->nnums);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+	cptr = BCL_NUM(ctxt, c);
+
+	assert(aptr != NULL && bptr != NULL && cptr != NULL);
+	assert(BCL_NUM_ARRAY(aptr) != NULL && BCL_NUM_ARRAY(bptr) != NULL &&
+	       BCL_NUM_ARRAY(cptr) != NULL);
+
+	// The product is an intermediate, so it never becomes a BclNumber.
+	bc_num_init(&prod, bc_num_mulReq(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr),
+	                                 ctxt->scale));
+	bc_num_mul(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr), &prod, ctxt->scale);
+
+	bc_num_init(BCL_NUM_NUM_NP(d),
+	            bc_num_addReq(&prod, BCL_NUM_NUM(cptr), ctxt->scale));
+	bc_num_add(&prod, BCL_NUM_NUM(cptr), BCL_NUM_NUM_NP(d), ctxt->scale);
+
+err:
+
+	if (prod.num != NULL) bc_num_free(&prod);
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_num_dtor(ctxt, a, aptr);
+		if (b.i != a.i) bcl_num_dtor(ctxt, b, bptr);
+		if (c.i != a.i && c.i != b.i) bcl_num_dtor(ctxt, c, cptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, d, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_fma(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_fma_helper(a, b, c, true);
+}
+
+BclNumber
+bcl_fma_keep(BclNumber a, BclNumber b, BclNumber c)
+{
+	return bcl_fma_helper(a, b, c, false);
+}
+
+/**
+ * Sums an array of numbers or, if @a b is not NULL, the products of the pairs
+ * of numbers in two arrays. The running total alternates between two numbers
+ * so that their memory is reused instead of allocating for every term.
+ * @param a         The array of numbers or first factors.
+ * @param b         The array of second factors, or NULL.
+ * @param n         The length of the arrays.
+ * @param destruct  True if the operands should be consumed, false otherwise.
+ * @return          The sum.
+ */
+static BclNumber
+bcl_reduce(const BclNumber* a, const BclNumber* b, size_t n, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	size_t i;
+	BcNum prod, temp, swap;
+	BclNum sum;
+	BclNumber idx;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT(vm, ctxt);
+
+	assert(n == 0 || a != NULL);
+
+	for (i = 0; i < n; ++i)
+	{
+		BC_CHECK_NUM(ctxt, a[i]);
+		if (b != NULL) BC_CHECK_NUM(ctxt, b[i]);
+	}
+
+	bc_num_clear(&prod);
+	bc_num_clear(&temp);
+	bc_num_clear(BCL_NUM_NUM_NP(sum));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	bc_num_init(BCL_NUM_NUM_NP(sum), BC_NUM_DEF_SIZE);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+	if (b != NULL) bc_num_init(&prod, BC_NUM_DEF_SIZE);
+
+	for (i = 0; i < n; ++i)
+	{
+		BcNum* term = BCL_NUM_NUM(BCL_NUM(ctxt, a[i]));
+
+		if (b != NULL)
+		{
+			bc_num_mul(term, BCL_NUM_NUM(BCL_NUM(ctxt, b[i])), &prod,
+			           ctxt->scale);
+			term = &prod;
+		}
+
+		bc_num_add(BCL_NUM_NUM_NP(sum), term, &temp, ctxt->scale);
+
+		// Swap so that the old total's memory holds the next one.
+		// NOLINTNEXTLINE
+		memcpy(&swap, BCL_NUM_NUM_NP(sum), sizeof(BcNum));
+		// NOLINTNEXTLINE
+		memcpy(BCL_NUM_NUM_NP(sum), &temp, sizeof(BcNum));
+		// NOLINTNEXTLINE
+		memcpy(&temp, &swap, sizeof(BcNum));
+	}
+
+err:
+
+	if (prod.num != NULL) bc_num_free(&prod);
+	if (temp.num != NULL) bc_num_free(&temp);
+
+	if (destruct)
+	{
+		// Eat the operands.
+		bcl_nums_dtor(ctxt, a, n);
+		if (b != NULL) bcl_nums_dtor(ctxt, b, n);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, sum, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_sum(const BclNumber* a, size_t n)
+{
+	return bcl_reduce(a, NULL, n, true);
+}
+
+BclNumber
+bcl_sum_keep(const BclNumber* a, size_t n)
+{
+	return bcl_reduce(a, NULL, n, false);
+}
+
+BclNumber
+bcl_dot(const BclNumber* a, const BclNumber* b, size_t n)
+{
+	assert(n == 0 || b != NULL);
+	return bcl_reduce(a, b, n, true);
+}
+
+BclNumber
+bcl_dot_keep(const BclNumber* a, const BclNumber* b, size_t n)
+{
+	assert(n == 0 || b != NULL);
+	return bcl_reduce(a, b, n, false);
+}
+
+ssize_t
+bcl_cmp(BclNumber a, BclNumber b)
+{
+	BclNum* aptr;
+	BclNum* bptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, a);
+	BCL_CHECK_NUM_VALID(ctxt, b);
+
+	assert(BCL_NO_GEN(a) < ctxt->nnums && BCL_NO_GEN(b) < ctxt->nnums);
+
+	aptr = BCL_NUM(ctxt, a);
+	bptr = BCL_NUM(ctxt, b);
+
+	assert(aptr != NULL && bptr != NULL);
+	assert(BCL_NUM_NUM(aptr) != NULL && BCL_NUM_NUM(bptr));
+
+	return bc_num_cmp(BCL_NUM_NUM(aptr), BCL_NUM_NUM(bptr));
+}
+
+void
+bcl_zero(BclNumber n)
+{
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	bc_num_zero(BCL_NUM_NUM(nptr));
+}
+
+void
+bcl_one(BclNumber n)
+{
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ASSERT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	bc_num_one(BCL_NUM_NUM(nptr));
+}
+
+/**
+ * Parses a number string of a known length into a context.
+ * @param ctxt  The context to put the number in.
+ * @param val   The string to parse.
+ * @param len   The length of the string.
+ * @return      The parsed number.
+ */
+static BclNumber
+bcl_parse_helper(BclContext ctxt, const char* restrict val, size_t len)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum n;
+	BclNumber idx;
+	BcVm* vm = bcl_getspecific();
+	bool neg;
+
+	BC_CHECK_CTXT_PARAM(vm, ctxt);
+
+	// Clear the number first so that nothing is freed if the string is bad.
+	bc_num_clear(BCL_NUM_NUM_NP(n));
+
+	BC_FUNC_HEADER(vm, err);
+
+	BCL_GROW_NUMS(ctxt);
+
+	assert(val != NULL);
+
+	// We have to take care of negative here because bc's number parsing does
+	// not.
+	neg = (len != 0 && val[0] == '-');
+
+	if (neg)
+	{
+		val += 1;
+		len -= 1;
+	}
+
+	if (!bc_num_strValid(val, len))
+	{
+		vm->err = BCL_ERROR_PARSE_INVALID_STR;
+		goto err;
+	}
+
+	// Initialize the number.
+	bc_num_init(BCL_NUM_NUM_NP(n), BC_NUM_DEF_SIZE);
+
+	bc_num_parse(BCL_NUM_NUM_NP(n), val, len, (BcBigDig) ctxt->ibase);
+
+	// Set the negative.
+	n.n.rdx = BC_NUM_NEG_VAL(BCL_NUM_NUM_NP(n), neg);
+
+err:
+
+	BC_FUNC_FOOTER(vm, e);
+	BC_MAYBE_SETUP(ctxt, e, n, idx);
+
+	return idx;
+}
+
+BclNumber
+bcl_parse(const char* restrict val)
+{
+	assert(val != NULL);
+	return bcl_parse_helper(bcl_context(), val, strlen(val));
+}
+
+BclNumber
+bcl_parse_n(const char* restrict val, size_t len)
+{
+	return bcl_parse_helper(bcl_context(), val, len);
+}
+
+BclNumber
+bcl_parse_ctx(BclContext ctxt, const char* restrict val)
+{
+	assert(val != NULL);
+	return bcl_parse_helper(ctxt, val, strlen(val));
+}
+
+/**
+ * Clears the output buffer of the thread before printing into it. The buffer is
+ * lent to writers while they run, so if a writer calls the library to print,
+ * a new buffer is made here.
+ * @param vm  The thread data.
+ */
+static void
+bcl_out_clear(BcVm* vm)
+{
+	if (vm->out.v == NULL) bc_vec_init(&vm->out, sizeof(uchar), BC_DTOR_NONE);
+	else bc_vec_popAll(&vm->out);
+}
+
+static char*
+bcl_string_helper(BclContext ctxt, BclNumber n, bool destruct)
+{
+	BclNum* nptr;
+	char* str = NULL;
+	BcVm* vm = bcl_getspecific();
+
+	assert(ctxt != NULL);
+
+	BCL_USE_CTXT(vm, ctxt);
+
+	BCL_CHECK_NUM_VALID(ctxt, n);
+
+	if (BC_ERR(BCL_NO_GEN(n) >= ctxt->nnums || BCL_NUM_STALE(ctxt, n)))
+	{
+		return str;
+	}
+
+	BC_FUNC_HEADER(vm, err);
+
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	// Clear the buffer.
+	bcl_out_clear(vm);
+
+	// Print to the buffer.
+	bc_num_print(BCL_NUM_NUM(nptr), (BcBigDig) ctxt->obase, false);
+	bc_vec_pushByte(&vm->out, '\0');
+
+	// Just dup the string; the caller is responsible for it.
+	str = bc_vm_strdup(vm->out.v);
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operand.
+		bcl_num_dtor(ctxt, n, nptr);
+	}
+
+	BC_FUNC_FOOTER_NO_ERR(vm);
+
+	return str;
+}
+
+char*
+bcl_string(BclNumber n)
+{
+	return bcl_string_helper(bcl_context(), n, true);
+}
+
+char*
+bcl_string_keep(BclNumber n)
+{
+	return bcl_string_helper(bcl_context(), n, false);
+}
+
+char*
+bcl_string_ctx(BclContext ctxt, BclNumber n)
+{
+	return bcl_string_helper(ctxt, n, true);
+}
+
+char*
+bcl_string_keep_ctx(BclContext ctxt, BclNumber n)
+{
+	return bcl_string_helper(ctxt, n, false);
+}
+
+/**
+ * Prints a number into the output buffer of the thread, followed by a nul byte
+ * that is counted in its length. The string is only valid until the next call
+ * into the library.
+ * @param n         The number to print.
+ * @param destruct  True if the number should be consumed, false otherwise.
+ * @return          An error code, if any.
+ */
+static BclError
+bcl_string_out(BclNumber n, bool destruct)
+{
+	BclError e = BCL_ERROR_NONE;
+	BclNum* nptr;
+	BclContext ctxt;
+	BcVm* vm = bcl_getspecific();
+
+	BC_CHECK_CTXT_ERR(vm, ctxt);
+
+	BC_CHECK_NUM_ERR(ctxt, n);
+
+	BC_FUNC_HEADER(vm, err);
+
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
+
+	nptr = BCL_NUM(ctxt, n);
+
+	assert(nptr != NULL && BCL_NUM_NUM(nptr) != NULL);
+
+	// Clear the buffer.
+	bcl_out_clear(vm);
+
+	// Print to the buffer.
+	bc_num_print(BCL_NUM_NUM(nptr), (BcBigDig) ctxt->obase, false);
+	bc_vec_pushByte(&vm->out, '\0');
+
+err:
+
+	if (destruct)
+	{
+		// Eat the operand.
+		bcl_num_dtor(ctxt, n, nptr);
+	}
+
+	BC_FUNC_FOOTER(vm, e);
+
+	return e;
+}
+
+/**
+ * Prints a number and passes the string to a writer. The writer is called after
+ * printing is done, and it is lent the output buffer of the thread itself, so
+ * nothing is copied. The thread gets the buffer back after the writer returns,
+ * and until then, it makes a new one if the writer calls the library to print.
+ * @param n         The number to print.
+ * @param w         The writer.
+ * @param data      The data to pass to the writer.
+ * @param destruct  True if the number should be consumed, false otherwise.
+ * @return          An error code, if any.
+ */
+static BclError
+bcl_string_write_helper(BclNumber n, BclWriter w, void* data, bool destruct)
+{
+	BclError e;
+	BcVm* vm;
+	BcVec out;
+
+	assert(w != NULL);
+
+	e = bcl_string_out(n, destruct);
+	if (BC_ERR(e != BCL_ERROR_NONE)) return e;
+
+	vm = bcl_getspecific();
+
+	// Lend the buffer to the writer.
+	out = vm->out;
+	vm->out.v = NULL;
 
-	return str;
+	w(out.v, out.len - 1, data);
+
+	// Free the buffer that the writer made, if any, and take this one back.
+	if (vm->out.v != NULL) bc_vec_free(&vm->out);
+	vm->out = out;
+
+	return e;
 }
 
-char*
-bcl_string(BclNumber n)
+BclError
+bcl_string_write(BclNumber n, BclWriter w, void* data)
 {
-	return bcl_string_helper(n, true);
+	return bcl_string_write_helper(n, w, data, true);
 }
 
-char*
-bcl_string_keep(BclNumber n)
+BclError
+bcl_string_write_keep(BclNumber n, BclWriter w, void* data)
+{
+	return bcl_string_write_helper(n, w, data, false);
+}
+
+/**
+ * Prints a number into a caller's buffer. Like snprintf(), it writes as much as
+ * fits, always nul terminates if there is space, and reports the needed size.
+ * @param n         The number to print.
+ * @param buf       The buffer.
+ * @param cap       The capacity of @a buf.
+ * @param needed    An out parameter for the size needed for the whole string,
+ *                  including the nul byte. Can be NULL.
+ * @param destruct  True if the number should be consumed, false otherwise.
+ * @return          An error code, if any.
+ */
+static BclError
+bcl_string_into_helper(BclNumber n, char* buf, size_t cap, size_t* needed,
+                       bool destruct)
+{
+	BclError e;
+	BcVm* vm;
+	size_t len;
+
+	assert(buf != NULL || !cap);
+
+	e = bcl_string_out(n, destruct);
+	if (BC_ERR(e != BCL_ERROR_NONE)) return e;
+
+	vm = bcl_getspecific();
+	len = vm->out.len - 1;
+
+	if (cap)
+	{
+		size_t amt = len < cap ? len : cap - 1;
+
+		// NOLINTNEXTLINE
+		memcpy(buf, vm->out.v, amt);
+		buf[amt] = '\0';
+	}
+
+	if (needed != NULL) *needed = len + 1;
+
+	return e;
+}
+
+BclError
+bcl_string_into(BclNumber n, char* buf, size_t cap, size_t* needed)
+{
+	return bcl_string_into_helper(n, buf, cap, needed, true);
+}
+
+BclError
+bcl_string_into_keep(BclNumber n, char* buf, size_t cap, size_t* needed)
+{
+	return bcl_string_into_helper(n, buf, cap, needed, false);
+}
+
+/**
+ * Locks a thread pool.
+ * @param pool  The pool.
+ */
+static void
+bcl_pool_lock(BclPool pool)
+{
+#ifndef _WIN32
+	// We ignore the return value; the mutex is valid.
+	pthread_mutex_lock(&pool->lock);
+#else // _WIN32
+	EnterCriticalSection(&pool->lock);
+#endif // _WIN32
+}
+
+/**
+ * Unlocks a thread pool.
+ * @param pool  The pool.
+ */
+static void
+bcl_pool_unlock(BclPool pool)
+{
+#ifndef _WIN32
+	// We ignore the return value; the mutex is valid.
+	pthread_mutex_unlock(&pool->lock);
+#else // _WIN32
+	LeaveCriticalSection(&pool->lock);
+#endif // _WIN32
+}
+
+/**
+ * Waits on a condition of a locked thread pool.
+ * @param pool  The pool.
+ * @param cond  The condition.
+ */
+static void
+bcl_pool_wait(BclPool pool, BclCond* cond)
+{
+#ifndef _WIN32
+	// We ignore the return value; spurious wakeups are handled by the callers.
+	pthread_cond_wait(cond, &pool->lock);
+#else // _WIN32
+	SleepConditionVariableCS(cond, &pool->lock, INFINITE);
+#endif // _WIN32
+}
+
+/**
+ * Wakes all of the threads waiting on a condition.
+ * @param cond  The condition.
+ */
+static void
+bcl_pool_wake(BclCond* cond)
+{
+#ifndef _WIN32
+	// We ignore the return value; the condition is valid.
+	pthread_cond_broadcast(cond);
+#else // _WIN32
+	WakeAllConditionVariable(cond);
+#endif // _WIN32
+}
+
+/**
+ * Does one operation of the current batch of a thread pool.
+ * @param pool  The pool.
+ * @param ctxt  The worker's context.
+ * @param i     The index of the operation.
+ * @return      An error code, if any.
+ */
+static BclError
+bcl_pool_op(BclPool pool, BclContext ctxt, size_t i)
+{
+	BclNumber a, b, res;
+	BclError e;
+	char* str = NULL;
+
+	a = bcl_parse_helper(ctxt, pool->a[i], strlen(pool->a[i]));
+	b = bcl_parse_helper(ctxt, pool->b[i], strlen(pool->b[i]));
+
+	// Errors in the operands are propagated. The context of the worker is the
+	// current one, so bcl_modexp() uses it.
+	if (pool->m != NULL)
+	{
+		BclNumber m = bcl_parse_helper(ctxt, pool->m[i], strlen(pool->m[i]));
+		res = bcl_modexp(a, b, m);
+	}
+	else
+	{
+		res = bcl_binary(ctxt, a, b, bcl_ops[pool->op], bcl_opReqs[pool->op],
+		                 true);
+	}
+
+	e = bcl_err_ctx(ctxt, res);
+
+	if (e == BCL_ERROR_NONE)
+	{
+		str = bcl_string_helper(ctxt, res, true);
+		if (BC_ERR(str == NULL)) e = BCL_ERROR_FATAL_ALLOC_ERR;
+	}
+
+	// The context is in arena mode, so this is cheap.
+	bcl_ctxt_freeNums(ctxt);
+
+	pool->c[i] = str;
+	if (pool->errs != NULL) pool->errs[i] = e;
+
+	return e;
+}
+
+/**
+ * The body of a worker thread. It sets up its own BcVm and context, then does
+ * operations from each batch until the pool shuts down. Operations are taken
+ * one at a time from a shared index, so workers that get cheap operations just
+ * take more of them.
+ * @param pool  The pool.
+ */
+static void
+bcl_pool_work(BclPool pool)
+{
+	size_t batch = 0;
+	BclContext ctxt = NULL;
+	bool init, ok;
+
+	init = (bcl_init() == BCL_ERROR_NONE);
+	ok = init;
+
+	if (ok)
+	{
+		ctxt = bcl_ctxt_create();
+		ok = (ctxt != NULL);
+	}
+
+	if (ok) ok = (bcl_pushContext(ctxt) == BCL_ERROR_NONE);
+
+	if (ok) bcl_ctxt_setArena(ctxt, true);
+
+	bcl_pool_lock(pool);
+
+	if (!ok) pool->failed += 1;
+
+	pool->active -= 1;
+	if (!pool->active) bcl_pool_wake(&pool->done);
+
+	while (ok)
+	{
+		while (!pool->quit && pool->batch == batch)
+		{
+			bcl_pool_wait(pool, &pool->work);
+		}
+
+		if (pool->quit) break;
+
+		batch = pool->batch;
+
+		ctxt->scale = pool->scale;
+		ctxt->ibase = pool->ibase;
+		ctxt->obase = pool->obase;
+
+		bcl_setLeadingZeroes(pool->leading_zeroes);
+		bcl_setDigitClamp(pool->digit_clamp);
+
+		while (pool->next < pool->n)
+		{
+			size_t i = pool->next;
+			BclError e;
+
+			pool->next += 1;
+
+			bcl_pool_unlock(pool);
+
+			e = bcl_pool_op(pool, ctxt, i);
+
+			bcl_pool_lock(pool);
+
+			// Keep the error of the first operation that failed so that the
+			// result does not depend on the scheduling.
+			if (e != BCL_ERROR_NONE && i < pool->first)
+			{
+				pool->first = i;
+				pool->err = e;
+			}
+		}
+
+		pool->active -= 1;
+		if (!pool->active) bcl_pool_wake(&pool->done);
+	}
+
+	bcl_pool_unlock(pool);
+
+	if (ctxt != NULL)
+	{
+		if (ok) bcl_popContext();
+		bcl_ctxt_free(ctxt);
+	}
+
+	if (init) bcl_free();
+}
+
+#ifndef _WIN32
+
+/**
+ * The start routine of a worker thread.
+ * @param data  The pool.
+ * @return      NULL.
+ */
+static void*
+bcl_pool_thread(void* data)
+{
+	bcl_pool_work((BclPool) data);
+	return NULL;
+}
+
+#else // _WIN32
+
+/**
+ * The start routine of a worker thread.
+ * @param data  The pool.
+ * @return      0.
+ */
+static DWORD WINAPI
+bcl_pool_thread(LPVOID data)
+{
+	bcl_pool_work((BclPool) data);
+	return 0;
+}
+
+#endif // _WIN32
+
+/**
+ * Shuts down the workers of a thread pool and frees it.
+ * @param pool  The pool.
+ * @param n     The number of workers that were started.
+ */
+static void
+bcl_pool_destroy(BclPool pool, size_t n)
+{
+	size_t i;
+
+	bcl_pool_lock(pool);
+
+	pool->quit = true;
+	bcl_pool_wake(&pool->work);
+
+	bcl_pool_unlock(pool);
+
+	for (i = 0; i < n; ++i)
+	{
+#ifndef _WIN32
+		pthread_join(pool->threads[i], NULL);
+#else // _WIN32
+		WaitForSingleObject(pool->threads[i], INFINITE);
+		CloseHandle(pool->threads[i]);
+#endif // _WIN32
+	}
+
+#ifndef _WIN32
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->work);
+	pthread_mutex_destroy(&pool->lock);
+#else // _WIN32
+	DeleteCriticalSection(&pool->lock);
+#endif // _WIN32
+
+	free(pool->threads);
+	free(pool);
+}
+
+BclPool
+bcl_pool_create(size_t nthreads)
+{
+	BclPool pool;
+	size_t i;
+
+	if (!nthreads)
+	{
+#ifndef _WIN32
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = cpus > 0 ? (size_t) cpus : 1;
+#else // _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		nthreads = info.dwNumberOfProcessors ?
+		               (size_t) info.dwNumberOfProcessors :
+		               1;
+#endif // _WIN32
+	}
+
+	// The pool does not use a BcVm, so allocation failures are returned
+	// instead of thrown.
+	pool = calloc(1, sizeof(BclThreadPool));
+	if (BC_ERR(pool == NULL)) return NULL;
+
+	pool->threads = calloc(nthreads, sizeof(BclThread));
+	if (BC_ERR(pool->threads == NULL))
+	{
+		free(pool);
+		return NULL;
+	}
+
+#ifndef _WIN32
+	if (BC_ERR(pthread_mutex_init(&pool->lock, NULL)))
+	{
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+
+	if (BC_ERR(pthread_cond_init(&pool->work, NULL)))
+	{
+		pthread_mutex_destroy(&pool->lock);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+
+	if (BC_ERR(pthread_cond_init(&pool->done, NULL)))
+	{
+		pthread_cond_destroy(&pool->work);
+		pthread_mutex_destroy(&pool->lock);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+#else // _WIN32
+	InitializeCriticalSection(&pool->lock);
+	InitializeConditionVariable(&pool->work);
+	InitializeConditionVariable(&pool->done);
+#endif // _WIN32
+
+	pool->nthreads = nthreads;
+
+	// This has to be set before any worker starts because the workers count
+	// it down as they finish starting.
+	pool->active = nthreads;
+
+	for (i = 0; i < nthreads; ++i)
+	{
+#ifndef _WIN32
+		bool started = !pthread_create(pool->threads + i, NULL,
+		                               bcl_pool_thread, pool);
+#else // _WIN32
+		pool->threads[i] = CreateThread(NULL, 0, bcl_pool_thread, pool, 0,
+		                                NULL);
+		bool started = (pool->threads[i] != NULL);
+#endif // _WIN32
+
+		if (BC_ERR(!started))
+		{
+			// Account for the workers that will never start.
+			bcl_pool_lock(pool);
+			pool->active -= nthreads - i;
+			pool->failed += 1;
+			bcl_pool_unlock(pool);
+
+			break;
+		}
+	}
+
+	bcl_pool_lock(pool);
+
+	while (pool->active)
+	{
+		bcl_pool_wait(pool, &pool->done);
+	}
+
+	bcl_pool_unlock(pool);
+
+	if (BC_ERR(pool->failed))
+	{
+		bcl_pool_destroy(pool, i);
+		return NULL;
+	}
+
+	return pool;
+}
+
+void
+bcl_pool_free(BclPool pool)
+{
+	bcl_pool_destroy(pool, pool->nthreads);
+}
+
+size_t
+bcl_pool_threads(BclPool pool)
+{
+	return pool->nthreads;
+}
+
+/**
+ * Runs a batch on a thread pool and waits for it to finish.
+ * @param pool  The pool.
+ * @param ctxt  The context to take the scale, ibase, and obase from.
+ * @param op    The operator. It is ignored if @a m is not NULL.
+ * @param a     The first operands.
+ * @param b     The second operands.
+ * @param m     The moduli for modular exponentiation, or NULL to use @a op.
+ * @param c     The array to put the results in.
+ * @param errs  The array to put the errors in, or NULL.
+ * @param n     The number of operations.
+ * @return      The error of the first operation that failed, if any.
+ */
+static BclError
+bcl_pool_run(BclPool pool, BclContext ctxt, BclOp op, const char* const* a,
+             const char* const* b, const char* const* m, char** c,
+             BclError* errs, size_t n)
+{
+	BclError e;
+
+	assert(pool != NULL && op < BCL_OP_NELEMS);
+	assert(n == 0 || (a != NULL && b != NULL && c != NULL));
+
+	if (BC_ERR(ctxt == NULL)) return BCL_ERROR_INVALID_CONTEXT;
+
+	if (!n) return BCL_ERROR_NONE;
+
+	bcl_pool_lock(pool);
+
+	pool->op = op;
+	pool->a = a;
+	pool->b = b;
+	pool->m = m;
+	pool->c = c;
+	pool->errs = errs;
+	pool->n = n;
+	pool->next = 0;
+	pool->first = n;
+	pool->err = BCL_ERROR_NONE;
+
+	// The workers copy these into their own contexts and threads, so the
+	// caller's context is not shared.
+	pool->scale = ctxt->scale;
+	pool->ibase = ctxt->ibase;
+	pool->obase = ctxt->obase;
+	pool->leading_zeroes = bcl_leadingZeroes();
+	pool->digit_clamp = bcl_digitClamp();
+
+	pool->active = pool->nthreads;
+	pool->batch += 1;
+
+	bcl_pool_wake(&pool->work);
+
+	while (pool->active)
+	{
+		bcl_pool_wait(pool, &pool->done);
+	}
+
+	e = pool->err;
+
+	bcl_pool_unlock(pool);
+
+	return e;
+}
+
+BclError
+bcl_pool_batch(BclPool pool, BclContext ctxt, BclOp op, const char* const* a,
+               const char* const* b, char** c, BclError* errs, size_t n)
+{
+	return bcl_pool_run(pool, ctxt, op, a, b, NULL, c, errs, n);
+}
+
+BclError
+bcl_pool_modexp(BclPool pool, BclContext ctxt, const char* const* a,
+                const char* const* b, const char* const* m, char** c,
+                BclError* errs, size_t n)
 {
-	return bcl_string_helper(n, false);
+	assert(n == 0 || m != NULL);
+	return bcl_pool_run(pool, ctxt, BCL_OP_ADD, a, b, m, c, errs, n);
 }
 
 #if BC_ENABLE_EXTRA_MATH
@@ -1437,7 +3435,7 @@ bcl_irand_helper(BclNumber a, bool destruct)
 
 	BCL_GROW_NUMS(ctxt);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len);
+	assert(BCL_NO_GEN(a) < ctxt->nnums);
 
 	aptr = BCL_NUM(ctxt, a);
 
@@ -1600,7 +3598,7 @@ bcl_ifrand_helper(BclNumber a, size_t places, bool destruct)
 
 	BCL_GROW_NUMS(ctxt);
 
-	assert(BCL_NO_GEN(a) < ctxt->nums.len);
+	assert(BCL_NO_GEN(a) < ctxt->nnums);
 
 	aptr = BCL_NUM(ctxt, a);
 
@@ -1651,7 +3649,7 @@ bcl_rand_seedWithNum_helper(BclNumber n, bool destruct)
 
 	BC_FUNC_HEADER(vm, err);
 
-	assert(BCL_NO_GEN(n) < ctxt->nums.len);
+	assert(BCL_NO_GEN(n) < ctxt->nnums);
 
 	nptr = BCL_NUM(ctxt, n);
 
@@ -51,6 +51,47 @@
 // Before you try to understand this code, see the development manual
 // (manuals/development.md#numbers).
 
+#if BC_ENABLE_LIBRARY
+
+/// Gives a bcl client a chance to stop a long operation. This must only be
+/// used where a jump is safe. See BCL_POLL().
+#define BC_NUM_POLL BCL_POLL(vm)
+
+/// The arena of the running operation. Each operation looks up its vm once,
+/// and its numbers use the arena from there instead of looking it up for
+/// every allocation. See BCL_USE_CTXT().
+#define BC_NUM_ARENA ((vm)->arena)
+
+#else // BC_ENABLE_LIBRARY
+
+/// bc and dc stop long operations with signals instead.
+#define BC_NUM_POLL
+
+/// bc and dc do not have arenas.
+#define BC_NUM_ARENA (NULL)
+
+#endif // BC_ENABLE_LIBRARY
+
+/**
+ * Initializes a number with the arena of the running operation.
+ * @param n    The number to initialize.
+ * @param req  The number of limbs the number must have.
+ */
+#define BC_NUM_INIT(n, req) bc_num_initArena((n), (req), BC_NUM_ARENA)
+
+/**
+ * Frees a number with the arena of the running operation.
+ * @param n  The number to free.
+ */
+#define BC_NUM_FREE(n) bc_num_freeArena((n), BC_NUM_ARENA)
+
+/**
+ * Expands a number with the arena of the running operation.
+ * @param n    The number to expand.
+ * @param req  The number of limbs to expand the number to.
+ */
+#define BC_NUM_EXPAND(n, req) bc_num_expandArena((n), (req), BC_NUM_ARENA)
+
 static void
 bc_num_m(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale);
 
@@ -104,27 +145,60 @@ bc_num_int(const BcNum* n)
 
 /**
  * Expand a number's allocation capacity to at least req limbs.
- * @param n    The number to expand.
- * @param req  The number limbs to expand the allocation capacity to.
+ * @param n      The number to expand.
+ * @param req    The number limbs to expand the allocation capacity to.
+ * @param arena  The arena of the running operation, or NULL.
  */
 static void
-bc_num_expand(BcNum* restrict n, size_t req)
+bc_num_expandArena(BcNum* restrict n, size_t req, struct BclArena* arena)
 {
 	assert(n != NULL);
 
+#if !BC_ENABLE_LIBRARY
+	BC_UNUSED(arena);
+#endif // !BC_ENABLE_LIBRARY
+
 	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
 
 	if (req > n->cap)
 	{
 		BC_SIG_LOCK;
 
-		n->num = bc_vm_realloc(n->num, BC_NUM_SIZE(req));
+#if BC_ENABLE_LIBRARY
+		if (arena != NULL && bcl_arena_owns(arena, n->num))
+		{
+			n->num = bcl_arena_realloc(arena, n->num, n->cap, req);
+		}
+		else
+#endif // BC_ENABLE_LIBRARY
+		{
+			n->num = bc_vm_realloc(n->num, BC_NUM_SIZE(req));
+		}
+
 		n->cap = req;
 
 		BC_SIG_UNLOCK;
 	}
 }
 
+/**
+ * Expand a number's allocation capacity to at least req limbs. This is for
+ * helpers that do not have the vm at hand; in the library, the arena is only
+ * looked up if the number actually has to grow.
+ * @param n    The number to expand.
+ * @param req  The number limbs to expand the allocation capacity to.
+ */
+static void
+bc_num_expand(BcNum* restrict n, size_t req)
+{
+#if BC_ENABLE_LIBRARY
+	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
+	if (req > n->cap) bc_num_expandArena(n, req, bcl_getspecific()->arena);
+#else // BC_ENABLE_LIBRARY
+	bc_num_expandArena(n, req, NULL);
+#endif // BC_ENABLE_LIBRARY
+}
+
 /**
  * Set a number to 0 with the specified scale.
  * @param n      The number to set to zero.
@@ -1259,6 +1333,78 @@ bc_num_m_simp(const BcNum* a, const BcNum* b, BcNum* restrict c)
 	c->len = clen;
 }
 
+/**
+ * The squaring counterpart of bc_num_m_simp(). Every product of two different
+ * limbs shows up twice in a square, so it is only calculated once and doubled,
+ * which halves the work.
+ * @param a  The operand.
+ * @param c  The return parameter.
+ */
+static void
+bc_num_m_sqr(const BcNum* a, BcNum* restrict c)
+{
+	size_t i, alen = a->len, clen;
+	BcDig* ptr_a = a->num;
+	BcDig* ptr_c;
+	BcBigDig sum = 0, carry = 0;
+
+	assert(!BC_NUM_RDX_VAL(a));
+
+	// Make sure c is big enough.
+	clen = bc_vm_growSize(alen, alen);
+	bc_num_expand(c, bc_vm_growSize(clen, 1));
+
+	// If we don't memset, then we might have uninitialized data use later.
+	ptr_c = c->num;
+	// NOLINTNEXTLINE
+	memset(ptr_c, 0, BC_NUM_SIZE(c->cap));
+
+	// This is the same lattice as in bc_num_m_simp(), but it only goes to the
+	// middle of each diagonal. A doubled product is less than
+	// 2 * BC_BASE_POW^2, and sum is kept below BC_BASE_POW^2, so this cannot
+	// overflow.
+	for (i = 0; i < clen; ++i)
+	{
+		ssize_t sidx = (ssize_t) (i - alen + 1);
+		size_t j, k;
+
+		// These are the start indices.
+		j = (size_t) BC_MAX(0, sidx);
+		k = BC_MIN(i, alen - 1);
+
+		for (; j < k; ++j, --k)
+		{
+			sum += 2 * ((BcBigDig) ptr_a[j]) * ((BcBigDig) ptr_a[k]);
+
+			if (sum >= ((BcBigDig) BC_BASE_POW) * BC_BASE_POW)
+			{
+				carry += sum / BC_BASE_POW;
+				sum %= BC_BASE_POW;
+			}
+		}
+
+		// The middle of the diagonal, if there is one, is a square.
+		if (j == k) sum += ((BcBigDig) ptr_a[j]) * ((BcBigDig) ptr_a[j]);
+
+		// Calculate the carry.
+		if (sum >= BC_BASE_POW)
+		{
+			carry += sum / BC_BASE_POW;
+			sum %= BC_BASE_POW;
+		}
+
+		// Store and set up for next iteration.
+		ptr_c[i] = (BcDig) sum;
+		assert(ptr_c[i] < BC_BASE_POW);
+		sum = carry;
+		carry = 0;
+	}
+
+	assert(!sum);
+
+	c->len = clen;
+}
+
 /**
  * Does a shifted add or subtract for Karatsuba below. This calls either
  * bc_num_addArrays() or bc_num_subArrays().
@@ -1289,6 +1435,12 @@ bc_num_k(const BcNum* a, const BcNum* b, BcNum* restrict c)
 	BcDig* dig_ptr;
 	BcNumShiftAddOp op;
 	bool aone = BC_NUM_ONE(a);
+	// A square only needs the halves of a. These point to the halves that the
+	// products use.
+	bool sqr = (a == b);
+	BcNum* pl2 = sqr ? &l1 : &l2;
+	BcNum* ph2 = sqr ? &h1 : &h2;
+	BcNum* pm2 = sqr ? &m1 : &m2;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
@@ -1307,7 +1459,8 @@ bc_num_k(const BcNum* a, const BcNum* b, BcNum* restrict c)
 	// Shell out to the simple algorithm with certain conditions.
 	if (a->len < BC_NUM_KARATSUBA_LEN || b->len < BC_NUM_KARATSUBA_LEN)
 	{
-		bc_num_m_simp(a, b, c);
+		if (sqr) bc_num_m_sqr(a, c);
+		else bc_num_m_simp(a, b, c);
 		return;
 	}
 
@@ -1342,68 +1495,71 @@ bc_num_k(const BcNum* a, const BcNum* b, BcNum* restrict c)
 	// Some temporaries need the ability to grow, so we allocate them
 	// separately.
 	max = bc_vm_growSize(max, 1);
-	bc_num_init(&z0, max);
-	bc_num_init(&z1, max);
-	bc_num_init(&z2, max);
+	BC_NUM_INIT(&z0, max);
+	BC_NUM_INIT(&z1, max);
+	BC_NUM_INIT(&z2, max);
 	max = bc_vm_growSize(max, max) + 1;
-	bc_num_init(&temp, max);
+	BC_NUM_INIT(&temp, max);
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
+	BC_NUM_POLL;
+
 	// First, set up c.
-	bc_num_expand(c, max);
+	BC_NUM_EXPAND(c, max);
 	c->len = max;
 	// NOLINTNEXTLINE
 	memset(c->num, 0, BC_NUM_SIZE(c->len));
 
 	// Split the parameters.
 	bc_num_split(a, max2, &l1, &h1);
-	bc_num_split(b, max2, &l2, &h2);
+	if (!sqr) bc_num_split(b, max2, &l2, &h2);
 
 	// Do the subtraction.
 	bc_num_sub(&h1, &l1, &m1, 0);
-	bc_num_sub(&l2, &h2, &m2, 0);
+	if (!sqr) bc_num_sub(&l2, &h2, &m2, 0);
 
 	// The if statements below are there for efficiency reasons. The best way to
 	// understand them is to understand the Karatsuba algorithm because now that
 	// the ollocations and splits are done, the algorithm is pretty
 	// straightforward.
 
-	if (BC_NUM_NONZERO(&h1) && BC_NUM_NONZERO(&h2))
+	if (BC_NUM_NONZERO(&h1) && BC_NUM_NONZERO(ph2))
 	{
 		assert(BC_NUM_RDX_VALID_NP(h1));
-		assert(BC_NUM_RDX_VALID_NP(h2));
+		assert(BC_NUM_RDX_VALID(ph2));
 
-		bc_num_m(&h1, &h2, &z2, 0);
+		bc_num_m(&h1, ph2, &z2, 0);
 		bc_num_clean(&z2);
 
 		bc_num_shiftAddSub(c, &z2, max2 * 2, bc_num_addArrays);
 		bc_num_shiftAddSub(c, &z2, max2, bc_num_addArrays);
 	}
 
-	if (BC_NUM_NONZERO(&l1) && BC_NUM_NONZERO(&l2))
+	if (BC_NUM_NONZERO(&l1) && BC_NUM_NONZERO(pl2))
 	{
 		assert(BC_NUM_RDX_VALID_NP(l1));
-		assert(BC_NUM_RDX_VALID_NP(l2));
+		assert(BC_NUM_RDX_VALID(pl2));
 
-		bc_num_m(&l1, &l2, &z0, 0);
+		bc_num_m(&l1, pl2, &z0, 0);
 		bc_num_clean(&z0);
 
 		bc_num_shiftAddSub(c, &z0, max2, bc_num_addArrays);
 		bc_num_shiftAddSub(c, &z0, 0, bc_num_addArrays);
 	}
 
-	if (BC_NUM_NONZERO(&m1) && BC_NUM_NONZERO(&m2))
+	if (BC_NUM_NONZERO(&m1) && BC_NUM_NONZERO(pm2))
 	{
 		assert(BC_NUM_RDX_VALID_NP(m1));
-		assert(BC_NUM_RDX_VALID_NP(m1));
+		assert(BC_NUM_RDX_VALID(pm2));
 
-		bc_num_m(&m1, &m2, &z1, 0);
+		bc_num_m(&m1, pm2, &z1, 0);
 		bc_num_clean(&z1);
 
-		op = (BC_NUM_NEG_NP(m1) != BC_NUM_NEG_NP(m2)) ?
+		// For a square, m2 would be -m1, so the product is always subtracted.
+		op = (sqr || BC_NUM_NEG_NP(m1) != BC_NUM_NEG(pm2)) ?
 		         bc_num_subArrays :
 		         bc_num_addArrays;
 		bc_num_shiftAddSub(c, &z1, max2, op);
@@ -1412,10 +1568,10 @@ bc_num_k(const BcNum* a, const BcNum* b, BcNum* restrict c)
 err:
 	BC_SIG_MAYLOCK;
 	free(digs);
-	bc_num_free(&temp);
-	bc_num_free(&z2);
-	bc_num_free(&z1);
-	bc_num_free(&z0);
+	BC_NUM_FREE(&temp);
+	BC_NUM_FREE(&z2);
+	BC_NUM_FREE(&z1);
+	BC_NUM_FREE(&z0);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -1495,8 +1651,8 @@ bc_num_m(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 
 	// We need copies because of all of the mutation needed to make Karatsuba
 	// think the numbers are integers.
-	bc_num_init(&cpa, a->len + BC_NUM_RDX_VAL(a));
-	bc_num_init(&cpb, b->len + BC_NUM_RDX_VAL(b));
+	BC_NUM_INIT(&cpa, a->len + BC_NUM_RDX_VAL(a));
+	BC_NUM_INIT(&cpb, b->len + BC_NUM_RDX_VAL(b));
 
 	BC_SETJMP_LOCKED(vm, init_err);
 
@@ -1539,7 +1695,8 @@ bc_num_m(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	bc_num_clean(&cpa);
 	bc_num_clean(&cpb);
 
-	bc_num_k(&cpa, &cpb, c);
+	// Passing the same copy twice lets bc_num_k() square.
+	bc_num_k(&cpa, a == b ? &cpa : &cpb, c);
 
 	// The return parameter needs to have its scale set. This is the start. It
 	// also needs to be shifted by the same amount as a and b have limbs after
@@ -1547,7 +1704,7 @@ bc_num_m(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	zero = bc_vm_growSize(azero, bzero);
 	len = bc_vm_growSize(c->len, zero);
 
-	bc_num_expand(c, len);
+	BC_NUM_EXPAND(c, len);
 
 	// Shift c based on the limbs after the decimal point in a and b.
 	bc_num_shiftLeft(c, (len - c->len) * BC_BASE_DIGS);
@@ -1561,8 +1718,8 @@ err:
 	bc_num_unshiftZero(&cpa, azero);
 init_err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&cpb);
-	bc_num_free(&cpa);
+	BC_NUM_FREE(&cpb);
+	BC_NUM_FREE(&cpa);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -1671,7 +1828,7 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 
 	// This is a final time to make sure c is big enough and that its array is
 	// properly zeroed.
-	bc_num_expand(c, a->len);
+	BC_NUM_EXPAND(c, a->len);
 	// NOLINTNEXTLINE
 	memset(c->num, 0, c->cap * sizeof(BcDig));
 
@@ -1706,7 +1863,7 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 			// Check bc_num_d(). In there, we grow a again and again. We do it
 			// again here; we *always* want to be sure it is big enough.
 			len2 = BC_MAX(a->len, b->len);
-			bc_num_expand(a, len2 + 1);
+			BC_NUM_EXPAND(a, len2 + 1);
 
 			// Make a have a zero most significant limb to match the len.
 			if (len2 + 1 > a->len) a->len = len2 + 1;
@@ -1736,7 +1893,7 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 	divisor += realnonzero;
 
 	// Make sure c can fit the new length.
-	bc_num_expand(c, a->len);
+	BC_NUM_EXPAND(c, a->len);
 	// NOLINTNEXTLINE
 	memset(c->num, 0, BC_NUM_SIZE(c->cap));
 
@@ -1745,7 +1902,7 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 
 	BC_SIG_LOCK;
 
-	bc_num_init(&cpb, len + 1);
+	BC_NUM_INIT(&cpb, len + 1);
 
 	BC_SETJMP_LOCKED(vm, err);
 
@@ -1758,6 +1915,8 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 		BcDig* n;
 		BcBigDig result;
 
+		BC_NUM_POLL;
+
 		n = a->num + i;
 		assert(n >= a->num);
 		result = 0;
@@ -1814,7 +1973,7 @@ bc_num_d_long(BcNum* restrict a, BcNum* restrict b, BcNum* restrict c,
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&cpb);
+	BC_NUM_FREE(&cpb);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -1865,7 +2024,7 @@ bc_num_d(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	// Initialize copies of the parameters. We want the length of the first
 	// operand copy to be as big as the result because of the way the division
 	// is implemented.
-	bc_num_init(&cpa, len);
+	BC_NUM_INIT(&cpa, len);
 	bc_num_copy(&cpa, a);
 	bc_num_createCopy(&cpb, b);
 
@@ -1879,7 +2038,7 @@ bc_num_d(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	// larger than the second parameter.
 	if (len > cpa.len)
 	{
-		bc_num_expand(&cpa, bc_vm_growSize(len, 2));
+		BC_NUM_EXPAND(&cpa, bc_vm_growSize(len, 2));
 		bc_num_extend(&cpa, (len - cpa.len) * BC_BASE_DIGS);
 	}
 
@@ -1901,7 +2060,7 @@ bc_num_d(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	}
 
 	// Grow if necessary.
-	if (cpa.cap == cpa.len) bc_num_expand(&cpa, bc_vm_growSize(cpa.len, 1));
+	if (cpa.cap == cpa.len) BC_NUM_EXPAND(&cpa, bc_vm_growSize(cpa.len, 1));
 
 	// We want an extra zero in front to make things simpler.
 	cpa.num[cpa.len++] = 0;
@@ -1922,8 +2081,8 @@ bc_num_d(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&cpb);
-	bc_num_free(&cpa);
+	BC_NUM_FREE(&cpb);
+	BC_NUM_FREE(&cpa);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -1963,7 +2122,7 @@ bc_num_r(BcNum* a, BcNum* b, BcNum* restrict c, BcNum* restrict d, size_t scale,
 
 	BC_SIG_LOCK;
 
-	bc_num_init(&temp, d->cap);
+	BC_NUM_INIT(&temp, d->cap);
 
 	BC_SETJMP_LOCKED(vm, err);
 
@@ -1992,7 +2151,7 @@ bc_num_r(BcNum* a, BcNum* b, BcNum* restrict c, BcNum* restrict d, size_t scale,
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&temp);
+	BC_NUM_FREE(&temp);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -2019,7 +2178,7 @@ bc_num_rem(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	BC_SIG_LOCK;
 
 	// Need a temp for the quotient.
-	bc_num_init(&c1, bc_num_mulReq(a, b, ts));
+	BC_NUM_INIT(&c1, bc_num_mulReq(a, b, ts));
 
 	BC_SETJMP_LOCKED(vm, err);
 
@@ -2029,7 +2188,7 @@ bc_num_rem(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&c1);
+	BC_NUM_FREE(&c1);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -2111,6 +2270,8 @@ bc_num_p(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	// reaches the first time where the square is actually used.
 	for (powrdx = a->scale; !(exp & 1); exp >>= 1)
 	{
+		BC_NUM_POLL;
+
 		powrdx <<= 1;
 		assert(BC_NUM_RDX_VALID_NP(copy));
 		bc_num_mul(&copy, &copy, &copy, powrdx);
@@ -2125,6 +2286,8 @@ bc_num_p(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 	// as necessary.
 	while (exp >>= 1)
 	{
+		BC_NUM_POLL;
+
 		powrdx <<= 1;
 		assert(BC_NUM_RDX_VALID_NP(copy));
 		bc_num_mul(&copy, &copy, &copy, powrdx);
@@ -2150,7 +2313,7 @@ bc_num_p(BcNum* a, BcNum* b, BcNum* restrict c, size_t scale)
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&copy);
+	BC_NUM_FREE(&copy);
 	BC_LONGJMP_CONT(vm);
 }
 
@@ -2235,7 +2398,7 @@ bc_num_binary(BcNum* a, BcNum* b, BcNum* c, size_t scale, BcNumBinOp op,
 	BcNum* ptr_b;
 	BcNum num2;
 #if BC_ENABLE_LIBRARY
-	BcVm* vm = NULL;
+	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
 
 	assert(a != NULL && b != NULL && c != NULL && op != NULL);
@@ -2252,14 +2415,10 @@ bc_num_binary(BcNum* a, BcNum* b, BcNum* c, size_t scale, BcNumBinOp op,
 	// very least.
 	if (c == a || c == b)
 	{
-#if BC_ENABLE_LIBRARY
-		vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
-
 		// NOLINTNEXTLINE
 		memcpy(&num2, c, sizeof(BcNum));
 
-		bc_num_init(c, req);
+		BC_NUM_INIT(c, req);
 
 		// Must prepare for cleanup. We want this here so that locals that got
 		// set stay set since a longjmp() is not guaranteed to preserve locals.
@@ -2269,7 +2428,7 @@ bc_num_binary(BcNum* a, BcNum* b, BcNum* c, size_t scale, BcNumBinOp op,
 	else
 	{
 		BC_SIG_UNLOCK;
-		bc_num_expand(c, req);
+		BC_NUM_EXPAND(c, req);
 	}
 
 	// It is okay for a and b to be the same. If a binary operator function does
@@ -2289,2115 +2448,4860 @@ err:
 	if (c == a || c == b)
 	{
 		BC_SIG_MAYLOCK;
-		bc_num_free(&num2);
+		BC_NUM_FREE(&num2);
 		BC_LONGJMP_CONT(vm);
 	}
 }
 
 /**
- * Tests a number string for validity. This function has a history; I originally
- * wrote it because I did not trust my parser. Over time, however, I came to
- * trust it, so I was able to relegate this function to debug builds only, and I
- * used it in assert()'s. But then I created the library, and well, I can't
- * trust users, so I reused this for yelling at users.
- * @param val  The string to check to see if it's a valid number string.
- * @return     True if the string is a valid number string, false otherwise.
+ * Returns the number of bits needed to hold @a val.
+ * @param val  The value.
+ * @return     The number of bits needed to hold @a val; 0 if @a val is 0.
  */
-bool
-bc_num_strValid(const char* restrict val)
+static size_t
+bc_num_bitLen(BcBigDig val)
 {
-	bool radix = false;
-	size_t i, len = strlen(val);
+	size_t bits;
 
-	// Notice that I don't check if there is a negative sign. That is not part
-	// of a valid number, except in the library. The library-specific code takes
-	// care of that part.
+	for (bits = 0; val; ++bits)
+	{
+		val >>= 1;
+	}
 
-	// Nothing in the string is okay.
-	if (!len) return true;
+	return bits;
+}
 
-	// Loop through the characters.
-	for (i = 0; i < len; ++i)
+/**
+ * Converts the integer part of a number into its binary form: an array of
+ * words of BC_NUM_BIN_BITS bits each, least significant first. The conversion
+ * is a multiply-add of each limb into the words, which only needs shifts and
+ * masks instead of the divisions that other bases need.
+ * @param n    The number to convert. Its sign is ignored.
+ * @param bin  The vector to put the words into. It must be a vector of
+ *             BcBigDig's, and it will have no leading zero words.
+ */
+static void
+bc_num_toBin(const BcNum* restrict n, BcVec* restrict bin)
+{
+	size_t i, j, len = 0, rdx = BC_NUM_RDX_VAL(n);
+	BcBigDig* words;
+
+	assert(bin->size == sizeof(BcBigDig));
+
+	bc_vec_popAll(bin);
+
+	if (n->len <= rdx) return;
+
+	// Each limb of BC_BASE_DIGS decimal digits needs fewer than
+	// BC_NUM_BIN_BITS bits, so this is always enough.
+	bc_vec_expand(bin, n->len - rdx + 1);
+	words = (BcBigDig*) bin->v;
+
+	// Go from the most significant limb down.
+	for (i = n->len - 1; i < n->len && i >= rdx; --i)
 	{
-		BcDig c = val[i];
+		BcBigDig carry = (BcBigDig) n->num[i];
 
-		// If we have found a radix point...
-		if (c == '.')
+		// Multiply the words by BC_BASE_POW and add the limb.
+		for (j = 0; j < len; ++j)
 		{
-			// We don't allow two radices.
-			if (radix) return false;
+			BcBigDig t = words[j] * BC_BASE_POW + carry;
 
-			radix = true;
-			continue;
+			words[j] = t & BC_NUM_BIN_MASK;
+			carry = t >> BC_NUM_BIN_BITS;
 		}
 
-		// We only allow digits and uppercase letters.
-		if (!(isdigit(c) || isupper(c))) return false;
+		// Push what's left as new words.
+		while (carry)
+		{
+			assert(len < bin->cap);
+
+			words[len] = carry & BC_NUM_BIN_MASK;
+			carry >>= BC_NUM_BIN_BITS;
+			len += 1;
+		}
 	}
 
-	return true;
+	bin->len = len;
 }
 
 /**
- * Parses one character and returns the digit that corresponds to that
- * character according to the base.
- * @param c     The character to parse.
- * @param base  The base.
- * @return      The character as a digit.
+ * Sets a number to the integer in binary form given by an array of words of
+ * BC_NUM_BIN_BITS bits each, least significant first. This is the reverse of
+ * bc_num_toBin().
+ * @param n      The number to set. It must be zero on entry.
+ * @param words  The words of the binary form.
+ * @param len    The number of words.
  */
-static BcBigDig
-bc_num_parseChar(char c, size_t base)
+static void
+bc_num_fromBin(BcNum* restrict n, const BcBigDig* restrict words, size_t len)
 {
-	assert(isupper(c) || isdigit(c));
+	size_t i, j, req;
 
-	// If a letter...
-	if (isupper(c))
+	assert(BC_NUM_ZERO(n) && !n->scale);
+
+	if (!len) return;
+
+	// Each bit is less than a third of a decimal digit.
+	req = bc_vm_growSize(bc_vm_arraySize(len, BC_NUM_BIN_BITS) / 3, 1);
+	req = bc_vm_growSize(req / BC_BASE_DIGS, 1);
+
+	bc_num_expand(n, req);
+
+	// Go from the most significant word down.
+	for (i = len - 1; i < len; --i)
 	{
-#if BC_ENABLE_LIBRARY
-		BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
+		BcBigDig carry = words[i];
 
-		// This returns the digit that directly corresponds with the letter.
-		c = BC_NUM_NUM_LETTER(c);
+		assert(carry <= BC_NUM_BIN_MASK);
 
-		// If the digit is greater than the base, we clamp.
-		if (BC_DIGIT_CLAMP)
+		// Multiply the limbs by 2^BC_NUM_BIN_BITS and add the word.
+		for (j = 0; j < n->len; ++j)
 		{
-			c = ((size_t) c) >= base ? (char) base - 1 : c;
+			BcBigDig t = (((BcBigDig) n->num[j]) << BC_NUM_BIN_BITS) + carry;
+
+			n->num[j] = (BcDig) (t % BC_BASE_POW);
+			carry = t / BC_BASE_POW;
 		}
-	}
-	// Straight convert the digit to a number.
-	else c -= '0';
 
-	return (BcBigDig) (uchar) c;
+		// Push what's left as new limbs.
+		while (carry)
+		{
+			assert(n->len < n->cap);
+
+			n->num[n->len] = (BcDig) (carry % BC_BASE_POW);
+			carry /= BC_BASE_POW;
+			n->len += 1;
+		}
+	}
 }
 
+#if BC_ENABLE_LIBRARY
+
 /**
- * Parses a string as a decimal number. This is separate because it's going to
- * be the most used, and it can be heavily optimized for decimal only.
- * @param n    The number to parse into and return. Must be preallocated.
- * @param val  The string to parse.
+ * Sets a number to the integer in binary form in a vector of words, trimming
+ * leading zero words first. This is the common tail of the import functions.
+ * @param n    The number to set. It must be preallocated.
+ * @param bin  The vector of words.
  */
 static void
-bc_num_parseDecimal(BcNum* restrict n, const char* restrict val)
+bc_num_importBin(BcNum* restrict n, BcVec* restrict bin)
 {
-	size_t len, i, temp, mod;
-	const char* ptr;
-	bool zero = true, rdx;
-#if BC_ENABLE_LIBRARY
-	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
+	const BcBigDig* words = (const BcBigDig*) bin->v;
 
-	// Eat leading zeroes.
-	for (i = 0; val[i] == '0'; ++i)
+	while (bin->len && !words[bin->len - 1])
 	{
-		continue;
+		bin->len -= 1;
 	}
 
-	val += i;
-	assert(!val[0] || isalnum(val[0]) || val[0] == '.');
-
-	// All 0's. We can just return, since this procedure expects a virgin
-	// (already 0) BcNum.
-	if (!val[0]) return;
+	bc_num_zero(n);
+	bc_num_fromBin(n, words, bin->len);
+}
 
-	// The length of the string is the length of the number, except it might be
-	// one bigger because of a decimal point.
-	len = strlen(val);
+void
+bc_num_importBytes(BcNum* restrict n, const uchar* restrict bytes, size_t len,
+                   bool big)
+{
+	BcVec bin;
+	BcBigDig* words;
+	size_t i;
+	BcVm* vm = bcl_getspecific();
 
-	// Find the location of the decimal point.
-	ptr = strchr(val, '.');
-	rdx = (ptr != NULL);
+	// Bytes never straddle words this way.
+	assert(BC_NUM_BIN_BITS % CHAR_BIT == 0);
 
-	// We eat leading zeroes again. These leading zeroes are different because
-	// they will come after the decimal point if they exist, and since that's
-	// the case, they must be preserved.
-	for (i = 0; i < len && (zero = (val[i] == '0' || val[i] == '.')); ++i)
-	{
-		continue;
-	}
+	BC_SIG_LOCK;
 
-	// Set the scale of the number based on the location of the decimal point.
-	// The casts to uintptr_t is to ensure that bc does not hit undefined
-	// behavior when doing math on the values.
-	n->scale = (size_t) (rdx *
-	                     (((uintptr_t) (val + len)) - (((uintptr_t) ptr) + 1)));
+	bc_vec_init(&bin, sizeof(BcBigDig), BC_DTOR_NONE);
 
-	// Set rdx.
-	BC_NUM_RDX_SET(n, BC_NUM_RDX(n->scale));
+	BC_SETJMP_LOCKED(vm, err);
 
-	// Calculate length. First, the length of the integer, then the number of
-	// digits in the last limb, then the length.
-	i = len - (ptr == val ? 0 : i) - rdx;
-	temp = BC_NUM_ROUND_POW(i);
-	mod = n->scale % BC_BASE_DIGS;
-	i = mod ? BC_BASE_DIGS - mod : 0;
-	n->len = ((temp + i) / BC_BASE_DIGS);
+	BC_SIG_UNLOCK;
 
-	// Expand and zero. The plus extra is in case the lack of clamping causes
-	// the number to overflow the original bounds.
-	bc_num_expand(n, n->len + !BC_DIGIT_CLAMP);
+	bin.len = bc_vm_arraySize(len, CHAR_BIT) / BC_NUM_BIN_BITS + 1;
+	bc_vec_expand(&bin, bin.len);
+	words = (BcBigDig*) bin.v;
 	// NOLINTNEXTLINE
-	memset(n->num, 0, BC_NUM_SIZE(n->len + !BC_DIGIT_CLAMP));
+	memset(words, 0, bin.len * sizeof(BcBigDig));
 
-	if (zero)
+	// Put each byte in place, starting at the least significant.
+	for (i = 0; i < len; ++i)
 	{
-		// I think I can set rdx directly to zero here because n should be a
-		// new number with sign set to false.
-		n->len = n->rdx = 0;
+		BcBigDig byte = (BcBigDig) bytes[big ? len - 1 - i : i];
+		size_t bit = i * CHAR_BIT;
+
+		words[bit / BC_NUM_BIN_BITS] |= byte << (bit % BC_NUM_BIN_BITS);
 	}
-	else
-	{
-		// There is actually stuff to parse if we make it here. Yay...
-		BcBigDig exp, pow;
 
-		assert(i <= BC_NUM_BIGDIG_MAX);
+	bc_num_importBin(n, &bin);
 
-		// The exponent and power.
-		exp = (BcBigDig) i;
-		pow = bc_num_pow10[exp];
+err:
+	BC_SIG_MAYLOCK;
+	bc_vec_free(&bin);
+	BC_LONGJMP_CONT(vm);
+}
 
-		// Parse loop. We parse backwards because numbers are stored little
-		// endian.
-		for (i = len - 1; i < len; --i, ++exp)
-		{
-			char c = val[i];
-
-			// Skip the decimal point.
-			if (c == '.') exp -= 1;
-			else
-			{
-				// The index of the limb.
-				size_t idx = exp / BC_BASE_DIGS;
-				BcBigDig dig;
-
-				if (isupper(c))
-				{
-					// Clamp for the base.
-					if (!BC_DIGIT_CLAMP) c = BC_NUM_NUM_LETTER(c);
-					else c = 9;
-				}
-				else c -= '0';
-
-				// Add the digit to the limb. This takes care of overflow from
-				// lack of clamping.
-				dig = ((BcBigDig) n->num[idx]) + ((BcBigDig) c) * pow;
-				if (dig >= BC_BASE_POW)
-				{
-					// We cannot go over BC_BASE_POW with clamping.
-					assert(!BC_DIGIT_CLAMP);
-
-					n->num[idx + 1] = (BcDig) (dig / BC_BASE_POW);
-					n->num[idx] = (BcDig) (dig % BC_BASE_POW);
-					assert(n->num[idx] >= 0 && n->num[idx] < BC_BASE_POW);
-					assert(n->num[idx + 1] >= 0 &&
-					       n->num[idx + 1] < BC_BASE_POW);
-				}
-				else
-				{
-					n->num[idx] = (BcDig) dig;
-					assert(n->num[idx] >= 0 && n->num[idx] < BC_BASE_POW);
-				}
-
-				// Adjust the power and exponent.
-				if ((exp + 1) % BC_BASE_DIGS == 0) pow = 1;
-				else pow *= BC_BASE;
-			}
-		}
-	}
-
-	// Make sure to add one to the length if needed from lack of clamping.
-	n->len += (!BC_DIGIT_CLAMP && n->num[n->len] != 0);
-}
-
-/**
- * Parse a number in any base (besides decimal).
- * @param n     The number to parse into and return. Must be preallocated.
- * @param val   The string to parse.
- * @param base  The base to parse as.
- */
-static void
-bc_num_parseBase(BcNum* restrict n, const char* restrict val, BcBigDig base)
+void
+bc_num_importWords(BcNum* restrict n, const uint64_t* restrict words,
+                   size_t len)
 {
-	BcNum temp, mult1, mult2, result1, result2;
-	BcNum* m1;
-	BcNum* m2;
-	BcNum* ptr;
-	char c = 0;
-	bool zero = true;
-	BcBigDig v;
-	size_t digs, len = strlen(val);
-	// This is volatile to quiet a warning on GCC about longjmp() clobbering.
-	volatile size_t i;
-#if BC_ENABLE_LIBRARY
+	BcVec bin;
+	BcBigDig* bwords;
+	size_t i, j, per = 64 / BC_NUM_BIN_BITS;
 	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
-
-	// If zero, just return because the number should be virgin (already 0).
-	for (i = 0; zero && i < len; ++i)
-	{
-		zero = (val[i] == '.' || val[i] == '0');
-	}
-	if (zero) return;
 
 	BC_SIG_LOCK;
 
-	bc_num_init(&temp, BC_NUM_BIGDIG_LOG10);
-	bc_num_init(&mult1, BC_NUM_BIGDIG_LOG10);
+	bc_vec_init(&bin, sizeof(BcBigDig), BC_DTOR_NONE);
 
-	BC_SETJMP_LOCKED(vm, int_err);
+	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	// We split parsing into parsing the integer and parsing the fractional
-	// part.
+	bin.len = bc_vm_arraySize(len, per);
+	bc_vec_expand(&bin, bin.len);
+	bwords = (BcBigDig*) bin.v;
 
-	// Parse the integer part. This is the easy part because we just multiply
-	// the number by the base, then add the digit.
-	for (i = 0; i < len && (c = val[i]) && c != '.'; ++i)
+	// Split each word into binary form words.
+	for (i = 0; i < len; ++i)
 	{
-		// Convert the character to a digit.
-		v = bc_num_parseChar(c, base);
-
-		// Multiply the number.
-		bc_num_mulArray(n, base, &mult1);
+		for (j = 0; j < per; ++j)
+		{
+			uint64_t w = words[i] >> (j * BC_NUM_BIN_BITS);
 
-		// Convert the digit to a number and add.
-		bc_num_bigdig2num(&temp, v);
-		bc_num_add(&mult1, &temp, n, 0);
+			bwords[i * per + j] = (BcBigDig) (w & BC_NUM_BIN_MASK);
+		}
 	}
 
-	// If this condition is true, then we are done. We still need to do cleanup
-	// though.
-	if (i == len && !val[i]) goto int_err;
-
-	// If we get here, we *must* be at the radix point.
-	assert(val[i] == '.');
-
-	BC_SIG_LOCK;
-
-	// Unset the jump to reset in for these new initializations.
-	BC_UNSETJMP(vm);
-
-	bc_num_init(&mult2, BC_NUM_BIGDIG_LOG10);
-	bc_num_init(&result1, BC_NUM_DEF_SIZE);
-	bc_num_init(&result2, BC_NUM_DEF_SIZE);
-	bc_num_one(&mult1);
-
-	BC_SETJMP_LOCKED(vm, err);
-
-	BC_SIG_UNLOCK;
+	bc_num_importBin(n, &bin);
 
-	// Pointers for easy switching.
-	m1 = &mult1;
-	m2 = &mult2;
+err:
+	BC_SIG_MAYLOCK;
+	bc_vec_free(&bin);
+	BC_LONGJMP_CONT(vm);
+}
 
-	// Parse the fractional part. This is the hard part.
-	for (i += 1, digs = 0; i < len && (c = val[i]); ++i, ++digs)
-	{
-		size_t rdx;
+size_t
+bc_num_exportBytes(const BcNum* restrict n, uchar* restrict buf, size_t cap,
+                   bool big)
+{
+	BcVec bin;
+	const BcBigDig* words;
+	size_t i, needed = 0;
+	BcVm* vm = bcl_getspecific();
 
-		// Convert the character to a digit.
-		v = bc_num_parseChar(c, base);
+	assert(BC_NUM_BIN_BITS % CHAR_BIT == 0);
 
-		// We keep growing result2 according to the base because the more digits
-		// after the radix, the more significant the digits close to the radix
-		// should be.
-		bc_num_mulArray(&result1, base, &result2);
+	if (BC_ERR(BC_NUM_NEG(n))) bc_err(BC_ERR_MATH_NEGATIVE);
 
-		// Convert the digit to a number.
-		bc_num_bigdig2num(&temp, v);
+	BC_SIG_LOCK;
 
-		// Add the digit into the fraction part.
-		bc_num_add(&result2, &temp, &result1, 0);
+	bc_vec_init(&bin, sizeof(BcBigDig), BC_DTOR_NONE);
 
-		// Keep growing m1 and m2 for use after the loop.
-		bc_num_mulArray(m1, base, m2);
+	BC_SETJMP_LOCKED(vm, err);
 
-		rdx = BC_NUM_RDX_VAL(m2);
+	BC_SIG_UNLOCK;
 
-		if (m2->len < rdx) m2->len = rdx;
+	bc_num_toBin(n, &bin);
 
-		// Switch.
-		ptr = m1;
-		m1 = m2;
-		m2 = ptr;
-	}
+	if (!bin.len) goto err;
 
-	// This one cannot be a divide by 0 because mult starts out at 1, then is
-	// multiplied by base, and base cannot be 0, so mult cannot be 0. And this
-	// is the reason we keep growing m1 and m2; this division is what converts
-	// the parsed fractional part from an integer to a fractional part.
-	bc_num_div(&result1, m1, &result2, digs * 2);
+	words = (const BcBigDig*) bin.v;
 
-	// Pretruncate.
-	bc_num_truncate(&result2, digs);
+	// The number of bytes is found from the number of bits.
+	needed = (bin.len - 1) * BC_NUM_BIN_BITS;
+	needed += bc_num_bitLen(words[bin.len - 1]);
+	needed = (needed + CHAR_BIT - 1) / CHAR_BIT;
 
-	// The final add of the integer part to the fractional part.
-	bc_num_add(n, &result2, n, digs);
+	if (needed > cap) goto err;
 
-	// Basic cleanup.
-	if (BC_NUM_NONZERO(n))
+	// Take each byte out, starting at the least significant.
+	for (i = 0; i < needed; ++i)
 	{
-		if (n->scale < digs) bc_num_extend(n, digs - n->scale);
+		size_t bit = i * CHAR_BIT;
+		BcBigDig byte = words[bit / BC_NUM_BIN_BITS] >> (bit % BC_NUM_BIN_BITS);
+
+		buf[big ? needed - 1 - i : i] = (uchar) (byte & UCHAR_MAX);
 	}
-	else bc_num_zero(n);
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&result2);
-	bc_num_free(&result1);
-	bc_num_free(&mult2);
-int_err:
-	BC_SIG_MAYLOCK;
-	bc_num_free(&mult1);
-	bc_num_free(&temp);
+	bc_vec_free(&bin);
 	BC_LONGJMP_CONT(vm);
+
+	return needed;
 }
 
+#endif // BC_ENABLE_LIBRARY
+
 /**
- * Prints a backslash+newline combo if the number of characters needs it. This
- * is really a convenience function.
+ * Loads eight characters into a 64-bit integer, the first in the least
+ * significant byte. This is written out so that it does not depend on the
+ * endianness of the machine; compilers turn it into one load where they can.
+ * @param str  The characters to load. There must be at least eight.
+ * @return     The characters as one 64-bit integer.
  */
-static inline void
-bc_num_printNewline(void)
+static inline uint64_t
+bc_num_load8(const char* restrict str)
 {
-#if !BC_ENABLE_LIBRARY
-	if (vm->nchars >= vm->line_len - 1 && vm->line_len)
-	{
-		bc_vm_putchar('\\', bc_flush_none);
-		bc_vm_putchar('\n', bc_flush_err);
-	}
-#endif // !BC_ENABLE_LIBRARY
+	const uchar* s = (const uchar*) str;
+
+	return ((uint64_t) s[0]) | ((uint64_t) s[1] << 8) |
+	       ((uint64_t) s[2] << 16) | ((uint64_t) s[3] << 24) |
+	       ((uint64_t) s[4] << 32) | ((uint64_t) s[5] << 40) |
+	       ((uint64_t) s[6] << 48) | ((uint64_t) s[7] << 56);
 }
 
 /**
- * Prints a character after a backslash+newline, if needed.
- * @param c       The character to print.
- * @param bslash  Whether to print a backslash+newline.
+ * Returns true if all eight characters packed into @a v are decimal digits. A
+ * digit has a high nibble of 3, and it still does after adding 6.
+ * @param v  The characters packed by bc_num_load8().
+ * @return   True if all of the characters are decimal digits.
  */
-static void
-bc_num_putchar(int c, bool bslash)
+static inline bool
+bc_num_digits8(uint64_t v)
 {
-	if (c != '\n' && bslash) bc_num_printNewline();
-	bc_vm_putchar(c, bc_flush_save);
-}
+	uint64_t hi = UINT64_C(0xF0F0F0F0F0F0F0F0);
+	uint64_t threes = UINT64_C(0x3030303030303030);
 
-#if !BC_ENABLE_LIBRARY
+	return (v & hi) == threes &&
+	       ((v + UINT64_C(0x0606060606060606)) & hi) == threes;
+}
 
 /**
- * Prints a character for a number's digit. This is for printing for dc's P
- * command. This function does not need to worry about radix points. This is a
- * BcNumDigitOp.
- * @param n       The "digit" to print.
- * @param len     The "length" of the digit, or number of characters that will
- *                need to be printed for the digit.
- * @param rdx     True if a decimal (radix) point should be printed.
- * @param bslash  True if a backslash+newline should be printed if the character
- *                limit for the line is reached, false otherwise.
+ * Converts eight decimal digits packed by bc_num_load8() into their value. This
+ * combines neighboring digits, then pairs, then quads, with multiplies instead
+ * of doing one digit at a time.
+ * @param v  The characters packed by bc_num_load8(). They must all be digits.
+ * @return   The value of the eight digits.
  */
-static void
-bc_num_printChar(size_t n, size_t len, bool rdx, bool bslash)
+static inline uint64_t
+bc_num_parse8(uint64_t v)
 {
-	BC_UNUSED(rdx);
-	BC_UNUSED(len);
-	BC_UNUSED(bslash);
-	assert(len == 1);
-	bc_vm_putchar((uchar) n, bc_flush_save);
-}
+	uint64_t mask = UINT64_C(0x000000FF000000FF);
+	uint64_t mul1 = UINT64_C(100) + (UINT64_C(1000000) << 32);
+	uint64_t mul2 = UINT64_C(1) + (UINT64_C(10000) << 32);
 
-#endif // !BC_ENABLE_LIBRARY
+	v -= UINT64_C(0x3030303030303030);
+	v = (v * 10) + (v >> 8);
+	v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+
+	return v;
+}
 
 /**
- * Prints a series of characters for large bases. This is for printing in bases
- * above hexadecimal. This is a BcNumDigitOp.
- * @param n       The "digit" to print.
- * @param len     The "length" of the digit, or number of characters that will
- *                need to be printed for the digit.
- * @param rdx     True if a decimal (radix) point should be printed.
- * @param bslash  True if a backslash+newline should be printed if the character
- *                limit for the line is reached, false otherwise.
+ * Converts BC_BASE_DIGS decimal digits, most significant first, into a limb.
+ * @param str  The digits. They must all be decimal digits.
+ * @return     The limb.
  */
-static void
-bc_num_printDigits(size_t n, size_t len, bool rdx, bool bslash)
+static BcDig
+bc_num_parseLimb(const char* restrict str)
 {
-	size_t exp, pow;
-
-	// If needed, print the radix; otherwise, print a space to separate digits.
-	bc_num_putchar(rdx ? '.' : ' ', true);
+#if BC_BASE_DIGS == 9
+	uint64_t v = bc_num_parse8(bc_num_load8(str)) * 10;
+	return (BcDig) (v + (uint64_t) (str[8] - '0'));
+#else // BC_BASE_DIGS == 9
+	size_t i;
+	BcDig dig = 0;
 
-	// Calculate the exponent and power.
-	for (exp = 0, pow = 1; exp < len - 1; ++exp, pow *= BC_BASE)
+	for (i = 0; i < BC_BASE_DIGS; ++i)
 	{
-		continue;
+		dig = (BcDig) (dig * BC_BASE + (str[i] - '0'));
 	}
 
-	// Print each character individually.
-	for (exp = 0; exp < len; pow /= BC_BASE, ++exp)
-	{
-		// The individual subdigit.
-		size_t dig = n / pow;
-
-		// Take the subdigit away.
-		n -= dig * pow;
-
-		// Print the subdigit.
-		bc_num_putchar(((uchar) dig) + '0', bslash || exp != len - 1);
-	}
+	return dig;
+#endif // BC_BASE_DIGS == 9
 }
 
-/**
- * Prints a character for a number's digit. This is for printing in bases for
- * hexadecimal and below because they always print only one character at a time.
- * This is a BcNumDigitOp.
- * @param n       The "digit" to print.
- * @param len     The "length" of the digit, or number of characters that will
- *                need to be printed for the digit.
- * @param rdx     True if a decimal (radix) point should be printed.
- * @param bslash  True if a backslash+newline should be printed if the character
- *                limit for the line is reached, false otherwise.
- */
-static void
-bc_num_printHex(size_t n, size_t len, bool rdx, bool bslash)
+size_t
+bc_num_digitRun(const char* restrict str, size_t len)
 {
-	BC_UNUSED(len);
-	BC_UNUSED(bslash);
+	size_t i = 0;
 
-	assert(len == 1);
+	// Eight at a time...
+	while (len - i >= 8 && bc_num_digits8(bc_num_load8(str + i)))
+	{
+		i += 8;
+	}
 
-	if (rdx) bc_num_putchar('.', true);
+	// ...then one at a time.
+	while (i < len && str[i] >= '0' && str[i] <= '9')
+	{
+		i += 1;
+	}
 
-	bc_num_putchar(bc_num_hex_digits[n], bslash);
+	return i;
 }
 
 /**
- * Prints a decimal number. This is specially written for optimization since
- * this will be used the most and because bc's numbers are already in decimal.
- * @param n        The number to print.
- * @param newline  Whether to print backslash+newlines on long enough lines.
- */
-static void
-bc_num_printDecimal(const BcNum* restrict n, bool newline)
+ * Tests a number string for validity. This function has a history; I originally
+ * wrote it because I did not trust my parser. Over time, however, I came to
+ * trust it, so I was able to relegate this function to debug builds only, and I
+ * used it in assert()'s. But then I created the library, and well, I can't
+ * trust users, so I reused this for yelling at users.
+ * @param val  The string to check to see if it's a valid number string.
+ * @param len  The length of @a val.
+ * @return     True if the string is a valid number string, false otherwise.
+ */
+bool
+bc_num_strValid(const char* restrict val, size_t len)
 {
-	size_t i, j, rdx = BC_NUM_RDX_VAL(n);
-	bool zero = true;
-	size_t buffer[BC_BASE_DIGS];
+	bool radix = false;
+	size_t i;
 
-	// Print loop.
-	for (i = n->len - 1; i < n->len; --i)
+	// Notice that I don't check if there is a negative sign. That is not part
+	// of a valid number, except in the library. The library-specific code takes
+	// care of that part.
+
+	// Nothing in the string is okay.
+	if (!len) return true;
+
+	// Loop through the characters.
+	for (i = 0; i < len; ++i)
 	{
-		BcDig n9 = n->num[i];
-		size_t temp;
-		bool irdx = (i == rdx - 1);
+		BcDig c;
 
-		// Calculate the number of digits in the limb.
-		zero = (zero & !irdx);
-		temp = n->scale % BC_BASE_DIGS;
-		temp = i || !temp ? 0 : BC_BASE_DIGS - temp;
+		// Skip runs of decimal digits quickly.
+		i += bc_num_digitRun(val + i, len - i);
+		if (i == len) break;
 
-		// NOLINTNEXTLINE
-		memset(buffer, 0, BC_BASE_DIGS * sizeof(size_t));
+		c = val[i];
 
-		// Fill the buffer with individual digits.
-		for (j = 0; n9 && j < BC_BASE_DIGS; ++j)
+		// If we have found a radix point...
+		if (c == '.')
 		{
-			buffer[j] = ((size_t) n9) % BC_BASE;
-			n9 /= BC_BASE;
+			// We don't allow two radices.
+			if (radix) return false;
+
+			radix = true;
+			continue;
 		}
 
-		// Print the digits in the buffer.
-		for (j = BC_BASE_DIGS - 1; j < BC_BASE_DIGS && j >= temp; --j)
-		{
-			// Figure out whether to print the decimal point.
-			bool print_rdx = (irdx & (j == BC_BASE_DIGS - 1));
+		// We only allow digits and uppercase letters.
+		if (!(isdigit(c) || isupper(c))) return false;
+	}
 
-			// The zero variable helps us skip leading zero digits in the limb.
-			zero = (zero && buffer[j] == 0);
+	return true;
+}
 
-			if (!zero)
-			{
-				// While the first three arguments should be self-explanatory,
-				// the last needs explaining. I don't want to print a newline
-				// when the last digit to be printed could take the place of the
-				// backslash rather than being pushed, as a single character, to
-				// the next line. That's what that last argument does for bc.
-				bc_num_printHex(buffer[j], 1, print_rdx,
-				                !newline || (j > temp || i != 0));
-			}
+/**
+ * Parses one character and returns the digit that corresponds to that
+ * character according to the base.
+ * @param c     The character to parse.
+ * @param base  The base.
+ * @return      The character as a digit.
+ */
+static BcBigDig
+bc_num_parseChar(char c, size_t base)
+{
+	assert(isupper(c) || isdigit(c));
+
+	// If a letter...
+	if (isupper(c))
+	{
+#if BC_ENABLE_LIBRARY
+		BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+		// This returns the digit that directly corresponds with the letter.
+		c = BC_NUM_NUM_LETTER(c);
+
+		// If the digit is greater than the base, we clamp.
+		if (BC_DIGIT_CLAMP)
+		{
+			c = ((size_t) c) >= base ? (char) base - 1 : c;
 		}
 	}
-}
+	// Straight convert the digit to a number.
+	else c -= '0';
 
-#if BC_ENABLE_EXTRA_MATH
+	return (BcBigDig) (uchar) c;
+}
 
 /**
- * Prints a number in scientific or engineering format. When doing this, we are
- * always printing in decimal.
- * @param n        The number to print.
- * @param eng      True if we are in engineering mode.
- * @param newline  Whether to print backslash+newlines on long enough lines.
+ * Parses a string as a decimal number. This is separate because it's going to
+ * be the most used, and it can be heavily optimized for decimal only.
+ * @param n    The number to parse into and return. Must be preallocated.
+ * @param val  The string to parse.
+ * @param len  The length of @a val.
  */
 static void
-bc_num_printExponent(const BcNum* restrict n, bool eng, bool newline)
+bc_num_parseDecimal(BcNum* restrict n, const char* restrict val, size_t len)
 {
-	size_t places, mod, nrdx = BC_NUM_RDX_VAL(n);
-	bool neg = (n->len <= nrdx);
-	BcNum temp, exp;
-	BcDig digs[BC_NUM_BIGDIG_LOG10];
+	size_t i, temp, mod, dot;
+	const char* ptr;
+	bool zero = true, rdx;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
 
-	BC_SIG_LOCK;
+	// Eat leading zeroes.
+	for (i = 0; i < len && val[i] == '0'; ++i)
+	{
+		continue;
+	}
 
-	bc_num_createCopy(&temp, n);
+	// All 0's. We can just return, since this procedure expects a virgin
+	// (already 0) BcNum.
+	if (i == len) return;
 
-	BC_SETJMP_LOCKED(vm, exit);
+	// The length of the string is the length of the number, except it might be
+	// one bigger because of a decimal point.
+	val += i;
+	len -= i;
+	assert(isalnum(val[0]) || val[0] == '.');
 
-	BC_SIG_UNLOCK;
+	// Find the location of the decimal point.
+	ptr = memchr(val, '.', len);
+	rdx = (ptr != NULL);
+	dot = rdx ? (size_t) (ptr - val) : len;
 
-	// We need to calculate the exponents, and they change based on whether the
-	// number is all fractional or not, obviously.
-	if (neg)
+	// We eat leading zeroes again. These leading zeroes are different because
+	// they will come after the decimal point if they exist, and since that's
+	// the case, they must be preserved.
+	for (i = 0; i < len && (zero = (val[i] == '0' || val[i] == '.')); ++i)
 	{
-		// Figure out how many limbs after the decimal point is zero.
-		size_t i, idx = bc_num_nonZeroLen(n) - 1;
+		continue;
+	}
 
-		places = 1;
+	// Set the scale of the number based on the location of the decimal point.
+	// The casts to uintptr_t is to ensure that bc does not hit undefined
+	// behavior when doing math on the values.
+	n->scale = (size_t) (rdx *
+	                     (((uintptr_t) (val + len)) - (((uintptr_t) ptr) + 1)));
 
-		// Figure out how much in the last limb is zero.
-		for (i = BC_BASE_DIGS - 1; i < BC_BASE_DIGS; --i)
-		{
-			if (bc_num_pow10[i] > (BcBigDig) n->num[idx]) places += 1;
-			else break;
-		}
+	// Set rdx.
+	BC_NUM_RDX_SET(n, BC_NUM_RDX(n->scale));
 
-		// Calculate the combination of zero limbs and zero digits in the last
-		// limb.
-		places += (nrdx - (idx + 1)) * BC_BASE_DIGS;
-		mod = places % 3;
+	// Calculate length. First, the length of the integer, then the number of
+	// digits in the last limb, then the length.
+	i = len - (ptr == val ? 0 : i) - rdx;
+	temp = BC_NUM_ROUND_POW(i);
+	mod = n->scale % BC_BASE_DIGS;
+	i = mod ? BC_BASE_DIGS - mod : 0;
+	n->len = ((temp + i) / BC_BASE_DIGS);
 
-		// Calculate places if we are in engineering mode.
-		if (eng && mod != 0) places += 3 - mod;
+	// Expand and zero. The plus extra is in case the lack of clamping causes
+	// the number to overflow the original bounds.
+	BC_NUM_EXPAND(n, n->len + !BC_DIGIT_CLAMP);
+	// NOLINTNEXTLINE
+	memset(n->num, 0, BC_NUM_SIZE(n->len + !BC_DIGIT_CLAMP));
 
-		// Shift the temp to the right place.
-		bc_num_shiftLeft(&temp, places);
+	if (zero)
+	{
+		// I think I can set rdx directly to zero here because n should be a
+		// new number with sign set to false.
+		n->len = n->rdx = 0;
 	}
-	else
+	else if (bc_num_digitRun(val, dot) == dot &&
+	         (!rdx || bc_num_digitRun(ptr + 1, len - dot - 1) == len - dot - 1))
 	{
-		// This is the number of digits that we are supposed to put behind the
-		// decimal point.
-		places = bc_num_intDigits(n) - 1;
+		// If there are only decimal digits (and the radix point), every limb
+		// can be converted in one go.
+		size_t idx, end = len;
 
-		// Calculate the true number based on whether engineering mode is
-		// activated.
-		mod = places % 3;
-		if (eng && mod != 0) places -= 3 - (3 - mod);
+		for (idx = 0; idx < n->len; ++idx)
+		{
+			char digs[BC_BASE_DIGS];
 
-		// Shift the temp to the right place.
-		bc_num_shiftRight(&temp, places);
-	}
+			// The number of digits to take from the string. The rest of the
+			// first limb is the zeroes that fill out the scale.
+			size_t k = BC_BASE_DIGS - (idx ? 0 : i);
 
-	// Print the shifted number.
-	bc_num_printDecimal(&temp, newline);
+			// NOLINTNEXTLINE
+			memset(digs + k, '0', BC_BASE_DIGS - k);
 
-	// Print the e.
-	bc_num_putchar('e', !newline);
+			// If the digits are all together, just copy them. Otherwise, we are
+			// at the radix point or the start, so go one at a time.
+			if (end >= k && (dot >= end || dot < end - k))
+			{
+				// NOLINTNEXTLINE
+				memcpy(digs, val + end - k, k);
+				end -= k;
+			}
+			else
+			{
+				while (k && end)
+				{
+					char c = val[--end];
+					if (c != '.') digs[--k] = c;
+				}
 
-	// Need to explicitly print a zero exponent.
-	if (!places)
-	{
-		bc_num_printHex(0, 1, false, !newline);
-		goto exit;
+				// NOLINTNEXTLINE
+				memset(digs, '0', k);
+			}
+
+			n->num[idx] = bc_num_parseLimb(digs);
+			assert(n->num[idx] >= 0 && n->num[idx] < BC_BASE_POW);
+		}
 	}
+	else
+	{
+		// There is actually stuff to parse if we make it here. Yay...
+		BcBigDig exp, pow;
 
-	// Need to print sign for the exponent.
-	if (neg) bc_num_putchar('-', true);
+		assert(i <= BC_NUM_BIGDIG_MAX);
 
-	// Create a temporary for the exponent...
-	bc_num_setup(&exp, digs, BC_NUM_BIGDIG_LOG10);
-	bc_num_bigdig2num(&exp, (BcBigDig) places);
+		// The exponent and power.
+		exp = (BcBigDig) i;
+		pow = bc_num_pow10[exp];
 
-	/// ..and print it.
-	bc_num_printDecimal(&exp, newline);
+		// Parse loop. We parse backwards because numbers are stored little
+		// endian.
+		for (i = len - 1; i < len; --i, ++exp)
+		{
+			char c = val[i];
 
-exit:
-	BC_SIG_MAYLOCK;
-	bc_num_free(&temp);
-	BC_LONGJMP_CONT(vm);
-}
-#endif // BC_ENABLE_EXTRA_MATH
+			// Skip the decimal point.
+			if (c == '.') exp -= 1;
+			else
+			{
+				// The index of the limb.
+				size_t idx = exp / BC_BASE_DIGS;
+				BcBigDig dig;
 
-/**
- * Takes a number with limbs with base BC_BASE_POW and converts the limb at the
- * given index to base @a pow, where @a pow is obase^N.
- * @param n    The number to convert.
- * @param rem  BC_BASE_POW - @a pow.
- * @param pow  The power of obase we will convert the number to.
- * @param idx  The index of the number to start converting at. Doing the
- *             conversion is O(n^2); we have to sweep through starting at the
- *             least significant limb.
- */
-static void
-bc_num_printFixup(BcNum* restrict n, BcBigDig rem, BcBigDig pow, size_t idx)
-{
-	size_t i, len = n->len - idx;
-	BcBigDig acc;
-	BcDig* a = n->num + idx;
+				if (isupper(c))
+				{
+					// Clamp for the base.
+					if (!BC_DIGIT_CLAMP) c = BC_NUM_NUM_LETTER(c);
+					else c = 9;
+				}
+				else c -= '0';
 
-	// Ignore if there's just one limb left. This is the part that requires the
-	// extra loop after the one calling this function in bc_num_printPrepare().
-	if (len < 2) return;
+				// Add the digit to the limb. This takes care of overflow from
+				// lack of clamping.
+				dig = ((BcBigDig) n->num[idx]) + ((BcBigDig) c) * pow;
+				if (dig >= BC_BASE_POW)
+				{
+					// We cannot go over BC_BASE_POW with clamping.
+					assert(!BC_DIGIT_CLAMP);
 
-	// Loop through the remaining limbs and convert. We start at the second limb
+					n->num[idx + 1] = (BcDig) (dig / BC_BASE_POW);
+					n->num[idx] = (BcDig) (dig % BC_BASE_POW);
+					assert(n->num[idx] >= 0 && n->num[idx] < BC_BASE_POW);
+					assert(n->num[idx + 1] >= 0 &&
+					       n->num[idx + 1] < BC_BASE_POW);
+				}
+				else
+				{
+					n->num[idx] = (BcDig) dig;
+					assert(n->num[idx] >= 0 && n->num[idx] < BC_BASE_POW);
+				}
+
+				// Adjust the power and exponent.
+				if ((exp + 1) % BC_BASE_DIGS == 0) pow = 1;
+				else pow *= BC_BASE;
+			}
+		}
+	}
+
+	// Make sure to add one to the length if needed from lack of clamping.
+	n->len += (!BC_DIGIT_CLAMP && n->num[n->len] != 0);
+}
+
+/**
+ * Parses the integer part of a number string in a power of two base by putting
+ * the bits of each digit directly into the binary form of the number, then
+ * converting it all at once. This only works if all digits are less than the
+ * base; if they are not, nothing is done.
+ * @param n     The number to parse into and return. Must be preallocated and
+ *              zero.
+ * @param val   The string to parse.
+ * @param len   The length of the integer part of @a val.
+ * @param base  The base to parse as. Must be a power of two.
+ * @return      True if the integer part was parsed, false if there was a digit
+ *              that was too big.
+ */
+static bool
+bc_num_parseBin(BcNum* restrict n, const char* restrict val, size_t len,
+                BcBigDig base)
+{
+	BcVec bin;
+	BcBigDig* words;
+	size_t i, bits, total;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(BC_NUM_POW2(base));
+
+	// Unclamped digits can be bigger than the base and carry into the next
+	// digit, so those have to take the slow path.
+	for (i = 0; i < len; ++i)
+	{
+		if (bc_num_parseChar(val[i], base) >= base) return false;
+	}
+
+	bits = bc_num_bitLen(base - 1);
+	total = bc_vm_arraySize(len, bits);
+
+	BC_SIG_LOCK;
+
+	bc_vec_init(&bin, sizeof(BcBigDig), BC_DTOR_NONE);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// Make a zeroed array of words big enough for all of the bits.
+	bc_vec_expand(&bin, total / BC_NUM_BIN_BITS + 1);
+	bin.len = total / BC_NUM_BIN_BITS + 1;
+	words = (BcBigDig*) bin.v;
+	// NOLINTNEXTLINE
+	memset(words, 0, bin.len * sizeof(BcBigDig));
+
+	// Put the bits of each digit in place, starting at the least significant.
+	for (i = 0; i < len; ++i)
+	{
+		BcBigDig dig = bc_num_parseChar(val[len - 1 - i], base);
+		size_t bit = i * bits, idx = bit / BC_NUM_BIN_BITS;
+		size_t shift = bit % BC_NUM_BIN_BITS;
+
+		words[idx] |= (dig << shift) & BC_NUM_BIN_MASK;
+
+		// The digit may straddle two words.
+		if (shift + bits > BC_NUM_BIN_BITS)
+		{
+			words[idx + 1] |= dig >> (BC_NUM_BIN_BITS - shift);
+		}
+	}
+
+	// Trim leading zero words.
+	while (bin.len && !words[bin.len - 1])
+	{
+		bin.len -= 1;
+	}
+
+	bc_num_fromBin(n, words, bin.len);
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_vec_free(&bin);
+	BC_LONGJMP_CONT(vm);
+
+	return true;
+}
+
+/**
+ * Parse a number in any base (besides decimal).
+ * @param n     The number to parse into and return. Must be preallocated.
+ * @param val   The string to parse.
+ * @param len   The length of @a val.
+ * @param base  The base to parse as.
+ */
+static void
+bc_num_parseBase(BcNum* restrict n, const char* restrict val, size_t len,
+                 BcBigDig base)
+{
+	BcNum temp, mult1, mult2, result1, result2;
+	BcNum* m1;
+	BcNum* m2;
+	BcNum* ptr;
+	char c = 0;
+	bool zero = true;
+	BcBigDig v;
+	size_t digs;
+	// This is volatile to quiet a warning on GCC about longjmp() clobbering.
+	volatile size_t i;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	// If zero, just return because the number should be virgin (already 0).
+	for (i = 0; zero && i < len; ++i)
+	{
+		zero = (val[i] == '.' || val[i] == '0');
+	}
+	if (zero) return;
+
+	BC_SIG_LOCK;
+
+	BC_NUM_INIT(&temp, BC_NUM_BIGDIG_LOG10);
+	BC_NUM_INIT(&mult1, BC_NUM_BIGDIG_LOG10);
+
+	BC_SETJMP_LOCKED(vm, int_err);
+
+	BC_SIG_UNLOCK;
+
+	// We split parsing into parsing the integer and parsing the fractional
+	// part.
+
+	// Find the end of the integer part.
+	for (i = 0; i < len && val[i] != '.'; ++i)
+	{
+		continue;
+	}
+
+	// Power of two bases can skip the hard work for the integer part. If that
+	// works, we start the loop below at the end of the integer part.
+	if (!BC_NUM_POW2(base) || !bc_num_parseBin(n, val, i, base)) i = 0;
+
+	// Parse the integer part. This is the easy part because we just multiply
+	// the number by the base, then add the digit.
+	for (; i < len && (c = val[i]) != '.'; ++i)
+	{
+		// Convert the character to a digit.
+		v = bc_num_parseChar(c, base);
+
+		// Multiply the number.
+		bc_num_mulArray(n, base, &mult1);
+
+		// Convert the digit to a number and add.
+		bc_num_bigdig2num(&temp, v);
+		bc_num_add(&mult1, &temp, n, 0);
+	}
+
+	// If this condition is true, then we are done. We still need to do cleanup
+	// though.
+	if (i == len) goto int_err;
+
+	// If we get here, we *must* be at the radix point.
+	assert(val[i] == '.');
+
+	BC_SIG_LOCK;
+
+	// Unset the jump to reset in for these new initializations.
+	BC_UNSETJMP(vm);
+
+	BC_NUM_INIT(&mult2, BC_NUM_BIGDIG_LOG10);
+	BC_NUM_INIT(&result1, BC_NUM_DEF_SIZE);
+	BC_NUM_INIT(&result2, BC_NUM_DEF_SIZE);
+	bc_num_one(&mult1);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// Pointers for easy switching.
+	m1 = &mult1;
+	m2 = &mult2;
+
+	// Parse the fractional part. This is the hard part.
+	for (i += 1, digs = 0; i < len; ++i, ++digs)
+	{
+		size_t rdx;
+
+		c = val[i];
+
+		// Convert the character to a digit.
+		v = bc_num_parseChar(c, base);
+
+		// We keep growing result2 according to the base because the more digits
+		// after the radix, the more significant the digits close to the radix
+		// should be.
+		bc_num_mulArray(&result1, base, &result2);
+
+		// Convert the digit to a number.
+		bc_num_bigdig2num(&temp, v);
+
+		// Add the digit into the fraction part.
+		bc_num_add(&result2, &temp, &result1, 0);
+
+		// Keep growing m1 and m2 for use after the loop.
+		bc_num_mulArray(m1, base, m2);
+
+		rdx = BC_NUM_RDX_VAL(m2);
+
+		if (m2->len < rdx) m2->len = rdx;
+
+		// Switch.
+		ptr = m1;
+		m1 = m2;
+		m2 = ptr;
+	}
+
+	// This one cannot be a divide by 0 because mult starts out at 1, then is
+	// multiplied by base, and base cannot be 0, so mult cannot be 0. And this
+	// is the reason we keep growing m1 and m2; this division is what converts
+	// the parsed fractional part from an integer to a fractional part.
+	bc_num_div(&result1, m1, &result2, digs * 2);
+
+	// Pretruncate.
+	bc_num_truncate(&result2, digs);
+
+	// The final add of the integer part to the fractional part.
+	bc_num_add(n, &result2, n, digs);
+
+	// Basic cleanup.
+	if (BC_NUM_NONZERO(n))
+	{
+		if (n->scale < digs) bc_num_extend(n, digs - n->scale);
+	}
+	else bc_num_zero(n);
+
+err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&result2);
+	BC_NUM_FREE(&result1);
+	BC_NUM_FREE(&mult2);
+int_err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&mult1);
+	BC_NUM_FREE(&temp);
+	BC_LONGJMP_CONT(vm);
+}
+
+/**
+ * Prints a backslash+newline combo if the number of characters needs it. This
+ * is really a convenience function.
+ */
+static inline void
+bc_num_printNewline(void)
+{
+#if !BC_ENABLE_LIBRARY
+	if (vm->nchars >= vm->line_len - 1 && vm->line_len)
+	{
+		bc_vm_putchar('\\', bc_flush_none);
+		bc_vm_putchar('\n', bc_flush_err);
+	}
+#endif // !BC_ENABLE_LIBRARY
+}
+
+/**
+ * Prints a character after a backslash+newline, if needed.
+ * @param c       The character to print.
+ * @param bslash  Whether to print a backslash+newline.
+ */
+static void
+bc_num_putchar(int c, bool bslash)
+{
+	if (c != '\n' && bslash) bc_num_printNewline();
+	bc_vm_putchar(c, bc_flush_save);
+}
+
+/**
+ * Prints a run of characters, adding backslash+newlines wherever the line
+ * length requires them. This does the same thing as calling bc_num_putchar() on
+ * each character, with the bslash argument true for all but the last, but it
+ * hands the characters to the buffer a line at a time instead.
+ * @param buf     The characters to print. None of them can be newlines.
+ * @param len     The number of characters in @a buf. Must not be 0.
+ * @param bslash  Whether a backslash+newline can be printed before the last
+ *                character.
+ */
+static void
+bc_num_write(const char* buf, size_t len, bool bslash)
+{
+	assert(len > 0);
+
+	// Print everything but the last character in chunks that fit on the line.
+	while (len > 1)
+	{
+		size_t chunk = len - 1;
+
+#if !BC_ENABLE_LIBRARY
+
+		bc_num_printNewline();
+
+		// After bc_num_printNewline(), there is always room for at least one.
+		if (vm->line_len)
+		{
+			size_t room = (size_t) (vm->line_len - 1 - vm->nchars);
+
+			assert(room > 0);
+
+			chunk = BC_MIN(chunk, room);
+		}
+
+#endif // !BC_ENABLE_LIBRARY
+
+		bc_vm_write(buf, chunk, bc_flush_save);
+
+		buf += chunk;
+		len -= chunk;
+	}
+
+	bc_num_putchar(buf[0], bslash);
+}
+
+#if !BC_ENABLE_LIBRARY
+
+/**
+ * Prints a character for a number's digit. This is for printing for dc's P
+ * command. This function does not need to worry about radix points. This is a
+ * BcNumDigitOp.
+ * @param n       The "digit" to print.
+ * @param len     The "length" of the digit, or number of characters that will
+ *                need to be printed for the digit.
+ * @param rdx     True if a decimal (radix) point should be printed.
+ * @param bslash  True if a backslash+newline should be printed if the character
+ *                limit for the line is reached, false otherwise.
+ */
+static void
+bc_num_printChar(size_t n, size_t len, bool rdx, bool bslash)
+{
+	BC_UNUSED(rdx);
+	BC_UNUSED(len);
+	BC_UNUSED(bslash);
+	assert(len == 1);
+	bc_vm_putchar((uchar) n, bc_flush_save);
+}
+
+#endif // !BC_ENABLE_LIBRARY
+
+/**
+ * Prints a series of characters for large bases. This is for printing in bases
+ * above hexadecimal. This is a BcNumDigitOp.
+ * @param n       The "digit" to print.
+ * @param len     The "length" of the digit, or number of characters that will
+ *                need to be printed for the digit.
+ * @param rdx     True if a decimal (radix) point should be printed.
+ * @param bslash  True if a backslash+newline should be printed if the character
+ *                limit for the line is reached, false otherwise.
+ */
+static void
+bc_num_printDigits(size_t n, size_t len, bool rdx, bool bslash)
+{
+	size_t i;
+	char buf[BC_BASE_DIGS + 1];
+
+	assert(len > 0 && len <= BC_BASE_DIGS);
+
+	// If needed, print the radix; otherwise, print a space to separate digits.
+	buf[0] = rdx ? '.' : ' ';
+
+	// Fill in the subdigits from least to most significant.
+	for (i = len; i > 0; --i)
+	{
+		buf[i] = (char) ((n % BC_BASE) + '0');
+		n /= BC_BASE;
+	}
+
+	// Print them all at once.
+	bc_num_write(buf, len + 1, bslash);
+}
+
+/**
+ * Prints a character for a number's digit. This is for printing in bases for
+ * hexadecimal and below because they always print only one character at a time.
+ * This is a BcNumDigitOp.
+ * @param n       The "digit" to print.
+ * @param len     The "length" of the digit, or number of characters that will
+ *                need to be printed for the digit.
+ * @param rdx     True if a decimal (radix) point should be printed.
+ * @param bslash  True if a backslash+newline should be printed if the character
+ *                limit for the line is reached, false otherwise.
+ */
+static void
+bc_num_printHex(size_t n, size_t len, bool rdx, bool bslash)
+{
+	BC_UNUSED(len);
+	BC_UNUSED(bslash);
+
+	assert(len == 1);
+
+	if (rdx) bc_num_putchar('.', true);
+
+	bc_num_putchar(bc_num_hex_digits[n], bslash);
+}
+
+/**
+ * Converts a limb into its BC_BASE_DIGS decimal digits, most significant first
+ * and with leading zeroes, two digits at a time.
+ * @param n    The limb to convert.
+ * @param buf  The return parameter. It must have room for BC_BASE_DIGS chars.
+ */
+static void
+bc_num_limbDigits(BcDig n, char* restrict buf)
+{
+	size_t i = BC_BASE_DIGS;
+	BcBigDig val = (BcBigDig) n;
+
+	assert(n >= 0 && n < BC_BASE_POW);
+
+	// Fill from the back, two digits at a time.
+	while (i >= 2)
+	{
+		const char* pair = bc_num_dec_pairs + (val % 100) * 2;
+
+		val /= 100;
+		i -= 2;
+
+		buf[i] = pair[0];
+		buf[i + 1] = pair[1];
+	}
+
+	// BC_BASE_DIGS may be odd, leaving one more digit.
+	if (i) buf[0] = (char) (val + '0');
+}
+
+/**
+ * Prints a decimal number. This is specially written for optimization since
+ * this will be used the most and because bc's numbers are already in decimal.
+ * Whole limbs are formatted into a buffer that is then printed all at once.
+ * @param n        The number to print.
+ * @param newline  Whether to print backslash+newlines on long enough lines.
+ */
+static void
+bc_num_printDecimal(const BcNum* restrict n, bool newline)
+{
+	size_t i, len = 0, rdx = BC_NUM_RDX_VAL(n);
+	bool zero = true;
+	char digs[BC_BASE_DIGS];
+	char buf[BC_NUM_PRINT_BUF_SIZE];
+
+	// Print loop.
+	for (i = n->len - 1; i < n->len; --i)
+	{
+		size_t start = 0, end, temp;
+		bool irdx = (i == rdx - 1);
+
+		// Calculate the number of digits in the limb to skip at the end.
+		zero = (zero & !irdx);
+		temp = n->scale % BC_BASE_DIGS;
+		temp = i || !temp ? 0 : BC_BASE_DIGS - temp;
+		end = BC_BASE_DIGS - temp;
+
+		bc_num_limbDigits(n->num[i], digs);
+
+		// The zero variable helps us skip leading zero digits in the number.
+		if (zero)
+		{
+			while (start < end && digs[start] == '0')
+			{
+				start += 1;
+			}
+
+			zero = (start == end);
+		}
+
+		// Make sure there is room for the limb and a radix point. We know we
+		// are not printing the last character because at least one more will
+		// be put into the buffer.
+		if (len > BC_NUM_PRINT_BUF_SIZE - BC_BASE_DIGS - 1)
+		{
+			bc_num_write(buf, len, true);
+			len = 0;
+		}
+
+		if (irdx) buf[len++] = '.';
+
+		// NOLINTNEXTLINE
+		memcpy(buf + len, digs + start, end - start);
+		len += end - start;
+	}
+
+	// I don't want to print a newline when the last digit to be printed could
+	// take the place of the backslash rather than being pushed, as a single
+	// character, to the next line. That's what the last argument does for bc.
+	if (len) bc_num_write(buf, len, !newline);
+}
+
+#if BC_ENABLE_EXTRA_MATH
+
+/**
+ * Prints a number in scientific or engineering format. When doing this, we are
+ * always printing in decimal.
+ * @param n        The number to print.
+ * @param eng      True if we are in engineering mode.
+ * @param newline  Whether to print backslash+newlines on long enough lines.
+ */
+static void
+bc_num_printExponent(const BcNum* restrict n, bool eng, bool newline)
+{
+	size_t places, mod, nrdx = BC_NUM_RDX_VAL(n);
+	bool neg = (n->len <= nrdx);
+	BcNum temp, exp;
+	BcDig digs[BC_NUM_BIGDIG_LOG10];
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	BC_SIG_LOCK;
+
+	bc_num_createCopy(&temp, n);
+
+	BC_SETJMP_LOCKED(vm, exit);
+
+	BC_SIG_UNLOCK;
+
+	// We need to calculate the exponents, and they change based on whether the
+	// number is all fractional or not, obviously.
+	if (neg)
+	{
+		// Figure out how many limbs after the decimal point is zero.
+		size_t i, idx = bc_num_nonZeroLen(n) - 1;
+
+		places = 1;
+
+		// Figure out how much in the last limb is zero.
+		for (i = BC_BASE_DIGS - 1; i < BC_BASE_DIGS; --i)
+		{
+			if (bc_num_pow10[i] > (BcBigDig) n->num[idx]) places += 1;
+			else break;
+		}
+
+		// Calculate the combination of zero limbs and zero digits in the last
+		// limb.
+		places += (nrdx - (idx + 1)) * BC_BASE_DIGS;
+		mod = places % 3;
+
+		// Calculate places if we are in engineering mode.
+		if (eng && mod != 0) places += 3 - mod;
+
+		// Shift the temp to the right place.
+		bc_num_shiftLeft(&temp, places);
+	}
+	else
+	{
+		// This is the number of digits that we are supposed to put behind the
+		// decimal point.
+		places = bc_num_intDigits(n) - 1;
+
+		// Calculate the true number based on whether engineering mode is
+		// activated.
+		mod = places % 3;
+		if (eng && mod != 0) places -= 3 - (3 - mod);
+
+		// Shift the temp to the right place.
+		bc_num_shiftRight(&temp, places);
+	}
+
+	// Print the shifted number.
+	bc_num_printDecimal(&temp, newline);
+
+	// Print the e.
+	bc_num_putchar('e', !newline);
+
+	// Need to explicitly print a zero exponent.
+	if (!places)
+	{
+		bc_num_printHex(0, 1, false, !newline);
+		goto exit;
+	}
+
+	// Need to print sign for the exponent.
+	if (neg) bc_num_putchar('-', true);
+
+	// Create a temporary for the exponent...
+	bc_num_setup(&exp, digs, BC_NUM_BIGDIG_LOG10);
+	bc_num_bigdig2num(&exp, (BcBigDig) places);
+
+	/// ..and print it.
+	bc_num_printDecimal(&exp, newline);
+
+exit:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&temp);
+	BC_LONGJMP_CONT(vm);
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+/**
+ * Takes a number with limbs with base BC_BASE_POW and converts the limb at the
+ * given index to base @a pow, where @a pow is obase^N.
+ * @param n    The number to convert.
+ * @param rem  BC_BASE_POW - @a pow.
+ * @param pow  The power of obase we will convert the number to.
+ * @param idx  The index of the number to start converting at. Doing the
+ *             conversion is O(n^2); we have to sweep through starting at the
+ *             least significant limb.
+ */
+static void
+bc_num_printFixup(BcNum* restrict n, BcBigDig rem, BcBigDig pow, size_t idx)
+{
+	size_t i, len = n->len - idx;
+	BcBigDig acc;
+	BcDig* a = n->num + idx;
+
+	// Ignore if there's just one limb left. This is the part that requires the
+	// extra loop after the one calling this function in bc_num_printPrepare().
+	if (len < 2) return;
+
+	// Loop through the remaining limbs and convert. We start at the second limb
 	// because we pull the value from the previous one as well.
 	for (i = len - 1; i > 0; --i)
 	{
-		// Get the limb and add it to the previous, along with multiplying by
-		// the remainder because that's the proper overflow. "acc" means
-		// "accumulator," by the way.
-		acc = ((BcBigDig) a[i]) * rem + ((BcBigDig) a[i - 1]);
+		// Get the limb and add it to the previous, along with multiplying by
+		// the remainder because that's the proper overflow. "acc" means
+		// "accumulator," by the way.
+		acc = ((BcBigDig) a[i]) * rem + ((BcBigDig) a[i - 1]);
+
+		// Store a value in base pow in the previous limb.
+		a[i - 1] = (BcDig) (acc % pow);
+
+		// Divide by the base and accumulate the remaining value in the limb.
+		acc /= pow;
+		acc += (BcBigDig) a[i];
+
+		// If the accumulator is greater than the base...
+		if (acc >= BC_BASE_POW)
+		{
+			// Do we need to grow?
+			if (i == len - 1)
+			{
+				// Grow.
+				len = bc_vm_growSize(len, 1);
+				bc_num_expand(n, bc_vm_growSize(len, idx));
+
+				// Update the pointer because it may have moved.
+				a = n->num + idx;
+
+				// Zero out the last limb.
+				a[len - 1] = 0;
+			}
+
+			// Overflow into the next limb since we are over the base.
+			a[i + 1] += acc / BC_BASE_POW;
+			acc %= BC_BASE_POW;
+		}
+
+		assert(acc < BC_BASE_POW);
+
+		// Set the limb.
+		a[i] = (BcDig) acc;
+	}
+
+	// We may have grown the number, so adjust the length.
+	n->len = len + idx;
+}
+
+/**
+ * Prepares a number for printing in a base that does not have BC_BASE_POW as a
+ * power. This basically converts the number from having limbs of base
+ * BC_BASE_POW to limbs of pow, where pow is obase^N.
+ * @param n    The number to prepare for printing.
+ * @param rem  The remainder of BC_BASE_POW when divided by a power of the base.
+ * @param pow  The power of the base.
+ */
+static void
+bc_num_printPrepare(BcNum* restrict n, BcBigDig rem, BcBigDig pow)
+{
+	size_t i;
+
+	// Loop from the least significant limb to the most significant limb and
+	// convert limbs in each pass.
+	for (i = 0; i < n->len; ++i)
+	{
+		bc_num_printFixup(n, rem, pow, i);
+	}
+
+	// bc_num_printFixup() does not do everything it is supposed to, so we do
+	// the last bit of cleanup here. That cleanup is to ensure that each limb
+	// is less than pow and to expand the number to fit new limbs as necessary.
+	for (i = 0; i < n->len; ++i)
+	{
+		assert(pow == ((BcBigDig) ((BcDig) pow)));
+
+		// If the limb needs fixing...
+		if (n->num[i] >= (BcDig) pow)
+		{
+			// Do we need to grow?
+			if (i + 1 == n->len)
+			{
+				// Grow the number.
+				n->len = bc_vm_growSize(n->len, 1);
+				bc_num_expand(n, n->len);
+
+				// Without this, we might use uninitialized data.
+				n->num[i + 1] = 0;
+			}
+
+			assert(pow < BC_BASE_POW);
+
+			// Overflow into the next limb.
+			n->num[i + 1] += n->num[i] / ((BcDig) pow);
+			n->num[i] %= (BcDig) pow;
+		}
+	}
+}
+
+/**
+ * Pushes the digits of the integer part of a number in a power of two base onto
+ * a stack, least significant first. The number is converted to binary once,
+ * and then each digit is just a group of bits, so this does not need
+ * bc_num_printPrepare().
+ * @param n      The number to get the digits of.
+ * @param base   The base to get the digits in. Must be a power of two.
+ * @param stack  The stack to push the digits onto.
+ */
+static void
+bc_num_binDigits(const BcNum* restrict n, BcBigDig base, BcVec* restrict stack)
+{
+	BcVec bin;
+	BcBigDig* words;
+	size_t i, bits, total;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(BC_NUM_POW2(base));
+
+	bits = bc_num_bitLen(base - 1);
+
+	BC_SIG_LOCK;
+
+	bc_vec_init(&bin, sizeof(BcBigDig), BC_DTOR_NONE);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_toBin(n, &bin);
+
+	if (!bin.len) goto err;
+
+	words = (BcBigDig*) bin.v;
+
+	// The number of significant bits.
+	total = (bin.len - 1) * BC_NUM_BIN_BITS +
+	        bc_num_bitLen(words[bin.len - 1]);
+
+	bc_vec_expand(stack, stack->len + (total + bits - 1) / bits);
+
+	// Pull out each group of bits.
+	for (i = 0; i < total; i += bits)
+	{
+		size_t idx = i / BC_NUM_BIN_BITS, shift = i % BC_NUM_BIN_BITS;
+		BcBigDig dig = words[idx] >> shift;
+
+		// The digit may straddle two words.
+		if (shift + bits > BC_NUM_BIN_BITS && idx + 1 < bin.len)
+		{
+			dig |= words[idx + 1] << (BC_NUM_BIN_BITS - shift);
+		}
+
+		dig &= base - 1;
+
+		bc_vec_push(stack, &dig);
+	}
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_vec_free(&bin);
+	BC_LONGJMP_CONT(vm);
+}
+
+static void
+bc_num_printNum(BcNum* restrict n, BcBigDig base, size_t len,
+                BcNumDigitOp print, bool newline)
+{
+	BcVec stack;
+	BcNum intp, fracp1, fracp2, digit, flen1, flen2;
+	BcNum* n1;
+	BcNum* n2;
+	BcNum* temp;
+	BcBigDig dig = 0, acc, exp;
+	BcBigDig* ptr;
+	size_t i, j, nrdx, idigits;
+	bool radix;
+	BcDig digit_digs[BC_NUM_BIGDIG_LOG10 + 1];
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(base > 1);
+
+	// Easy case. Even with scale, we just print this.
+	if (BC_NUM_ZERO(n))
+	{
+		print(0, len, false, !newline);
+		return;
+	}
+
+	// This function uses an algorithm that Stefan Esser <se@freebsd.org> came
+	// up with to print the integer part of a number. What it does is convert
+	// intp into a number of the specified base, but it does it directly,
+	// instead of just doing a series of divisions and printing the remainders
+	// in reverse order.
+	//
+	// Let me explain in a bit more detail:
+	//
+	// The algorithm takes the current least significant limb (after intp has
+	// been converted to an integer) and the next to least significant limb, and
+	// it converts the least significant limb into one of the specified base,
+	// putting any overflow into the next to least significant limb. It iterates
+	// through the whole number, from least significant to most significant,
+	// doing this conversion. At the end of that iteration, the least
+	// significant limb is converted, but the others are not, so it iterates
+	// again, starting at the next to least significant limb. It keeps doing
+	// that conversion, skipping one more limb than the last time, until all
+	// limbs have been converted. Then it prints them in reverse order.
+	//
+	// That is the gist of the algorithm. It leaves out several things, such as
+	// the fact that limbs are not always converted into the specified base, but
+	// into something close, basically a power of the specified base. In
+	// Stefan's words, "You could consider BcDigs to be of base 10^BC_BASE_DIGS
+	// in the normal case and obase^N for the largest value of N that satisfies
+	// obase^N <= 10^BC_BASE_DIGS. [This means that] the result is not in base
+	// "obase", but in base "obase^N", which happens to be printable as a number
+	// of base "obase" without consideration for neighbouring BcDigs." This fact
+	// is what necessitates the existence of the loop later in this function.
+	//
+	// The conversion happens in bc_num_printPrepare() where the outer loop
+	// happens and bc_num_printFixup() where the inner loop, or actual
+	// conversion, happens. In other words, bc_num_printPrepare() is where the
+	// loop that starts at the least significant limb and goes to the most
+	// significant limb. Then, on every iteration of its loop, it calls
+	// bc_num_printFixup(), which has the inner loop of actually converting
+	// the limbs it passes into limbs of base obase^N rather than base
+	// BC_BASE_POW.
+
+	nrdx = BC_NUM_RDX_VAL(n);
+
+	BC_SIG_LOCK;
+
+	// The stack is what allows us to reverse the digits for printing.
+	bc_vec_init(&stack, sizeof(BcBigDig), BC_DTOR_NONE);
+	BC_NUM_INIT(&fracp1, nrdx);
+
+	// intp will be the "integer part" of the number, so copy it.
+	bc_num_createCopy(&intp, n);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// Make intp an integer.
+	bc_num_truncate(&intp, intp.scale);
+
+	// Get the fractional part out.
+	bc_num_sub(n, &intp, &fracp1, 0);
+
+	// If the base is not the same as the last base used for printing, we need
+	// to update the cached exponent and power. Yes, we cache the values of the
+	// exponent and power. That is to prevent us from calculating them every
+	// time because printing will probably happen multiple times on the same
+	// base.
+	if (base != vm->last_base)
+	{
+		vm->last_pow = 1;
+		vm->last_exp = 0;
+
+		// Calculate the exponent and power.
+		while (vm->last_pow * base <= BC_BASE_POW)
+		{
+			vm->last_pow *= base;
+			vm->last_exp += 1;
+		}
+
+		// Also, the remainder and base itself.
+		vm->last_rem = BC_BASE_POW - vm->last_pow;
+		vm->last_base = base;
+	}
+
+	exp = vm->last_exp;
+
+	// Power of two bases have their own way of getting the digits; they just
+	// need a conversion to binary. Otherwise, if vm->last_rem is 0, then the
+	// base we are printing in is a divisor of BC_BASE_POW, which is the easy
+	// case because it means that BC_BASE_POW is a power of obase, and no
+	// conversion is needed. If it *is* 0, then we have the hard case, and we
+	// have to prepare the number for the base.
+	if (BC_NUM_POW2(base)) bc_num_binDigits(&intp, base, &stack);
+	else if (vm->last_rem != 0)
+	{
+		bc_num_printPrepare(&intp, vm->last_rem, vm->last_pow);
+	}
+
+	// After the conversion comes the surprisingly easy part. From here on out,
+	// this is basically naive code that I wrote, adjusted for the larger bases.
+
+	// Fill the stack of digits for the integer part, if that was not done
+	// already.
+	for (i = 0; !BC_NUM_POW2(base) && i < intp.len; ++i)
+	{
+		// Get the limb.
+		acc = (BcBigDig) intp.num[i];
+
+		// Turn the limb into digits of base obase.
+		for (j = 0; j < exp && (i < intp.len - 1 || acc != 0); ++j)
+		{
+			// This condition is true if we are not at the last digit.
+			if (j != exp - 1)
+			{
+				dig = acc % base;
+				acc /= base;
+			}
+			else
+			{
+				dig = acc;
+				acc = 0;
+			}
+
+			assert(dig < base);
+
+			// Push the digit onto the stack.
+			bc_vec_push(&stack, &dig);
+		}
+
+		assert(acc == 0);
+	}
+
+	// Single character digits can be printed all at once. The condition for
+	// the backslash on the last character is explained below.
+	if (print == bc_num_printHex && stack.len)
+	{
+		char buf[BC_NUM_PRINT_BUF_SIZE];
+		size_t buflen = 0;
+
+		for (i = 0; i < stack.len; ++i)
+		{
+			// There is always at least one more character when flushing this.
+			if (buflen == BC_NUM_PRINT_BUF_SIZE)
+			{
+				bc_num_write(buf, buflen, true);
+				buflen = 0;
+			}
+
+			ptr = bc_vec_item_rev(&stack, i);
+			buf[buflen++] = bc_num_hex_digits[*ptr];
+		}
+
+		bc_num_write(buf, buflen, !newline || n->scale != 0);
+	}
+
+	// Go through the stack backwards and print each digit.
+	for (i = 0; print != bc_num_printHex && i < stack.len; ++i)
+	{
+		ptr = bc_vec_item_rev(&stack, i);
+
+		assert(ptr != NULL);
+
+		// While the first three arguments should be self-explanatory, the last
+		// needs explaining. I don't want to print a backslash+newline when the
+		// last digit to be printed could take the place of the backslash rather
+		// than being pushed, as a single character, to the next line. That's
+		// what that last argument does for bc.
+		//
+		// First, it needs to check if newlines are completely disabled. If they
+		// are not disabled, it needs to check the next part.
+		//
+		// If the number has a scale, then because we are printing just the
+		// integer part, there will be at least two more characters (a radix
+		// point plus at least one digit). So if there is a scale, a backslash
+		// is necessary.
+		//
+		// Finally, the last condition checks to see if we are at the end of the
+		// stack. If we are *not* (i.e., the index is not one less than the
+		// stack length), then a backslash is necessary because there is at
+		// least one more character for at least one more digit). Otherwise, if
+		// the index is equal to one less than the stack length, we want to
+		// disable backslash printing.
+		//
+		// The function that prints bases 17 and above will take care of not
+		// printing a backslash in the right case.
+		print(*ptr, len, false,
+		      !newline || (n->scale != 0 || i < stack.len - 1));
+	}
+
+	// We are done if there is no fractional part.
+	if (!n->scale) goto err;
+
+	BC_SIG_LOCK;
+
+	// Reset the jump because some locals are changing.
+	BC_UNSETJMP(vm);
+
+	BC_NUM_INIT(&fracp2, nrdx);
+	bc_num_setup(&digit, digit_digs, sizeof(digit_digs) / sizeof(BcDig));
+	BC_NUM_INIT(&flen1, BC_NUM_BIGDIG_LOG10);
+	BC_NUM_INIT(&flen2, BC_NUM_BIGDIG_LOG10);
+
+	BC_SETJMP_LOCKED(vm, frac_err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_one(&flen1);
+
+	radix = true;
+
+	// Pointers for easy switching.
+	n1 = &flen1;
+	n2 = &flen2;
+
+	fracp2.scale = n->scale;
+	BC_NUM_RDX_SET_NP(fracp2, BC_NUM_RDX(fracp2.scale));
+
+	// As long as we have not reached the scale of the number, keep printing.
+	while ((idigits = bc_num_intDigits(n1)) <= n->scale)
+	{
+		// These numbers will keep growing.
+		BC_NUM_EXPAND(&fracp2, fracp1.len + 1);
+		bc_num_mulArray(&fracp1, base, &fracp2);
+
+		nrdx = BC_NUM_RDX_VAL_NP(fracp2);
+
+		// Ensure an invariant.
+		if (fracp2.len < nrdx) fracp2.len = nrdx;
+
+		// fracp is guaranteed to be non-negative and small enough.
+		dig = bc_num_bigdig2(&fracp2);
+
+		// Convert the digit to a number and subtract it from the number.
+		bc_num_bigdig2num(&digit, dig);
+		bc_num_sub(&fracp2, &digit, &fracp1, 0);
+
+		// While the first three arguments should be self-explanatory, the last
+		// needs explaining. I don't want to print a newline when the last digit
+		// to be printed could take the place of the backslash rather than being
+		// pushed, as a single character, to the next line. That's what that
+		// last argument does for bc.
+		print(dig, len, radix, !newline || idigits != n->scale);
+
+		// Update the multipliers.
+		bc_num_mulArray(n1, base, n2);
+
+		radix = false;
+
+		// Switch.
+		temp = n1;
+		n1 = n2;
+		n2 = temp;
+	}
+
+frac_err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&flen2);
+	BC_NUM_FREE(&flen1);
+	BC_NUM_FREE(&fracp2);
+err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&fracp1);
+	BC_NUM_FREE(&intp);
+	bc_vec_free(&stack);
+	BC_LONGJMP_CONT(vm);
+}
+
+/**
+ * Prints a number in the specified base, or rather, figures out which function
+ * to call to print the number in the specified base and calls it.
+ * @param n        The number to print.
+ * @param base     The base to print in.
+ * @param newline  Whether to print backslash+newlines on long enough lines.
+ */
+static void
+bc_num_printBase(BcNum* restrict n, BcBigDig base, bool newline)
+{
+	size_t width;
+	BcNumDigitOp print;
+	bool neg = BC_NUM_NEG(n);
+
+	// Clear the sign because it makes the actual printing easier when we have
+	// to do math.
+	BC_NUM_NEG_CLR(n);
+
+	// Bases at hexadecimal and below are printed as one character, larger bases
+	// are printed as a series of digits separated by spaces.
+	if (base <= BC_NUM_MAX_POSIX_IBASE)
+	{
+		width = 1;
+		print = bc_num_printHex;
+	}
+	else
+	{
+		assert(base <= BC_BASE_POW);
+		width = bc_num_log10(base - 1);
+		print = bc_num_printDigits;
+	}
+
+	// Print.
+	bc_num_printNum(n, base, width, print, newline);
+
+	// Reset the sign.
+	n->rdx = BC_NUM_NEG_VAL(n, neg);
+}
+
+#if !BC_ENABLE_LIBRARY
+
+void
+bc_num_stream(BcNum* restrict n)
+{
+	bc_num_printNum(n, BC_NUM_STREAM_BASE, 1, bc_num_printChar, false);
+}
+
+#endif // !BC_ENABLE_LIBRARY
+
+void
+bc_num_setup(BcNum* restrict n, BcDig* restrict num, size_t cap)
+{
+	assert(n != NULL);
+	n->num = num;
+	n->cap = cap;
+	bc_num_zero(n);
+}
+
+void
+bc_num_init(BcNum* restrict n, size_t req)
+{
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	BC_NUM_INIT(n, req);
+}
+
+void
+bc_num_initArena(BcNum* restrict n, size_t req, struct BclArena* arena)
+{
+	BcDig* num;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(n != NULL);
+
+#if !BC_ENABLE_LIBRARY
+	BC_UNUSED(arena);
+#endif // !BC_ENABLE_LIBRARY
+
+	// BC_NUM_DEF_SIZE is set to be about the smallest allocation size that
+	// malloc() returns in practice, so just use it.
+	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
+
+#if BC_ENABLE_LIBRARY
+	// If the context is in arena mode, the limbs come from its arena, and the
+	// temps are left alone.
+	if (arena != NULL)
+	{
+		bc_num_setup(n, bcl_arena_alloc(arena, req), req);
+		return;
+	}
+#endif // BC_ENABLE_LIBRARY
+
+	// If we can't use a temp, allocate.
+	if (req != BC_NUM_DEF_SIZE) num = bc_vm_malloc(BC_NUM_SIZE(req));
+	else
+	{
+		num = bc_vm_getTemp() == NULL ? bc_vm_malloc(BC_NUM_SIZE(req)) :
+		                                bc_vm_takeTemp();
+	}
+
+	bc_num_setup(n, num, req);
+}
+
+void
+bc_num_clear(BcNum* restrict n)
+{
+	n->num = NULL;
+	n->cap = 0;
+}
+
+void
+bc_num_free(void* num)
+{
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	BC_NUM_FREE((BcNum*) num);
+}
+
+void
+bc_num_freeArena(BcNum* restrict n, struct BclArena* arena)
+{
+	BC_SIG_ASSERT_LOCKED;
+
+	assert(n != NULL);
+
+#if !BC_ENABLE_LIBRARY
+	BC_UNUSED(arena);
+#endif // !BC_ENABLE_LIBRARY
+
+#if BC_ENABLE_LIBRARY
+	// Limbs from an arena go back to it.
+	if (arena != NULL && bcl_arena_owns(arena, n->num))
+	{
+		bcl_arena_free(arena, n->num, n->cap);
+		return;
+	}
+#endif // BC_ENABLE_LIBRARY
+
+	if (n->cap == BC_NUM_DEF_SIZE) bc_vm_addTemp(n->num);
+	else free(n->num);
+}
+
+void
+bc_num_copy(BcNum* d, const BcNum* s)
+{
+	assert(d != NULL && s != NULL);
+
+	if (d == s) return;
+
+	bc_num_expand(d, s->len);
+	d->len = s->len;
+
+	// I can just copy directly here because the sign *and* rdx will be
+	// properly preserved.
+	d->rdx = s->rdx;
+	d->scale = s->scale;
+	// NOLINTNEXTLINE
+	memcpy(d->num, s->num, BC_NUM_SIZE(d->len));
+}
+
+void
+bc_num_createCopy(BcNum* d, const BcNum* s)
+{
+	BC_SIG_ASSERT_LOCKED;
+	bc_num_init(d, s->len);
+	bc_num_copy(d, s);
+}
+
+void
+bc_num_createFromBigdig(BcNum* restrict n, BcBigDig val)
+{
+	BC_SIG_ASSERT_LOCKED;
+	bc_num_init(n, BC_NUM_BIGDIG_LOG10);
+	bc_num_bigdig2num(n, val);
+}
+
+size_t
+bc_num_scale(const BcNum* restrict n)
+{
+	return n->scale;
+}
+
+size_t
+bc_num_len(const BcNum* restrict n)
+{
+	size_t len = n->len;
+
+	// Always return at least 1.
+	if (BC_NUM_ZERO(n)) return n->scale ? n->scale : 1;
+
+	// If this is true, there is no integer portion of the number.
+	if (BC_NUM_RDX_VAL(n) == len)
+	{
+		// We have to take into account the fact that some of the digits right
+		// after the decimal could be zero. If that is the case, we need to
+		// ignore them until we hit the first non-zero digit.
+
+		size_t zero, scale;
+
+		// The number of limbs with non-zero digits.
+		len = bc_num_nonZeroLen(n);
+
+		// Get the number of digits in the last limb.
+		scale = n->scale % BC_BASE_DIGS;
+		scale = scale ? scale : BC_BASE_DIGS;
+
+		// Get the number of zero digits.
+		zero = bc_num_zeroDigits(n->num + len - 1);
+
+		// Calculate the true length.
+		len = len * BC_BASE_DIGS - zero - (BC_BASE_DIGS - scale);
+	}
+	// Otherwise, count the number of int digits and return that plus the scale.
+	else len = bc_num_intDigits(n) + n->scale;
+
+	return len;
+}
+
+void
+bc_num_parse(BcNum* restrict n, const char* restrict val, size_t len,
+             BcBigDig base)
+{
+#if BC_DEBUG
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+#endif // BC_DEBUG
+
+	assert(n != NULL && val != NULL && base);
+	assert(base >= BC_NUM_MIN_BASE && base <= vm->maxes[BC_PROG_GLOBALS_IBASE]);
+	assert(bc_num_strValid(val, len));
+
+	// A one character number is *always* parsed as though the base was the
+	// maximum allowed ibase, per the bc spec.
+	if (len == 1)
+	{
+		BcBigDig dig = bc_num_parseChar(val[0], BC_NUM_MAX_LBASE);
+		bc_num_bigdig2num(n, dig);
+	}
+	else if (base == BC_BASE) bc_num_parseDecimal(n, val, len);
+	else bc_num_parseBase(n, val, len, base);
+
+	assert(BC_NUM_RDX_VALID(n));
+}
+
+void
+bc_num_print(BcNum* restrict n, BcBigDig base, bool newline)
+{
+	assert(n != NULL);
+	assert(BC_ENABLE_EXTRA_MATH || base >= BC_NUM_MIN_BASE);
+
+	// We may need a newline, just to start.
+	bc_num_printNewline();
+
+	if (BC_NUM_NONZERO(n))
+	{
+#if BC_ENABLE_LIBRARY
+		BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+		// Print the sign.
+		if (BC_NUM_NEG(n)) bc_num_putchar('-', true);
+
+		// Print the leading zero if necessary. We don't print when using
+		// scientific or engineering modes.
+		if (BC_Z && BC_NUM_RDX_VAL(n) == n->len && base != 0 && base != 1)
+		{
+			bc_num_printHex(0, 1, false, !newline);
+		}
+	}
+
+	// Short-circuit 0.
+	if (BC_NUM_ZERO(n)) bc_num_printHex(0, 1, false, !newline);
+	else if (base == BC_BASE) bc_num_printDecimal(n, newline);
+#if BC_ENABLE_EXTRA_MATH
+	else if (base == 0 || base == 1)
+	{
+		bc_num_printExponent(n, base != 0, newline);
+	}
+#endif // BC_ENABLE_EXTRA_MATH
+	else bc_num_printBase(n, base, newline);
+
+	if (newline) bc_num_putchar('\n', false);
+}
+
+BcBigDig
+bc_num_bigdig2(const BcNum* restrict n)
+{
+#if BC_DEBUG
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+#endif // BC_DEBUG
+
+	// This function returns no errors because it's guaranteed to succeed if
+	// its preconditions are met. Those preconditions include both n needs to
+	// be non-NULL, n being non-negative, and n being less than vm->max. If all
+	// of that is true, then we can just convert without worrying about negative
+	// errors or overflow.
+
+	BcBigDig r = 0;
+	size_t nrdx = BC_NUM_RDX_VAL(n);
+
+	assert(n != NULL);
+	assert(!BC_NUM_NEG(n));
+	assert(bc_num_cmp(n, &vm->max) < 0);
+	assert(n->len - nrdx <= 3);
+
+	// There is a small speed win from unrolling the loop here, and since it
+	// only adds 53 bytes, I decided that it was worth it.
+	switch (n->len - nrdx)
+	{
+		case 3:
+		{
+			r = (BcBigDig) n->num[nrdx + 2];
+
+			// Fallthrough.
+			BC_FALLTHROUGH
+		}
+
+		case 2:
+		{
+			r = r * BC_BASE_POW + (BcBigDig) n->num[nrdx + 1];
+
+			// Fallthrough.
+			BC_FALLTHROUGH
+		}
+
+		case 1:
+		{
+			r = r * BC_BASE_POW + (BcBigDig) n->num[nrdx];
+		}
+	}
+
+	return r;
+}
+
+BcBigDig
+bc_num_bigdig(const BcNum* restrict n)
+{
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(n != NULL);
+
+	// This error checking is extremely important, and if you do not have a
+	// guarantee that converting a number will always succeed in a particular
+	// case, you *must* call this function to get these error checks. This
+	// includes all instances of numbers inputted by the user or calculated by
+	// the user. Otherwise, you can call the faster bc_num_bigdig2().
+	if (BC_ERR(BC_NUM_NEG(n))) bc_err(BC_ERR_MATH_NEGATIVE);
+	if (BC_ERR(bc_num_cmp(n, &vm->max) >= 0)) bc_err(BC_ERR_MATH_OVERFLOW);
+
+	return bc_num_bigdig2(n);
+}
+
+void
+bc_num_bigdig2num(BcNum* restrict n, BcBigDig val)
+{
+	BcDig* ptr;
+	size_t i;
+
+	assert(n != NULL);
+
+	bc_num_zero(n);
+
+	// Already 0.
+	if (!val) return;
+
+	// Expand first. This is the only way this function can fail, and it's a
+	// fatal error.
+	bc_num_expand(n, BC_NUM_BIGDIG_LOG10);
+
+	// The conversion is easy because numbers are laid out in little-endian
+	// order.
+	for (ptr = n->num, i = 0; val; ++i, val /= BC_BASE_POW)
+	{
+		ptr[i] = val % BC_BASE_POW;
+	}
+
+	n->len = i;
+}
+
+#if BC_ENABLE_EXTRA_MATH
+
+void
+bc_num_rng(const BcNum* restrict n, BcRNG* rng)
+{
+	BcNum temp, temp2, intn, frac;
+	BcRand state1, state2, inc1, inc2;
+	size_t nrdx = BC_NUM_RDX_VAL(n);
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	// This function holds the secret of how I interpret a seed number for the
+	// PRNG. Well, it's actually in the development manual
+	// (manuals/development.md#pseudo-random-number-generator), so look there
+	// before you try to understand this.
+
+	BC_SIG_LOCK;
+
+	BC_NUM_INIT(&temp, n->len);
+	BC_NUM_INIT(&temp2, n->len);
+	BC_NUM_INIT(&frac, nrdx);
+	BC_NUM_INIT(&intn, bc_num_int(n));
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	assert(BC_NUM_RDX_VALID_NP(vm->max));
+
+	// NOLINTNEXTLINE
+	memcpy(frac.num, n->num, BC_NUM_SIZE(nrdx));
+	frac.len = nrdx;
+	BC_NUM_RDX_SET_NP(frac, nrdx);
+	frac.scale = n->scale;
+
+	assert(BC_NUM_RDX_VALID_NP(frac));
+	assert(BC_NUM_RDX_VALID_NP(vm->max2));
+
+	// Multiply the fraction and truncate so that it's an integer. The
+	// truncation is what clamps it, by the way.
+	bc_num_mul(&frac, &vm->max2, &temp, 0);
+	bc_num_truncate(&temp, temp.scale);
+	bc_num_copy(&frac, &temp);
+
+	// Get the integer.
+	// NOLINTNEXTLINE
+	memcpy(intn.num, n->num + nrdx, BC_NUM_SIZE(bc_num_int(n)));
+	intn.len = bc_num_int(n);
+
+	// This assert is here because it has to be true. It is also here to justify
+	// some optimizations.
+	assert(BC_NUM_NONZERO(&vm->max));
+
+	// If there *was* a fractional part...
+	if (BC_NUM_NONZERO(&frac))
+	{
+		// This divmod splits frac into the two state parts.
+		bc_num_divmod(&frac, &vm->max, &temp, &temp2, 0);
+
+		// frac is guaranteed to be smaller than vm->max * vm->max (pow).
+		// This means that when dividing frac by vm->max, as above, the
+		// quotient and remainder are both guaranteed to be less than vm->max,
+		// which means we can use bc_num_bigdig2() here and not worry about
+		// overflow.
+		state1 = (BcRand) bc_num_bigdig2(&temp2);
+		state2 = (BcRand) bc_num_bigdig2(&temp);
+	}
+	else state1 = state2 = 0;
+
+	// If there *was* an integer part...
+	if (BC_NUM_NONZERO(&intn))
+	{
+		// This divmod splits intn into the two inc parts.
+		bc_num_divmod(&intn, &vm->max, &temp, &temp2, 0);
+
+		// Because temp2 is the mod of vm->max, from above, it is guaranteed
+		// to be small enough to use bc_num_bigdig2().
+		inc1 = (BcRand) bc_num_bigdig2(&temp2);
+
+		// Clamp the second inc part.
+		if (bc_num_cmp(&temp, &vm->max) >= 0)
+		{
+			bc_num_copy(&temp2, &temp);
+			bc_num_mod(&temp2, &vm->max, &temp, 0);
+		}
+
+		// The if statement above ensures that temp is less than vm->max, which
+		// means that we can use bc_num_bigdig2() here.
+		inc2 = (BcRand) bc_num_bigdig2(&temp);
+	}
+	else inc1 = inc2 = 0;
+
+	bc_rand_seed(rng, state1, state2, inc1, inc2);
+
+err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&intn);
+	BC_NUM_FREE(&frac);
+	BC_NUM_FREE(&temp2);
+	BC_NUM_FREE(&temp);
+	BC_LONGJMP_CONT(vm);
+}
+
+void
+bc_num_createFromRNG(BcNum* restrict n, BcRNG* rng)
+{
+	BcRand s1, s2, i1, i2;
+	BcNum conv, temp1, temp2, temp3;
+	BcDig temp1_num[BC_RAND_NUM_SIZE], temp2_num[BC_RAND_NUM_SIZE];
+	BcDig conv_num[BC_NUM_BIGDIG_LOG10];
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	BC_SIG_LOCK;
+
+	BC_NUM_INIT(&temp3, 2 * BC_RAND_NUM_SIZE);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_setup(&temp1, temp1_num, sizeof(temp1_num) / sizeof(BcDig));
+	bc_num_setup(&temp2, temp2_num, sizeof(temp2_num) / sizeof(BcDig));
+	bc_num_setup(&conv, conv_num, sizeof(conv_num) / sizeof(BcDig));
+
+	// This assert is here because it has to be true. It is also here to justify
+	// the assumption that vm->max is not zero.
+	assert(BC_NUM_NONZERO(&vm->max));
+
+	// Because this is true, we can just ignore math errors that would happen
+	// otherwise.
+	assert(BC_NUM_NONZERO(&vm->max2));
+
+	bc_rand_getRands(rng, &s1, &s2, &i1, &i2);
+
+	// Put the second piece of state into a number.
+	bc_num_bigdig2num(&conv, (BcBigDig) s2);
+
+	assert(BC_NUM_RDX_VALID_NP(conv));
+
+	// Multiply by max to make room for the first piece of state.
+	bc_num_mul(&conv, &vm->max, &temp1, 0);
+
+	// Add in the first piece of state.
+	bc_num_bigdig2num(&conv, (BcBigDig) s1);
+	bc_num_add(&conv, &temp1, &temp2, 0);
+
+	// Divide to make it an entirely fractional part.
+	bc_num_div(&temp2, &vm->max2, &temp3, BC_RAND_STATE_BITS);
+
+	// Now start on the increment parts. It's the same process without the
+	// divide, so put the second piece of increment into a number.
+	bc_num_bigdig2num(&conv, (BcBigDig) i2);
+
+	assert(BC_NUM_RDX_VALID_NP(conv));
+
+	// Multiply by max to make room for the first piece of increment.
+	bc_num_mul(&conv, &vm->max, &temp1, 0);
+
+	// Add in the first piece of increment.
+	bc_num_bigdig2num(&conv, (BcBigDig) i1);
+	bc_num_add(&conv, &temp1, &temp2, 0);
+
+	// Now add the two together.
+	bc_num_add(&temp2, &temp3, n, 0);
+
+	assert(BC_NUM_RDX_VALID(n));
+
+err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&temp3);
+	BC_LONGJMP_CONT(vm);
+}
+
+void
+bc_num_irand(BcNum* restrict a, BcNum* restrict b, BcRNG* restrict rng)
+{
+	BcNum atemp;
+	size_t i;
+
+	assert(a != b);
+
+	if (BC_ERR(BC_NUM_NEG(a))) bc_err(BC_ERR_MATH_NEGATIVE);
+
+	// If either of these are true, then the numbers are integers.
+	if (BC_NUM_ZERO(a) || BC_NUM_ONE(a)) return;
+
+#if BC_GCC
+	// This is here in GCC to quiet the "maybe-uninitialized" warning.
+	atemp.num = NULL;
+	atemp.len = 0;
+#endif // BC_GCC
+
+	if (BC_ERR(bc_num_nonInt(a, &atemp))) bc_err(BC_ERR_MATH_NON_INTEGER);
+
+	assert(atemp.num != NULL);
+	assert(atemp.len);
+
+	if (atemp.len > 2)
+	{
+		size_t len;
+
+		len = atemp.len - 2;
+
+		// Just generate a random number for each limb.
+		for (i = 0; i < len; i += 2)
+		{
+			BcRand dig;
+
+			dig = bc_rand_bounded(rng, BC_BASE_RAND_POW);
+
+			b->num[i] = (BcDig) (dig % BC_BASE_POW);
+			b->num[i + 1] = (BcDig) (dig / BC_BASE_POW);
+		}
+	}
+	else
+	{
+		// We need this set.
+		i = 0;
+	}
+
+	// This will be true if there's one full limb after the two limb groups.
+	if (i == atemp.len - 2)
+	{
+		// Increment this for easy use.
+		i += 1;
+
+		// If the last digit is not one, we need to set a bound for it
+		// explicitly. Since there's still an empty limb, we need to fill that.
+		if (atemp.num[i] != 1)
+		{
+			BcRand dig;
+			BcRand bound;
+
+			// Set the bound to the bound of the last limb times the amount
+			// needed to fill the second-to-last limb as well.
+			bound = ((BcRand) atemp.num[i]) * BC_BASE_POW;
+
+			dig = bc_rand_bounded(rng, bound);
+
+			// Fill the last two.
+			b->num[i - 1] = (BcDig) (dig % BC_BASE_POW);
+			b->num[i] = (BcDig) (dig / BC_BASE_POW);
+
+			// Ensure that the length will be correct. If the last limb is zero,
+			// then the length needs to be one less than the bound.
+			b->len = atemp.len - (b->num[i] == 0);
+		}
+		// Here the last limb *is* one, which means the last limb does *not*
+		// need to be filled. Also, the length needs to be one less because the
+		// last limb is 0.
+		else
+		{
+			b->num[i - 1] = (BcDig) bc_rand_bounded(rng, BC_BASE_POW);
+			b->len = atemp.len - 1;
+		}
+	}
+	// Here, there is only one limb to fill.
+	else
+	{
+		// See above for how this works.
+		if (atemp.num[i] != 1)
+		{
+			b->num[i] = (BcDig) bc_rand_bounded(rng, (BcRand) atemp.num[i]);
+			b->len = atemp.len - (b->num[i] == 0);
+		}
+		else b->len = atemp.len - 1;
+	}
+
+	bc_num_clean(b);
+
+	assert(BC_NUM_RDX_VALID(b));
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+size_t
+bc_num_addReq(const BcNum* a, const BcNum* b, size_t scale)
+{
+	size_t aint, bint, ardx, brdx;
+
+	// Addition and subtraction require the max of the length of the two numbers
+	// plus 1.
+
+	BC_UNUSED(scale);
+
+	ardx = BC_NUM_RDX_VAL(a);
+	aint = bc_num_int(a);
+	assert(aint <= a->len && ardx <= a->len);
+
+	brdx = BC_NUM_RDX_VAL(b);
+	bint = bc_num_int(b);
+	assert(bint <= b->len && brdx <= b->len);
+
+	ardx = BC_MAX(ardx, brdx);
+	aint = BC_MAX(aint, bint);
+
+	return bc_vm_growSize(bc_vm_growSize(ardx, aint), 1);
+}
+
+size_t
+bc_num_mulReq(const BcNum* a, const BcNum* b, size_t scale)
+{
+	size_t max, rdx;
+
+	// Multiplication requires the sum of the lengths of the numbers.
+
+	rdx = bc_vm_growSize(BC_NUM_RDX_VAL(a), BC_NUM_RDX_VAL(b));
+
+	max = BC_NUM_RDX(scale);
+
+	max = bc_vm_growSize(BC_MAX(max, rdx), 1);
+	rdx = bc_vm_growSize(bc_vm_growSize(bc_num_int(a), bc_num_int(b)), max);
+
+	return rdx;
+}
+
+size_t
+bc_num_divReq(const BcNum* a, const BcNum* b, size_t scale)
+{
+	size_t max, rdx;
+
+	// Division requires the length of the dividend plus the scale.
+
+	rdx = bc_vm_growSize(BC_NUM_RDX_VAL(a), BC_NUM_RDX_VAL(b));
+
+	max = BC_NUM_RDX(scale);
+
+	max = bc_vm_growSize(BC_MAX(max, rdx), 1);
+	rdx = bc_vm_growSize(bc_num_int(a), max);
+
+	return rdx;
+}
+
+size_t
+bc_num_powReq(const BcNum* a, const BcNum* b, size_t scale)
+{
+	BC_UNUSED(scale);
+	return bc_vm_growSize(bc_vm_growSize(a->len, b->len), 1);
+}
+
+#if BC_ENABLE_EXTRA_MATH
+size_t
+bc_num_placesReq(const BcNum* a, const BcNum* b, size_t scale)
+{
+	BC_UNUSED(scale);
+	return a->len + b->len - BC_NUM_RDX_VAL(a) - BC_NUM_RDX_VAL(b);
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+void
+bc_num_add(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, false, bc_num_as, bc_num_addReq(a, b, scale));
+}
+
+void
+bc_num_sub(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, true, bc_num_as, bc_num_addReq(a, b, scale));
+}
+
+void
+bc_num_mul(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_m, bc_num_mulReq(a, b, scale));
+}
+
+void
+bc_num_div(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_d, bc_num_divReq(a, b, scale));
+}
+
+void
+bc_num_mod(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_rem, bc_num_divReq(a, b, scale));
+}
+
+void
+bc_num_pow(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_p, bc_num_powReq(a, b, scale));
+}
+
+#if BC_ENABLE_EXTRA_MATH
+void
+bc_num_places(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_place, bc_num_placesReq(a, b, scale));
+}
+
+void
+bc_num_lshift(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_left, bc_num_placesReq(a, b, scale));
+}
+
+void
+bc_num_rshift(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	assert(BC_NUM_RDX_VALID(a));
+	assert(BC_NUM_RDX_VALID(b));
+	bc_num_binary(a, b, c, scale, bc_num_right, bc_num_placesReq(a, b, scale));
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+void
+bc_num_sqrt(BcNum* restrict a, BcNum* restrict b, size_t scale)
+{
+	BcNum n, m, num1, num2, num3, num4, half, one;
+	BcNum* y;
+	BcNum* t1;
+	BcNum* t2;
+	BcNum* t3;
+	BcNum* temp;
+	// realscale is meant to quiet a warning on GCC about longjmp() clobbering.
+	// This one is real.
+	size_t len, rdx, req, digs, e, w, nprecs, realscale;
+	size_t precs[sizeof(size_t) * CHAR_BIT];
+	BcBigDig top, x, z;
+	BcDig half_digs[1];
+	BcDig one_digs[1];
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(a != NULL && b != NULL && a != b);
+
+	if (BC_ERR(BC_NUM_NEG(a))) bc_err(BC_ERR_MATH_NEGATIVE);
+
+	// We want to calculate to a's scale if it is bigger so that the result will
+	// truncate properly.
+	if (a->scale > scale) realscale = a->scale;
+	else realscale = scale;
+
+	// Set parameters for the result.
+	len = bc_vm_growSize(bc_num_intDigits(a), 1);
+	rdx = BC_NUM_RDX(realscale);
+
+	// Square root needs half of the length of the parameter.
+	req = bc_vm_growSize(BC_MAX(rdx, BC_NUM_RDX_VAL(a)), len >> 1);
+	req = bc_vm_growSize(req, 1);
+
+	BC_SIG_LOCK;
+
+	// Unlike the binary operators, this function is the only single parameter
+	// function and is expected to initialize the result. This means that it
+	// expects that b is *NOT* preallocated. We allocate it here.
+	BC_NUM_INIT(b, req);
+
+	BC_SIG_UNLOCK;
+
+	assert(a != NULL && b != NULL && a != b);
+	assert(a->num != NULL && b->num != NULL);
+
+	// Easy case.
+	if (BC_NUM_ZERO(a))
+	{
+		bc_num_setToZero(b, realscale);
+		return;
+	}
+
+	// Another easy case.
+	if (BC_NUM_ONE(a))
+	{
+		bc_num_one(b);
+		bc_num_extend(b, realscale);
+		return;
+	}
+
+	BC_SIG_LOCK;
+
+	bc_num_createCopy(&n, a);
+	BC_NUM_INIT(&m, n.len);
+	BC_NUM_INIT(&num1, BC_NUM_DEF_SIZE);
+	BC_NUM_INIT(&num2, BC_NUM_DEF_SIZE);
+	BC_NUM_INIT(&num3, BC_NUM_DEF_SIZE);
+	BC_NUM_INIT(&num4, BC_NUM_DEF_SIZE);
+
+	// There is a division by two in the formula. We set up a number that's 1/2
+	// so that we can use multiplication instead of heavy division.
+	bc_num_setup(&half, half_digs, sizeof(half_digs) / sizeof(BcDig));
+	bc_num_setToZero(&half, 1);
+	half.num[0] = BC_BASE_POW / 2;
+	half.len = 1;
+	BC_NUM_RDX_SET_NP(half, 1);
+
+	bc_num_setup(&one, one_digs, sizeof(one_digs) / sizeof(BcDig));
+	bc_num_one(&one);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// Pointers for easy switching.
+	y = &num1;
+	t1 = &num2;
+	t2 = &num3;
+	t3 = &num4;
+
+	// The result is the integer square root of a * 10^(2 * realscale), shifted
+	// right by realscale places. Because realscale is at least a's scale, that
+	// product is an integer, and because a is nonzero, it is at least 1. This
+	// makes the result exact, i.e., truncated rather than just close.
+	bc_num_shiftLeft(&n, bc_vm_growSize(realscale, realscale));
+
+	assert(!n.scale && BC_NUM_NONZERO(&n));
+
+	// Find m = n / 10^(2e), which is in [0.01, 1). Then sqrt(n) is
+	// sqrt(m) * 10^e, and 1/sqrt(m) is in (1, 10].
+	digs = bc_num_intDigits(&n);
+	e = (digs + 1) / 2;
+	bc_num_copy(&m, &n);
+	bc_num_shiftRight(&m, e * 2);
+
+	// Estimate 1/sqrt(m) from the leading digits of m. Since m < 1, they fit in
+	// a BcBigDig, and an integer Newton's method from above gives their floor
+	// square root, which has BC_BASE_DIGS digits. Its inverse is accurate to
+	// BC_BASE_DIGS - 2 digits.
+	bc_num_copy(t1, &m);
+	bc_num_shiftLeft(t1, BC_BASE_DIGS * 2);
+	bc_num_truncate(t1, t1->scale);
+	top = bc_num_bigdig2(t1);
+
+	for (x = BC_BASE_POW, z = (x + top / x) / 2; z < x; z = (x + top / x) / 2)
+	{
+		x = z;
+	}
+
+	bc_num_bigdig2num(y, ((BcBigDig) BC_BASE_POW) * (BC_BASE_POW / 10) / x);
+	bc_num_shiftRight(y, BC_BASE_DIGS - 1);
+
+	// The iteration y = y + y * (1 - m * y^2) / 2 for 1/sqrt(m) needs no
+	// division and doubles the correct digits each time, so the precisions are
+	// worked out backwards from the one that is needed, e + 2 digits, and each
+	// step only works at the precision it produces.
+	for (nprecs = 0, w = e + 2; w > BC_BASE_DIGS - 2; w = (w + 2) / 2)
+	{
+		precs[nprecs] = w;
+		nprecs += 1;
+	}
+
+	while (nprecs)
+	{
+		nprecs -= 1;
+		w = precs[nprecs] + 3;
+
+		BC_NUM_POLL;
+
+		// m only needs a couple of guard digits past the working precision.
+		bc_num_copy(t3, &m);
+		if (t3->scale > w + 2) bc_num_truncate(t3, t3->scale - (w + 2));
+
+		bc_num_mul(y, y, t1, w);
+		bc_num_mul(t3, t1, t2, w);
+		bc_num_sub(&one, t2, t1, w);
+		bc_num_mul(y, t1, t2, w);
+		bc_num_mul(t2, &half, t1, w);
+		bc_num_add(y, t1, t2, w);
+
+		if (t2->scale > w) bc_num_truncate(t2, t2->scale - w);
+
+		// Switch.
+		temp = y;
+		y = t2;
+		t2 = temp;
+	}
+
+	// sqrt(n) = m * (1/sqrt(m)) * 10^e, and this is within 1 of it.
+	bc_num_mul(&m, y, t1, 0);
+	bc_num_shiftLeft(t1, e);
+	bc_num_truncate(t1, t1->scale);
+
+	// Fix the estimate, r, with r^2 in t2. Only the first square needs a
+	// multiplication; the rest follow from (r +/- 1)^2 = r^2 +/- 2r + 1.
+	bc_num_mul(t1, t1, t2, 0);
+
+	while (bc_num_cmp(t2, &n) > 0)
+	{
+		BC_NUM_POLL;
+
+		bc_num_sub(t1, &one, t3, 0);
+		bc_num_sub(t2, t1, y, 0);
+		bc_num_sub(y, t3, t2, 0);
+
+		// Switch.
+		temp = t1;
+		t1 = t3;
+		t3 = temp;
+	}
+
+	while (true)
+	{
+		BC_NUM_POLL;
+
+		// m is not needed anymore, so it is used as a temporary.
+		bc_num_add(t1, &one, t3, 0);
+		bc_num_add(t1, t3, &m, 0);
+		bc_num_add(t2, &m, y, 0);
+
+		if (bc_num_cmp(y, &n) > 0) break;
+
+		// Switch.
+		temp = t1;
+		t1 = t3;
+		t3 = temp;
+		temp = t2;
+		t2 = y;
+		y = temp;
+	}
+
+	// Copy to the result and shift.
+	bc_num_copy(b, t1);
+	bc_num_shiftRight(b, realscale);
+
+	assert(!BC_NUM_NEG(b) || BC_NUM_NONZERO(b));
+	assert(BC_NUM_RDX_VALID(b));
+	assert(BC_NUM_RDX_VAL(b) <= b->len || !b->len);
+	assert(!b->len || b->num[b->len - 1] || BC_NUM_RDX_VAL(b) == b->len);
+
+err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&num4);
+	BC_NUM_FREE(&num3);
+	BC_NUM_FREE(&num2);
+	BC_NUM_FREE(&num1);
+	BC_NUM_FREE(&m);
+	BC_NUM_FREE(&n);
+	BC_LONGJMP_CONT(vm);
+}
+
+void
+bc_num_divmod(BcNum* a, BcNum* b, BcNum* c, BcNum* d, size_t scale)
+{
+	size_t ts, len;
+	BcNum *ptr_a, num2;
+	// This is volatile to quiet a warning on GCC about clobbering with
+	// longjmp().
+	volatile bool init = false;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	// The bulk of this function is just doing what bc_num_binary() does for the
+	// binary operators. However, it assumes that only c and a can be equal.
+
+	// Set up the parameters.
+	ts = BC_MAX(scale + b->scale, a->scale);
+	len = bc_num_mulReq(a, b, ts);
+
+	assert(a != NULL && b != NULL && c != NULL && d != NULL);
+	assert(c != d && a != d && b != d && b != c);
+
+	// Initialize or expand as necessary.
+	if (c == a)
+	{
+		// NOLINTNEXTLINE
+		memcpy(&num2, c, sizeof(BcNum));
+		ptr_a = &num2;
 
-		// Store a value in base pow in the previous limb.
-		a[i - 1] = (BcDig) (acc % pow);
+		BC_SIG_LOCK;
 
-		// Divide by the base and accumulate the remaining value in the limb.
-		acc /= pow;
-		acc += (BcBigDig) a[i];
+		BC_NUM_INIT(c, len);
 
-		// If the accumulator is greater than the base...
-		if (acc >= BC_BASE_POW)
-		{
-			// Do we need to grow?
-			if (i == len - 1)
-			{
-				// Grow.
-				len = bc_vm_growSize(len, 1);
-				bc_num_expand(n, bc_vm_growSize(len, idx));
+		init = true;
 
-				// Update the pointer because it may have moved.
-				a = n->num + idx;
+		BC_SETJMP_LOCKED(vm, err);
 
-				// Zero out the last limb.
-				a[len - 1] = 0;
-			}
+		BC_SIG_UNLOCK;
+	}
+	else
+	{
+		ptr_a = a;
+		BC_NUM_EXPAND(c, len);
+	}
 
-			// Overflow into the next limb since we are over the base.
-			a[i + 1] += acc / BC_BASE_POW;
-			acc %= BC_BASE_POW;
-		}
+	// Do the quick version if possible.
+	if (BC_NUM_NONZERO(a) && !BC_NUM_RDX_VAL(a) && !BC_NUM_RDX_VAL(b) &&
+	    b->len == 1 && !scale)
+	{
+		BcBigDig rem;
 
-		assert(acc < BC_BASE_POW);
+		bc_num_divArray(ptr_a, (BcBigDig) b->num[0], c, &rem);
 
-		// Set the limb.
-		a[i] = (BcDig) acc;
+		assert(rem < BC_BASE_POW);
+
+		d->num[0] = (BcDig) rem;
+		d->len = (rem != 0);
 	}
+	// Do the slow method.
+	else bc_num_r(ptr_a, b, c, d, scale, ts);
 
-	// We may have grown the number, so adjust the length.
-	n->len = len + idx;
+	assert(!BC_NUM_NEG(c) || BC_NUM_NONZERO(c));
+	assert(BC_NUM_RDX_VALID(c));
+	assert(BC_NUM_RDX_VAL(c) <= c->len || !c->len);
+	assert(!c->len || c->num[c->len - 1] || BC_NUM_RDX_VAL(c) == c->len);
+	assert(!BC_NUM_NEG(d) || BC_NUM_NONZERO(d));
+	assert(BC_NUM_RDX_VALID(d));
+	assert(BC_NUM_RDX_VAL(d) <= d->len || !d->len);
+	assert(!d->len || d->num[d->len - 1] || BC_NUM_RDX_VAL(d) == d->len);
+
+err:
+	// Only cleanup if we initialized.
+	if (init)
+	{
+		BC_SIG_MAYLOCK;
+		BC_NUM_FREE(&num2);
+		BC_LONGJMP_CONT(vm);
+	}
 }
 
-/**
- * Prepares a number for printing in a base that does not have BC_BASE_POW as a
- * power. This basically converts the number from having limbs of base
- * BC_BASE_POW to limbs of pow, where pow is obase^N.
- * @param n    The number to prepare for printing.
- * @param rem  The remainder of BC_BASE_POW when divided by a power of the base.
- * @param pow  The power of the base.
- */
-static void
-bc_num_printPrepare(BcNum* restrict n, BcBigDig rem, BcBigDig pow)
+void
+bc_num_modexp(BcNum* a, BcNum* b, BcNum* c, BcNum* restrict d)
 {
-	size_t i;
+	BcNum base, exp, two, temp, atemp, btemp, ctemp;
+	BcDig two_digs[2];
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-	// Loop from the least significant limb to the most significant limb and
-	// convert limbs in each pass.
-	for (i = 0; i < n->len; ++i)
+	assert(a != NULL && b != NULL && c != NULL && d != NULL);
+	assert(a != d && b != d && c != d);
+
+	if (BC_ERR(BC_NUM_ZERO(c))) bc_err(BC_ERR_MATH_DIVIDE_BY_ZERO);
+	if (BC_ERR(BC_NUM_NEG(b))) bc_err(BC_ERR_MATH_NEGATIVE);
+
+#if BC_DEBUG || BC_GCC
+	// This is entirely for quieting a useless scan-build error.
+	btemp.len = 0;
+	ctemp.len = 0;
+#endif // BC_DEBUG || BC_GCC
+
+	// Eliminate fractional parts that are zero or error if they are not zero.
+	if (BC_ERR(bc_num_nonInt(a, &atemp) || bc_num_nonInt(b, &btemp) ||
+	           bc_num_nonInt(c, &ctemp)))
 	{
-		bc_num_printFixup(n, rem, pow, i);
+		bc_err(BC_ERR_MATH_NON_INTEGER);
 	}
 
-	// bc_num_printFixup() does not do everything it is supposed to, so we do
-	// the last bit of cleanup here. That cleanup is to ensure that each limb
-	// is less than pow and to expand the number to fit new limbs as necessary.
-	for (i = 0; i < n->len; ++i)
+	BC_NUM_EXPAND(d, ctemp.len);
+
+	BC_SIG_LOCK;
+
+	BC_NUM_INIT(&base, ctemp.len);
+	bc_num_setup(&two, two_digs, sizeof(two_digs) / sizeof(BcDig));
+	BC_NUM_INIT(&temp, btemp.len + 1);
+	bc_num_createCopy(&exp, &btemp);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_one(&two);
+	two.num[0] = 2;
+	bc_num_one(d);
+
+	// We already checked for 0.
+	bc_num_rem(&atemp, &ctemp, &base, 0);
+
+	// If you know the algorithm I used, the memory-efficient method, then this
+	// loop should be self-explanatory because it is the calculation loop.
+	while (BC_NUM_NONZERO(&exp))
 	{
-		assert(pow == ((BcBigDig) ((BcDig) pow)));
+		// Num two cannot be 0, so no errors.
+		bc_num_divmod(&exp, &two, &exp, &temp, 0);
 
-		// If the limb needs fixing...
-		if (n->num[i] >= (BcDig) pow)
+		if (BC_NUM_ONE(&temp) && !BC_NUM_NEG_NP(temp))
 		{
-			// Do we need to grow?
-			if (i + 1 == n->len)
-			{
-				// Grow the number.
-				n->len = bc_vm_growSize(n->len, 1);
-				bc_num_expand(n, n->len);
-
-				// Without this, we might use uninitialized data.
-				n->num[i + 1] = 0;
-			}
+			assert(BC_NUM_RDX_VALID(d));
+			assert(BC_NUM_RDX_VALID_NP(base));
 
-			assert(pow < BC_BASE_POW);
+			bc_num_mul(d, &base, &temp, 0);
 
-			// Overflow into the next limb.
-			n->num[i + 1] += n->num[i] / ((BcDig) pow);
-			n->num[i] %= (BcDig) pow;
+			// We already checked for 0.
+			bc_num_rem(&temp, &ctemp, d, 0);
 		}
+
+		assert(BC_NUM_RDX_VALID_NP(base));
+
+		bc_num_mul(&base, &base, &temp, 0);
+
+		// We already checked for 0.
+		bc_num_rem(&temp, &ctemp, &base, 0);
 	}
+
+err:
+	BC_SIG_MAYLOCK;
+	BC_NUM_FREE(&exp);
+	BC_NUM_FREE(&temp);
+	BC_NUM_FREE(&base);
+	BC_LONGJMP_CONT(vm);
+	assert(!BC_NUM_NEG(d) || d->len);
+	assert(BC_NUM_RDX_VALID(d));
+	assert(!d->len || d->num[d->len - 1] || BC_NUM_RDX_VAL(d) == d->len);
 }
 
+/**
+ * Initializes the temporaries of a math library function. Signals must be
+ * locked.
+ * @param t  The array of temporaries.
+ * @param n  The number of temporaries.
+ */
 static void
-bc_num_printNum(BcNum* restrict n, BcBigDig base, size_t len,
-                BcNumDigitOp print, bool newline)
+bc_num_temps(BcNum* t, size_t n)
 {
-	BcVec stack;
-	BcNum intp, fracp1, fracp2, digit, flen1, flen2;
-	BcNum* n1;
-	BcNum* n2;
-	BcNum* temp;
-	BcBigDig dig = 0, acc, exp;
-	BcBigDig* ptr;
-	size_t i, j, nrdx, idigits;
-	bool radix;
-	BcDig digit_digs[BC_NUM_BIGDIG_LOG10 + 1];
+	size_t i;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
 
-	assert(base > 1);
+	for (i = 0; i < n; ++i)
+	{
+		BC_NUM_INIT(t + i, BC_NUM_DEF_SIZE);
+	}
+}
 
-	// Easy case. Even with scale, we just print this.
-	if (BC_NUM_ZERO(n))
+/**
+ * Frees the temporaries of a math library function. Signals must be locked.
+ * @param t  The array of temporaries.
+ * @param n  The number of temporaries.
+ */
+static void
+bc_num_tempsFree(BcNum* t, size_t n)
+{
+	size_t i;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	for (i = 0; i < n; ++i)
 	{
-		print(0, len, false, !newline);
-		return;
+		if (t[i].num != NULL) BC_NUM_FREE(t + i);
 	}
+}
 
-	// This function uses an algorithm that Stefan Esser <se@freebsd.org> came
-	// up with to print the integer part of a number. What it does is convert
-	// intp into a number of the specified base, but it does it directly,
-	// instead of just doing a series of divisions and printing the remainders
-	// in reverse order.
-	//
-	// Let me explain in a bit more detail:
-	//
-	// The algorithm takes the current least significant limb (after intp has
-	// been converted to an integer) and the next to least significant limb, and
-	// it converts the least significant limb into one of the specified base,
-	// putting any overflow into the next to least significant limb. It iterates
-	// through the whole number, from least significant to most significant,
-	// doing this conversion. At the end of that iteration, the least
-	// significant limb is converted, but the others are not, so it iterates
-	// again, starting at the next to least significant limb. It keeps doing
-	// that conversion, skipping one more limb than the last time, until all
-	// limbs have been converted. Then it prints them in reverse order.
-	//
-	// That is the gist of the algorithm. It leaves out several things, such as
-	// the fact that limbs are not always converted into the specified base, but
-	// into something close, basically a power of the specified base. In
-	// Stefan's words, "You could consider BcDigs to be of base 10^BC_BASE_DIGS
-	// in the normal case and obase^N for the largest value of N that satisfies
-	// obase^N <= 10^BC_BASE_DIGS. [This means that] the result is not in base
-	// "obase", but in base "obase^N", which happens to be printable as a number
-	// of base "obase" without consideration for neighbouring BcDigs." This fact
-	// is what necessitates the existence of the loop later in this function.
-	//
-	// The conversion happens in bc_num_printPrepare() where the outer loop
-	// happens and bc_num_printFixup() where the inner loop, or actual
-	// conversion, happens. In other words, bc_num_printPrepare() is where the
-	// loop that starts at the least significant limb and goes to the most
-	// significant limb. Then, on every iteration of its loop, it calls
-	// bc_num_printFixup(), which has the inner loop of actually converting
-	// the limbs it passes into limbs of base obase^N rather than base
-	// BC_BASE_POW.
+/**
+ * Takes the square root of a number into a preallocated number, which
+ * bc_num_sqrt() cannot do. The result's old memory is freed first.
+ * @param a      The number.
+ * @param b      The return parameter. It must be initialized and not be @a a.
+ * @param scale  The current scale.
+ */
+static void
+bc_num_sqrtInto(BcNum* restrict a, BcNum* restrict b, size_t scale)
+{
+	BC_SIG_LOCK;
 
-	nrdx = BC_NUM_RDX_VAL(n);
+	bc_num_free(b);
 
-	BC_SIG_LOCK;
+	// Clear it so that it is not freed again if bc_num_sqrt() fails.
+	bc_num_clear(b);
 
-	// The stack is what allows us to reverse the digits for printing.
-	bc_vec_init(&stack, sizeof(BcBigDig), BC_DTOR_NONE);
-	bc_num_init(&fracp1, nrdx);
+	BC_SIG_UNLOCK;
 
-	// intp will be the "integer part" of the number, so copy it.
-	bc_num_createCopy(&intp, n);
+	bc_num_sqrt(a, b, scale);
+}
+
+/**
+ * Finds the integer @a k-th root of a positive integer with Newton's method.
+ * The first few digits of the root are found one at a time from the leading
+ * digits of @a n. After that, each step roughly doubles the number of digits,
+ * starting Newton's method from just above the root of the leading digits, so
+ * each step only needs one or two iterations at its own size.
+ * @param n  The number. It must be a positive integer.
+ * @param k  The degree of the root. It must be at least 2.
+ * @param r  The return value, the floor of the root. It must be preallocated
+ *           and not be @a n.
+ * @return   True if @a n is a perfect @a k-th power, false otherwise.
+ */
+static bool
+bc_num_iroot(BcNum* restrict n, BcBigDig k, BcNum* restrict r)
+{
+	BcNum t[6];
+	BcNum* lead = t;
+	BcNum* p = t + 1;
+	BcNum* v = t + 2;
+	BcNum* w = t + 3;
+	BcNum* kn = t + 4;
+	BcNum* km1 = t + 5;
+	size_t lens[sizeof(size_t) * CHAR_BIT];
+	size_t digs, e, g, len, prev, nlens, i;
+	BcBigDig d, lo, hi;
+	bool exact;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(n != NULL && r != NULL && n != r && k >= 2);
+	assert(!n->scale && BC_NUM_NONZERO(n) && !BC_NUM_NEG(n));
+
+	digs = bc_num_intDigits(n);
+
+	// If 2^k > n, the root is 1. 16^digs > n, so this is a safe test.
+	if (k / 4 >= digs)
+	{
+		bc_num_one(r);
+		return BC_NUM_ONE(n);
+	}
+
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	// Make intp an integer.
-	bc_num_truncate(&intp, intp.scale);
+	bc_num_bigdig2num(kn, k);
+	bc_num_bigdig2num(km1, k - 1);
 
-	// Get the fractional part out.
-	bc_num_sub(n, &intp, &fracp1, 0);
+	// The root has e digits. Each step adds a little less than its own number
+	// of digits; g digits are kept as guards so that the start for the next
+	// step is close enough. g is 1 more than the number of digits in k.
+	e = (size_t) (digs / k) + (digs % k != 0);
 
-	// If the base is not the same as the last base used for printing, we need
-	// to update the cached exponent and power. Yes, we cache the values of the
-	// exponent and power. That is to prevent us from calculating them every
-	// time because printing will probably happen multiple times on the same
-	// base.
-	if (base != vm->last_base)
+	for (g = 2, d = k; d >= BC_BASE; d /= BC_BASE)
 	{
-		vm->last_pow = 1;
-		vm->last_exp = 0;
-
-		// Calculate the exponent and power.
-		while (vm->last_pow * base <= BC_BASE_POW)
-		{
-			vm->last_pow *= base;
-			vm->last_exp += 1;
-		}
-
-		// Also, the remainder and base itself.
-		vm->last_rem = BC_BASE_POW - vm->last_pow;
-		vm->last_base = base;
+		g += 1;
 	}
 
-	exp = vm->last_exp;
-
-	// If vm->last_rem is 0, then the base we are printing in is a divisor of
-	// BC_BASE_POW, which is the easy case because it means that BC_BASE_POW is
-	// a power of obase, and no conversion is needed. If it *is* 0, then we have
-	// the hard case, and we have to prepare the number for the base.
-	if (vm->last_rem != 0)
+	for (nlens = 0, len = e; len > 2 * g + 1; len = (len + 1) / 2 + g)
 	{
-		bc_num_printPrepare(&intp, vm->last_rem, vm->last_pow);
+		lens[nlens] = len;
+		nlens += 1;
 	}
 
-	// After the conversion comes the surprisingly easy part. From here on out,
-	// this is basically naive code that I wrote, adjusted for the larger bases.
+	// Find the first len digits of the root one at a time with a binary search.
+	// The leading digits of n that they are the root of are the ones that are
+	// left after removing k times the number of root digits to be found later.
+	bc_num_copy(lead, n);
+	bc_num_shiftRight(lead, (size_t) k * (e - len));
+	bc_num_truncate(lead, lead->scale);
+
+	bc_num_zero(r);
 
-	// Fill the stack of digits for the integer part.
-	for (i = 0; i < intp.len; ++i)
+	for (i = len; i--;)
 	{
-		// Get the limb.
-		acc = (BcBigDig) intp.num[i];
+		BC_NUM_POLL;
 
-		// Turn the limb into digits of base obase.
-		for (j = 0; j < exp && (i < intp.len - 1 || acc != 0); ++j)
+		for (lo = 0, hi = BC_BASE - 1; lo < hi;)
 		{
-			// This condition is true if we are not at the last digit.
-			if (j != exp - 1)
-			{
-				dig = acc % base;
-				acc /= base;
-			}
-			else
-			{
-				dig = acc;
-				acc = 0;
-			}
+			d = (lo + hi + 1) / 2;
 
-			assert(dig < base);
+			bc_num_bigdig2num(v, d);
+			bc_num_shiftLeft(v, i);
+			bc_num_add(r, v, w, 0);
+			bc_num_pow(w, kn, v, 0);
 
-			// Push the digit onto the stack.
-			bc_vec_push(&stack, &dig);
+			if (bc_num_cmp(v, lead) <= 0) lo = d;
+			else hi = d - 1;
 		}
 
-		assert(acc == 0);
+		bc_num_bigdig2num(v, lo);
+		bc_num_shiftLeft(v, i);
+		bc_num_add(r, v, w, 0);
+		bc_num_copy(r, w);
 	}
 
-	// Go through the stack backwards and print each digit.
-	for (i = 0; i < stack.len; ++i)
+	bc_num_pow(r, kn, v, 0);
+
+	for (prev = len; nlens; prev = len)
 	{
-		ptr = bc_vec_item_rev(&stack, i);
+		nlens -= 1;
+		len = lens[nlens];
+
+		bc_num_copy(lead, n);
+		bc_num_shiftRight(lead, (size_t) k * (e - len));
+		bc_num_truncate(lead, lead->scale);
+
+		// Start just above the root, which is below (r + 1) * 10^(len - prev)
+		// because r is the exact root of the last step.
+		bc_num_one(w);
+		bc_num_add(r, w, v, 0);
+		bc_num_shiftLeft(v, len - prev);
+		bc_num_copy(r, v);
+
+		// Newton's method from above stays above the root until it reaches it,
+		// so the root is found as soon as r^k is not too big.
+		while (true)
+		{
+			BC_NUM_POLL;
 
-		assert(ptr != NULL);
+			bc_num_pow(r, km1, p, 0);
+			bc_num_mul(r, p, v, 0);
 
-		// While the first three arguments should be self-explanatory, the last
-		// needs explaining. I don't want to print a backslash+newline when the
-		// last digit to be printed could take the place of the backslash rather
-		// than being pushed, as a single character, to the next line. That's
-		// what that last argument does for bc.
-		//
-		// First, it needs to check if newlines are completely disabled. If they
-		// are not disabled, it needs to check the next part.
-		//
-		// If the number has a scale, then because we are printing just the
-		// integer part, there will be at least two more characters (a radix
-		// point plus at least one digit). So if there is a scale, a backslash
-		// is necessary.
-		//
-		// Finally, the last condition checks to see if we are at the end of the
-		// stack. If we are *not* (i.e., the index is not one less than the
-		// stack length), then a backslash is necessary because there is at
-		// least one more character for at least one more digit). Otherwise, if
-		// the index is equal to one less than the stack length, we want to
-		// disable backslash printing.
-		//
-		// The function that prints bases 17 and above will take care of not
-		// printing a backslash in the right case.
-		print(*ptr, len, false,
-		      !newline || (n->scale != 0 || i < stack.len - 1));
+			if (bc_num_cmp(v, lead) <= 0) break;
+
+			// r = ((k - 1) * r + lead / r^(k - 1)) / k
+			bc_num_div(lead, p, v, 0);
+			bc_num_mul(r, km1, w, 0);
+			bc_num_add(w, v, p, 0);
+			bc_num_div(p, kn, r, 0);
+		}
 	}
 
-	// We are done if there is no fractional part.
-	if (!n->scale) goto err;
+	// v is r^k.
+	exact = !bc_num_cmp(v, n);
 
-	BC_SIG_LOCK;
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 
-	// Reset the jump because some locals are changing.
-	BC_UNSETJMP(vm);
+	return exact;
+}
 
-	bc_num_init(&fracp2, nrdx);
-	bc_num_setup(&digit, digit_digs, sizeof(digit_digs) / sizeof(BcDig));
-	bc_num_init(&flen1, BC_NUM_BIGDIG_LOG10);
-	bc_num_init(&flen2, BC_NUM_BIGDIG_LOG10);
+void
+bc_num_root(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	BcNum t[3];
+	BcNum* x = t;
+	BcNum* n = t + 1;
+	BcNum* r = t + 2;
+	BcBigDig k;
+	bool neg;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-	BC_SETJMP_LOCKED(vm, frac_err);
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
+
+	if (BC_ERR(BC_NUM_NEG(b))) bc_err(BC_ERR_MATH_NEGATIVE);
+
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
+
+	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	bc_num_one(&flen1);
+	bc_num_copy(n, b);
+	bc_num_truncate(n, n->scale);
 
-	radix = true;
+	if (BC_ERR(BC_NUM_ZERO(n))) bc_err(BC_ERR_MATH_DIVIDE_BY_ZERO);
 
-	// Pointers for easy switching.
-	n1 = &flen1;
-	n2 = &flen2;
+	// Like the math library, these return a unchanged.
+	if (BC_NUM_ZERO(a) || BC_NUM_ONE(n))
+	{
+		bc_num_copy(c, a);
+		goto err;
+	}
 
-	fracp2.scale = n->scale;
-	BC_NUM_RDX_SET_NP(fracp2, BC_NUM_RDX(fracp2.scale));
+	k = bc_num_bigdig(n);
 
-	// As long as we have not reached the scale of the number, keep printing.
-	while ((idigits = bc_num_intDigits(n1)) <= n->scale)
+	if (k == 2)
 	{
-		// These numbers will keep growing.
-		bc_num_expand(&fracp2, fracp1.len + 1);
-		bc_num_mulArray(&fracp1, base, &fracp2);
+		bc_num_sqrtInto(a, c, scale);
+		goto err;
+	}
 
-		nrdx = BC_NUM_RDX_VAL_NP(fracp2);
+	neg = BC_NUM_NEG(a);
 
-		// Ensure an invariant.
-		if (fracp2.len < nrdx) fracp2.len = nrdx;
+	if (BC_ERR(neg && !(k & 1))) bc_err(BC_ERR_MATH_NEGATIVE);
 
-		// fracp is guaranteed to be non-negative and small enough.
-		dig = bc_num_bigdig2(&fracp2);
+	bc_num_copy(x, a);
+	BC_NUM_NEG_CLR(x);
 
-		// Convert the digit to a number and subtract it from the number.
-		bc_num_bigdig2num(&digit, dig);
-		bc_num_sub(&fracp2, &digit, &fracp1, 0);
+	// An integer that is a perfect power, or any integer if scale is 0, only
+	// needs an integer root.
+	bc_num_copy(n, x);
+	bc_num_truncate(n, n->scale);
 
-		// While the first three arguments should be self-explanatory, the last
-		// needs explaining. I don't want to print a newline when the last digit
-		// to be printed could take the place of the backslash rather than being
-		// pushed, as a single character, to the next line. That's what that
-		// last argument does for bc.
-		print(dig, len, radix, !newline || idigits != n->scale);
+	if (BC_NUM_NONZERO(n) && !bc_num_cmp(n, x) &&
+	    (bc_num_iroot(n, k, r) || !scale))
+	{
+		bc_num_extend(r, scale);
+	}
+	else
+	{
+		// Otherwise, the result is the integer root of x * 10^(k * scale),
+		// shifted right by scale places. That is the root truncated to scale
+		// places, which is what the math library returns.
+		if (BC_ERR(scale && k > SIZE_MAX / scale))
+		{
+			bc_err(BC_ERR_MATH_OVERFLOW);
+		}
 
-		// Update the multipliers.
-		bc_num_mulArray(n1, base, n2);
+		bc_num_shiftLeft(x, (size_t) k * scale);
+		bc_num_truncate(x, x->scale);
 
-		radix = false;
+		if (BC_NUM_ZERO(x)) bc_num_zero(r);
+		else bc_num_iroot(x, k, r);
 
-		// Switch.
-		temp = n1;
-		n1 = n2;
-		n2 = temp;
+		bc_num_shiftRight(r, scale);
 	}
 
-frac_err:
-	BC_SIG_MAYLOCK;
-	bc_num_free(&flen2);
-	bc_num_free(&flen1);
-	bc_num_free(&fracp2);
+	if (neg && BC_NUM_NONZERO(r)) BC_NUM_NEG_TGL(r);
+
+	bc_num_copy(c, r);
+
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&fracp1);
-	bc_num_free(&intp);
-	bc_vec_free(&stack);
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
 	BC_LONGJMP_CONT(vm);
 }
 
 /**
- * Prints a number in the specified base, or rather, figures out which function
- * to call to print the number in the specified base and calls it.
- * @param n        The number to print.
- * @param base     The base to print in.
- * @param newline  Whether to print backslash+newlines on long enough lines.
+ * Finds the cofactors for as many steps of Euclid's algorithm on @a x and @a y
+ * as the leading limbs of @a x and @a y can determine. This is the inner loop
+ * of Lehmer's algorithm. The quotients of the leading limbs are only used if
+ * they are the same for every value that the rest of the limbs could have.
+ * @param x  The larger number. It must be a positive integer.
+ * @param y  The smaller number. It must be a positive integer with at most one
+ *           limb fewer than @a x.
+ * @param m  An out parameter for the cofactors. After the steps, x is
+ *           m[0] * x - m[1] * y, and y is m[3] * y - m[2] * x, both negated if
+ *           the number of steps is odd. All cofactors are less than
+ *           BC_BASE_POW.
+ * @return   The number of steps that the cofactors make.
  */
-static void
-bc_num_printBase(BcNum* restrict n, BcBigDig base, bool newline)
+static size_t
+bc_num_lehmer(const BcNum* restrict x, const BcNum* restrict y, BcBigDig m[4])
 {
-	size_t width;
-	BcNumDigitOp print;
-	bool neg = BC_NUM_NEG(n);
+	BcBigDig xh, yh, a, b, c, d, q, t, xlo, xhi, ylo, yhi;
+	size_t i, idx, steps;
 
-	// Clear the sign because it makes the actual printing easier when we have
-	// to do math.
-	BC_NUM_NEG_CLR(n);
+	assert(x->len >= y->len && x->len - y->len < 2);
+	assert(!BC_NUM_RDX_VAL(x) && !BC_NUM_RDX_VAL(y));
 
-	// Bases at hexadecimal and below are printed as one character, larger bases
-	// are printed as a series of digits separated by spaces.
-	if (base <= BC_NUM_MAX_POSIX_IBASE)
+	// Get (up to) the two leading limbs of x, and the limbs of y at the same
+	// places. Two limbs always fit into a BcBigDig.
+	for (i = 0, xh = yh = 0; i < BC_MIN(x->len, 2); ++i)
 	{
-		width = 1;
-		print = bc_num_printHex;
+		idx = x->len - 1 - i;
+		xh = xh * BC_BASE_POW + (BcBigDig) x->num[idx];
+		yh = yh * BC_BASE_POW + (idx < y->len ? (BcBigDig) y->num[idx] : 0);
 	}
-	else
+
+	a = d = 1;
+	b = c = 0;
+
+	for (steps = 0; true; ++steps)
 	{
-		assert(base <= BC_BASE_POW);
-		width = bc_num_log10(base - 1);
-		print = bc_num_printDigits;
+		// Because the limbs that were cut off are unknown, the real x and y
+		// are somewhere in these ranges. The signs of the cofactors alternate,
+		// so which cofactor bounds which side alternates too.
+		if (steps & 1)
+		{
+			if (xh < a || yh <= d) break;
+
+			xlo = xh - a;
+			xhi = xh + b;
+			ylo = yh - d;
+			yhi = yh + c;
+		}
+		else
+		{
+			if (xh < b || yh <= c) break;
+
+			xlo = xh - b;
+			xhi = xh + a;
+			ylo = yh - c;
+			yhi = yh + d;
+		}
+
+		// Stop if the quotient is not the same over the ranges.
+		q = xlo / yhi;
+		if (q != xhi / ylo) break;
+
+		// Stop if the cofactors would not fit in a limb anymore.
+		if (c && q > (BC_BASE_POW - 1 - a) / c) break;
+		if (q > (BC_BASE_POW - 1 - b) / d) break;
+
+		t = xh - q * yh;
+		xh = yh;
+		yh = t;
+
+		t = a + q * c;
+		a = c;
+		c = t;
+
+		t = b + q * d;
+		b = d;
+		d = t;
+	}
+
+	m[0] = a;
+	m[1] = b;
+	m[2] = c;
+	m[3] = d;
+
+	return steps;
+}
+
+/**
+ * Sets @a r to a * x - b * y, or to b * y - a * x if @a neg is true, in one
+ * pass over the limbs. The result must be known to be non-negative.
+ * @param x    The first number. It must be a non-negative integer.
+ * @param y    The second number. It must be a non-negative integer.
+ * @param a    The cofactor of @a x. It must be less than BC_BASE_POW.
+ * @param b    The cofactor of @a y. It must be less than BC_BASE_POW.
+ * @param neg  True if the result should be negated.
+ * @param r    The return parameter.
+ */
+static void
+bc_num_lehmerArray(const BcNum* restrict x, const BcNum* restrict y,
+                   BcBigDig a, BcBigDig b, bool neg, BcNum* restrict r)
+{
+	const BcNum* p = neg ? y : x;
+	const BcNum* q = neg ? x : y;
+	BcBigDig pm = neg ? b : a;
+	BcBigDig qm = neg ? a : b;
+	BcBigDig pc = 0, qc = 0, pv, qv;
+	size_t i, len = BC_MAX(x->len, y->len);
+
+	assert(!BC_NUM_NEG(x) && !BC_NUM_NEG(y));
+	assert(!BC_NUM_RDX_VAL(x) && !BC_NUM_RDX_VAL(y));
+	assert(a < BC_BASE_POW && b < BC_BASE_POW);
+
+	if (len > r->cap) bc_num_expand(r, len);
+
+	// The products are kept apart with their own carries, and the borrow of
+	// the subtraction is added to the carry of the one that is subtracted.
+	for (i = 0; i < len; ++i)
+	{
+		pv = (i < p->len ? (BcBigDig) p->num[i] : 0) * pm + pc;
+		pc = pv / BC_BASE_POW;
+		pv %= BC_BASE_POW;
+
+		qv = (i < q->len ? (BcBigDig) q->num[i] : 0) * qm + qc;
+		qc = qv / BC_BASE_POW;
+		qv %= BC_BASE_POW;
+
+		if (pv < qv)
+		{
+			pv += BC_BASE_POW;
+			qc += 1;
+		}
+
+		r->num[i] = (BcDig) (pv - qv);
 	}
 
-	// Print.
-	bc_num_printNum(n, base, width, print, newline);
+	// The result is non-negative and no bigger than the inputs, so the rest
+	// of the products must cancel.
+	assert(pc == qc);
+
+	r->len = len;
+	r->rdx = 0;
+	r->scale = 0;
+
+	bc_num_clean(r);
+}
+
+/**
+ * Sets @a r to a * x - b * y, negated if @a neg is true.
+ * @param x    The first number.
+ * @param y    The second number.
+ * @param a    The cofactor of @a x. It must be less than BC_BASE_POW.
+ * @param b    The cofactor of @a y. It must be less than BC_BASE_POW.
+ * @param neg  True if the result should be negated.
+ * @param r    The return parameter.
+ * @param t    An array of 4 temporaries.
+ */
+static void
+bc_num_lehmerMul(BcNum* x, BcNum* y, BcBigDig a, BcBigDig b, bool neg,
+                 BcNum* restrict r, BcNum* restrict t)
+{
+	// The cofactors have one limb, so these multiplications are linear.
+	bc_num_bigdig2num(t, a);
+	bc_num_bigdig2num(t + 1, b);
+	bc_num_mul(x, t, t + 2, 0);
+	bc_num_mul(y, t + 1, t + 3, 0);
+	bc_num_sub(t + 2, t + 3, r, 0);
+
+	if (neg && BC_NUM_NONZERO(r)) BC_NUM_NEG_TGL(r);
+}
+
+/**
+ * Computes the greatest common divisor of two integers with Lehmer's algorithm
+ * and, if asked for, the cofactor that makes it a modular inverse. Each step
+ * either combines @a a and @a b with the cofactors from bc_num_lehmer(), which
+ * is linear, or, if the leading limbs cannot decide a quotient, does one
+ * division like Euclid's algorithm.
+ * @param a  The larger number. It must be a positive integer.
+ * @param b  The smaller number. It must be a non-negative integer that is not
+ *           larger than @a a.
+ * @param g  The return parameter for the greatest common divisor.
+ * @param u  If not NULL, the return parameter for the cofactor of @a b, which
+ *           makes u * b - g a multiple of @a a. Its magnitude is less than
+ *           @a a.
+ */
+static void
+bc_num_gcdx(BcNum* a, BcNum* b, BcNum* restrict g, BcNum* restrict u)
+{
+	BcNum t[12];
+	BcNum* x = t;
+	BcNum* y = t + 1;
+	BcNum* nx = t + 2;
+	BcNum* ny = t + 3;
+	BcNum* ux = t + 4;
+	BcNum* uy = t + 5;
+	BcNum* nux = t + 6;
+	BcNum* nuy = t + 7;
+	BcNum* s = t + 8;
+	BcNum* temp;
+	BcBigDig m[4];
+	BcBigDig xv, yv, tv;
+	size_t steps, i;
+	bool odd;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
+
+	assert(a != NULL && b != NULL && g != NULL && g != u);
+	assert(!a->scale && BC_NUM_NONZERO(a) && !BC_NUM_NEG(a));
+	assert(!b->scale && !BC_NUM_NEG(b) && bc_num_cmp(a, b) >= 0);
+
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
+
+	BC_SETJMP_LOCKED(vm, err);
 
-	// Reset the sign.
-	n->rdx = BC_NUM_NEG_VAL(n, neg);
-}
+	BC_SIG_UNLOCK;
 
-#if !BC_ENABLE_LIBRARY
+	bc_num_copy(x, a);
+	bc_num_copy(y, b);
 
-void
-bc_num_stream(BcNum* restrict n)
-{
-	bc_num_printNum(n, BC_NUM_STREAM_BASE, 1, bc_num_printChar, false);
-}
+	// x is 0 * b and y is 1 * b, modulo a.
+	bc_num_zero(ux);
+	bc_num_one(uy);
 
-#endif // !BC_ENABLE_LIBRARY
+	while (BC_NUM_NONZERO(y))
+	{
+		BC_NUM_POLL;
 
-void
-bc_num_setup(BcNum* restrict n, BcDig* restrict num, size_t cap)
-{
-	assert(n != NULL);
-	n->num = num;
-	n->cap = cap;
-	bc_num_zero(n);
-}
+		// Without a cofactor to keep, two limbs finish in hardware.
+		if (u == NULL && x->len <= 2)
+		{
+			for (i = x->len, xv = yv = 0; i--;)
+			{
+				xv = xv * BC_BASE_POW + (BcBigDig) x->num[i];
+				yv *= BC_BASE_POW;
+				if (i < y->len) yv += (BcBigDig) y->num[i];
+			}
 
-void
-bc_num_init(BcNum* restrict n, size_t req)
-{
-	BcDig* num;
+			while (yv)
+			{
+				tv = xv % yv;
+				xv = yv;
+				yv = tv;
+			}
 
-	BC_SIG_ASSERT_LOCKED;
+			bc_num_bigdig2num(x, xv);
 
-	assert(n != NULL);
+			break;
+		}
 
-	// BC_NUM_DEF_SIZE is set to be about the smallest allocation size that
-	// malloc() returns in practice, so just use it.
-	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
+		steps = x->len - y->len < 2 ? bc_num_lehmer(x, y, m) : 0;
 
-	// If we can't use a temp, allocate.
-	if (req != BC_NUM_DEF_SIZE) num = bc_vm_malloc(BC_NUM_SIZE(req));
-	else
-	{
-		num = bc_vm_getTemp() == NULL ? bc_vm_malloc(BC_NUM_SIZE(req)) :
-		                                bc_vm_takeTemp();
-	}
+		if (steps)
+		{
+			odd = ((steps & 1) != 0);
 
-	bc_num_setup(n, num, req);
-}
+			bc_num_lehmerArray(x, y, m[0], m[1], odd, nx);
+			bc_num_lehmerArray(x, y, m[2], m[3], !odd, ny);
 
-void
-bc_num_clear(BcNum* restrict n)
-{
-	n->num = NULL;
-	n->cap = 0;
-}
+			temp = x;
+			x = nx;
+			nx = temp;
 
-void
-bc_num_free(void* num)
-{
-	BcNum* n = (BcNum*) num;
+			temp = y;
+			y = ny;
+			ny = temp;
 
-	BC_SIG_ASSERT_LOCKED;
+			if (u != NULL)
+			{
+				bc_num_lehmerMul(ux, uy, m[0], m[1], odd, nux, s);
+				bc_num_lehmerMul(ux, uy, m[2], m[3], !odd, nuy, s);
 
-	assert(n != NULL);
+				temp = ux;
+				ux = nux;
+				nux = temp;
 
-	if (n->cap == BC_NUM_DEF_SIZE) bc_vm_addTemp(n->num);
-	else free(n->num);
-}
+				temp = uy;
+				uy = nuy;
+				nuy = temp;
+			}
+		}
+		else
+		{
+			// One step of Euclid's algorithm. s is the quotient.
+			bc_num_divmod(x, y, s, ny, 0);
 
-void
-bc_num_copy(BcNum* d, const BcNum* s)
-{
-	assert(d != NULL && s != NULL);
+			temp = x;
+			x = y;
+			y = ny;
+			ny = temp;
 
-	if (d == s) return;
+			if (u != NULL)
+			{
+				bc_num_mul(s, uy, s + 1, 0);
+				bc_num_sub(ux, s + 1, nuy, 0);
 
-	bc_num_expand(d, s->len);
-	d->len = s->len;
+				temp = ux;
+				ux = uy;
+				uy = nuy;
+				nuy = temp;
+			}
+		}
+	}
 
-	// I can just copy directly here because the sign *and* rdx will be
-	// properly preserved.
-	d->rdx = s->rdx;
-	d->scale = s->scale;
-	// NOLINTNEXTLINE
-	memcpy(d->num, s->num, BC_NUM_SIZE(d->len));
-}
+	bc_num_copy(g, x);
+	if (u != NULL) bc_num_copy(u, ux);
 
-void
-bc_num_createCopy(BcNum* d, const BcNum* s)
-{
-	BC_SIG_ASSERT_LOCKED;
-	bc_num_init(d, s->len);
-	bc_num_copy(d, s);
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
 
 void
-bc_num_createFromBigdig(BcNum* restrict n, BcBigDig val)
-{
-	BC_SIG_ASSERT_LOCKED;
-	bc_num_init(n, BC_NUM_BIGDIG_LOG10);
-	bc_num_bigdig2num(n, val);
-}
-
-size_t
-bc_num_scale(const BcNum* restrict n)
+bc_num_gcd(BcNum* a, BcNum* b, BcNum* c, size_t scale)
 {
-	return n->scale;
-}
+	BcNum t[2];
+	BcNum* x = t;
+	BcNum* y = t + 1;
+	BcNum* temp;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-size_t
-bc_num_len(const BcNum* restrict n)
-{
-	size_t len = n->len;
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
 
-	// Always return at least 1.
-	if (BC_NUM_ZERO(n)) return n->scale ? n->scale : 1;
+	BC_UNUSED(scale);
 
-	// If this is true, there is no integer portion of the number.
-	if (BC_NUM_RDX_VAL(n) == len)
+	// Like the math library, this returns a unchanged if b is zero.
+	if (BC_NUM_ZERO(b))
 	{
-		// We have to take into account the fact that some of the digits right
-		// after the decimal could be zero. If that is the case, we need to
-		// ignore them until we hit the first non-zero digit.
+		bc_num_copy(c, a);
+		return;
+	}
 
-		size_t zero, scale;
+	BC_SIG_LOCK;
 
-		// The number of limbs with non-zero digits.
-		len = bc_num_nonZeroLen(n);
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-		// Get the number of digits in the last limb.
-		scale = n->scale % BC_BASE_DIGS;
-		scale = scale ? scale : BC_BASE_DIGS;
+	BC_SETJMP_LOCKED(vm, err);
 
-		// Get the number of zero digits.
-		zero = bc_num_zeroDigits(n->num + len - 1);
+	BC_SIG_UNLOCK;
 
-		// Calculate the true length.
-		len = len * BC_BASE_DIGS - zero - (BC_BASE_DIGS - scale);
+	bc_num_copy(x, a);
+	BC_NUM_NEG_CLR(x);
+	bc_num_truncate(x, x->scale);
+
+	bc_num_copy(y, b);
+	BC_NUM_NEG_CLR(y);
+	bc_num_truncate(y, y->scale);
+
+	if (bc_num_cmp(x, y) < 0)
+	{
+		temp = x;
+		x = y;
+		y = temp;
 	}
-	// Otherwise, count the number of int digits and return that plus the scale.
-	else len = bc_num_intDigits(n) + n->scale;
 
-	return len;
+	if (BC_NUM_ZERO(x)) bc_num_setToZero(c, 0);
+	else bc_num_gcdx(x, y, c, NULL);
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
 
 void
-bc_num_parse(BcNum* restrict n, const char* restrict val, BcBigDig base)
+bc_num_lcm(BcNum* a, BcNum* b, BcNum* c, size_t scale)
 {
-#if BC_DEBUG
+	BcNum t[3];
+	BcNum* x = t;
+	BcNum* y = t + 1;
+	BcNum* z = t + 2;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
-#endif // BC_DEBUG
 
-	assert(n != NULL && val != NULL && base);
-	assert(base >= BC_NUM_MIN_BASE && base <= vm->maxes[BC_PROG_GLOBALS_IBASE]);
-	assert(bc_num_strValid(val));
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
 
-	// A one character number is *always* parsed as though the base was the
-	// maximum allowed ibase, per the bc spec.
-	if (!val[1])
+	BC_UNUSED(scale);
+
+	if (BC_NUM_ZERO(a) && BC_NUM_ZERO(b))
 	{
-		BcBigDig dig = bc_num_parseChar(val[0], BC_NUM_MAX_LBASE);
-		bc_num_bigdig2num(n, dig);
+		bc_num_setToZero(c, 0);
+		return;
 	}
-	else if (base == BC_BASE) bc_num_parseDecimal(n, val);
-	else bc_num_parseBase(n, val, base);
 
-	assert(BC_NUM_RDX_VALID(n));
-}
+	BC_SIG_LOCK;
 
-void
-bc_num_print(BcNum* restrict n, BcBigDig base, bool newline)
-{
-	assert(n != NULL);
-	assert(BC_ENABLE_EXTRA_MATH || base >= BC_NUM_MIN_BASE);
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-	// We may need a newline, just to start.
-	bc_num_printNewline();
+	BC_SETJMP_LOCKED(vm, err);
 
-	if (BC_NUM_NONZERO(n))
-	{
-#if BC_ENABLE_LIBRARY
-		BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
+	BC_SIG_UNLOCK;
 
-		// Print the sign.
-		if (BC_NUM_NEG(n)) bc_num_putchar('-', true);
+	bc_num_copy(x, a);
+	BC_NUM_NEG_CLR(x);
+	bc_num_truncate(x, x->scale);
 
-		// Print the leading zero if necessary. We don't print when using
-		// scientific or engineering modes.
-		if (BC_Z && BC_NUM_RDX_VAL(n) == n->len && base != 0 && base != 1)
-		{
-			bc_num_printHex(0, 1, false, !newline);
-		}
-	}
+	bc_num_copy(y, b);
+	BC_NUM_NEG_CLR(y);
+	bc_num_truncate(y, y->scale);
 
-	// Short-circuit 0.
-	if (BC_NUM_ZERO(n)) bc_num_printHex(0, 1, false, !newline);
-	else if (base == BC_BASE) bc_num_printDecimal(n, newline);
-#if BC_ENABLE_EXTRA_MATH
-	else if (base == 0 || base == 1)
-	{
-		bc_num_printExponent(n, base != 0, newline);
-	}
-#endif // BC_ENABLE_EXTRA_MATH
-	else bc_num_printBase(n, base, newline);
+	// This is a*b/gcd(a,b) at scale 0.
+	bc_num_gcd(x, y, z, 0);
+	bc_num_mul(x, y, x, 0);
+	bc_num_div(x, z, c, 0);
 
-	if (newline) bc_num_putchar('\n', false);
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
 
-BcBigDig
-bc_num_bigdig2(const BcNum* restrict n)
+void
+bc_num_modinv(BcNum* a, BcNum* b, BcNum* c, size_t scale)
 {
-#if BC_DEBUG
+	BcNum atemp, btemp;
+	BcNum t[3];
+	BcNum* x = t;
+	BcNum* m = t + 1;
+	BcNum* g = t + 2;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
-#endif // BC_DEBUG
 
-	// This function returns no errors because it's guaranteed to succeed if
-	// its preconditions are met. Those preconditions include both n needs to
-	// be non-NULL, n being non-negative, and n being less than vm->max. If all
-	// of that is true, then we can just convert without worrying about negative
-	// errors or overflow.
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
 
-	BcBigDig r = 0;
-	size_t nrdx = BC_NUM_RDX_VAL(n);
+	BC_UNUSED(scale);
 
-	assert(n != NULL);
-	assert(!BC_NUM_NEG(n));
-	assert(bc_num_cmp(n, &vm->max) < 0);
-	assert(n->len - nrdx <= 3);
+	if (BC_ERR(BC_NUM_ZERO(b))) bc_err(BC_ERR_MATH_DIVIDE_BY_ZERO);
 
-	// There is a small speed win from unrolling the loop here, and since it
-	// only adds 53 bytes, I decided that it was worth it.
-	switch (n->len - nrdx)
+	// Eliminate fractional parts that are zero or error if they are not zero.
+	if (BC_ERR(bc_num_nonInt(a, &atemp) || bc_num_nonInt(b, &btemp)))
 	{
-		case 3:
-		{
-			r = (BcBigDig) n->num[nrdx + 2];
+		bc_err(BC_ERR_MATH_NON_INTEGER);
+	}
 
-			// Fallthrough.
-			BC_FALLTHROUGH
-		}
+	BC_SIG_LOCK;
 
-		case 2:
-		{
-			r = r * BC_BASE_POW + (BcBigDig) n->num[nrdx + 1];
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-			// Fallthrough.
-			BC_FALLTHROUGH
-		}
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// The sign of the modulus does not matter.
+	bc_num_copy(m, &btemp);
+	BC_NUM_NEG_CLR(m);
+
+	// Reduce a into [0, m).
+	bc_num_rem(&atemp, m, g, 0);
+
+	if (BC_NUM_NEG(g)) bc_num_add(g, m, x, 0);
+	else bc_num_copy(x, g);
+
+	bc_num_gcdx(m, x, g, c);
+
+	// If a and b are not coprime, there is no inverse, which is like dividing
+	// by zero modulo b.
+	if (BC_ERR(!BC_NUM_ONE(g))) bc_err(BC_ERR_MATH_DIVIDE_BY_ZERO);
+
+	// The cofactor is in (-m, m), so it needs at most one correction.
+	if (BC_NUM_NEG(c))
+	{
+		bc_num_add(c, m, x, 0);
+		bc_num_copy(c, x);
+	}
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
+
+/**
+ * Returns the exponent of the prime @a p in @a n!, using Legendre's formula.
+ * @param n  The number whose factorial is factored.
+ * @param p  The prime.
+ * @return   The exponent of @a p in @a n!.
+ */
+static BcBigDig
+bc_num_legendre(BcBigDig n, BcBigDig p)
+{
+	BcBigDig e = 0;
 
-		case 1:
-		{
-			r = r * BC_BASE_POW + (BcBigDig) n->num[nrdx];
-		}
+	while (n >= p)
+	{
+		n /= p;
+		e += n;
 	}
 
-	return r;
+	return e;
 }
 
-BcBigDig
-bc_num_bigdig(const BcNum* restrict n)
+/**
+ * Pushes a leaf onto a product tree. The tree works like a binary counter:
+ * level i holds the product of 2^i leaves, and it is in use if bit i of the
+ * number of leaves is set. That way, every multiplication has operands of about
+ * the same size, which is where Karatsuba pays off.
+ * @param s  The tree. Element BC_NUM_PROD_DEPTH is the leaf to push, and
+ *           element BC_NUM_PROD_DEPTH + 1 is scratch space.
+ * @param n  In and out parameter; the number of leaves in the tree.
+ */
+static void
+bc_num_prodPush(BcNum** s, size_t* n)
 {
-#if BC_ENABLE_LIBRARY
-	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
+	BcNum* temp;
+	size_t i;
 
-	assert(n != NULL);
+	// Carry the leaf up the tree, like adding 1 to a binary number.
+	for (i = 0; (*n >> i) & 1; ++i)
+	{
+		bc_num_mul(s[i], s[BC_NUM_PROD_DEPTH], s[BC_NUM_PROD_DEPTH + 1], 0);
 
-	// This error checking is extremely important, and if you do not have a
-	// guarantee that converting a number will always succeed in a particular
-	// case, you *must* call this function to get these error checks. This
-	// includes all instances of numbers inputted by the user or calculated by
-	// the user. Otherwise, you can call the faster bc_num_bigdig2().
-	if (BC_ERR(BC_NUM_NEG(n))) bc_err(BC_ERR_MATH_NEGATIVE);
-	if (BC_ERR(bc_num_cmp(n, &vm->max) >= 0)) bc_err(BC_ERR_MATH_OVERFLOW);
+		temp = s[BC_NUM_PROD_DEPTH];
+		s[BC_NUM_PROD_DEPTH] = s[BC_NUM_PROD_DEPTH + 1];
+		s[BC_NUM_PROD_DEPTH + 1] = temp;
+	}
 
-	return bc_num_bigdig2(n);
+	temp = s[i];
+	s[i] = s[BC_NUM_PROD_DEPTH];
+	s[BC_NUM_PROD_DEPTH] = temp;
+
+	*n += 1;
 }
 
-void
-bc_num_bigdig2num(BcNum* restrict n, BcBigDig val)
+/**
+ * Multiplies a factor into a product tree. Factors are packed into a BcBigDig
+ * while they fit, so that leaves are not tiny.
+ * @param s    The tree.
+ * @param n    In and out parameter; the number of leaves in the tree.
+ * @param acc  In and out parameter; the factors that are not in the tree yet.
+ * @param x    The factor. It must not be 0.
+ */
+static void
+bc_num_prodDig(BcNum** s, size_t* n, BcBigDig* acc, BcBigDig x)
 {
-	BcDig* ptr;
-	size_t i;
-
-	assert(n != NULL);
+	assert(x != 0);
 
-	bc_num_zero(n);
+	if (*acc > BC_NUM_BIGDIG_MAX / x)
+	{
+		bc_num_bigdig2num(s[BC_NUM_PROD_DEPTH], *acc);
+		bc_num_prodPush(s, n);
+		*acc = x;
+	}
+	else *acc *= x;
+}
 
-	// Already 0.
-	if (!val) return;
+/**
+ * Collapses a product tree into its product.
+ * @param s    The tree.
+ * @param n    The number of leaves in the tree.
+ * @param acc  The factors that are not in the tree yet.
+ * @param r    The return parameter.
+ */
+static void
+bc_num_prodEnd(BcNum** s, size_t n, BcBigDig acc, BcNum* restrict r)
+{
+	size_t i;
 
-	// Expand first. This is the only way this function can fail, and it's a
-	// fatal error.
-	bc_num_expand(n, BC_NUM_BIGDIG_LOG10);
+	bc_num_bigdig2num(r, acc);
 
-	// The conversion is easy because numbers are laid out in little-endian
-	// order.
-	for (ptr = n->num, i = 0; val; ++i, val /= BC_BASE_POW)
+	// Going up from the smallest level keeps the operands close in size.
+	for (i = 0; n; ++i, n >>= 1)
 	{
-		ptr[i] = val % BC_BASE_POW;
-	}
+		if (!(n & 1)) continue;
 
-	n->len = i;
+		bc_num_mul(s[i], r, s[BC_NUM_PROD_DEPTH], 0);
+		bc_num_copy(r, s[BC_NUM_PROD_DEPTH]);
+	}
 }
 
-#if BC_ENABLE_EXTRA_MATH
-
-void
-bc_num_rng(const BcNum* restrict n, BcRNG* rng)
+/**
+ * Calculates n!/(m!k!), where m + k <= n, from its prime factorization. The
+ * exponent of each prime comes from Legendre's formula. The product of the
+ * prime powers is built from the top bit of the exponents down: square, then
+ * multiply by the product of the primes that have the current bit set. The work
+ * is then in a few squarings and balanced products of primes, instead of in n
+ * products of a big number and a small one.
+ * @param n  The number whose factorial is the numerator.
+ * @param m  The number whose factorial is the first denominator.
+ * @param k  The number whose factorial is the second denominator.
+ * @param r  The return parameter.
+ */
+static void
+bc_num_factorials(BcBigDig n, BcBigDig m, BcBigDig k, BcNum* restrict r)
 {
-	BcNum temp, temp2, intn, frac;
-	BcRand state1, state2, inc1, inc2;
-	size_t nrdx = BC_NUM_RDX_VAL(n);
+	BcNum t[BC_NUM_PROD_DEPTH + 4];
+	BcNum* s[BC_NUM_PROD_DEPTH + 2];
+	BcNum* sq = t + BC_NUM_PROD_DEPTH + 2;
+	BcNum* prod = t + BC_NUM_PROD_DEPTH + 3;
+	uchar* sieve;
+	size_t i, j, h, len;
+	BcBigDig p, e, bit, lim, acc;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
 
-	// This function holds the secret of how I interpret a seed number for the
-	// PRNG. Well, it's actually in the development manual
-	// (manuals/development.md#pseudo-random-number-generator), so look there
-	// before you try to understand this.
+	assert(m <= n && k <= n - m && n <= BC_NUM_SIEVE_MAX);
+
+	// The sieve only has odd numbers; index i stands for 2i + 1.
+	h = n ? (size_t) ((n - 1) / 2) : 0;
 
 	BC_SIG_LOCK;
 
-	bc_num_init(&temp, n->len);
-	bc_num_init(&temp2, n->len);
-	bc_num_init(&frac, nrdx);
-	bc_num_init(&intn, bc_num_int(n));
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
+
+	sieve = bc_vm_malloc(h + 1);
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	assert(BC_NUM_RDX_VALID_NP(vm->max));
+	for (i = 0; i < BC_NUM_PROD_DEPTH + 2; ++i)
+	{
+		s[i] = t + i;
+	}
 
 	// NOLINTNEXTLINE
-	memcpy(frac.num, n->num, BC_NUM_SIZE(nrdx));
-	frac.len = nrdx;
-	BC_NUM_RDX_SET_NP(frac, nrdx);
-	frac.scale = n->scale;
+	memset(sieve, 0, h + 1);
 
-	assert(BC_NUM_RDX_VALID_NP(frac));
-	assert(BC_NUM_RDX_VALID_NP(vm->max2));
+	// Cross off the odd multiples of every odd prime, starting at its square.
+	for (i = 1; (2 * i + 1) * (2 * i + 1) <= n; ++i)
+	{
+		if (sieve[i]) continue;
 
-	// Multiply the fraction and truncate so that it's an integer. The
-	// truncation is what clamps it, by the way.
-	bc_num_mul(&frac, &vm->max2, &temp, 0);
-	bc_num_truncate(&temp, temp.scale);
-	bc_num_copy(&frac, &temp);
+		for (j = 2 * i * (i + 1); j <= h; j += 2 * i + 1)
+		{
+			sieve[j] = 1;
+		}
+	}
 
-	// Get the integer.
-	// NOLINTNEXTLINE
-	memcpy(intn.num, n->num + nrdx, BC_NUM_SIZE(bc_num_int(n)));
-	intn.len = bc_num_int(n);
+	bc_num_one(r);
 
-	// This assert is here because it has to be true. It is also here to justify
-	// some optimizations.
-	assert(BC_NUM_NONZERO(&vm->max));
+	// No exponent is bigger than the exponent of 2 in n!.
+	e = bc_num_legendre(n, 2);
 
-	// If there *was* a fractional part...
-	if (BC_NUM_NONZERO(&frac))
+	for (bit = 1; bit <= e / 2; bit <<= 1)
 	{
-		// This divmod splits frac into the two state parts.
-		bc_num_divmod(&frac, &vm->max, &temp, &temp2, 0);
-
-		// frac is guaranteed to be smaller than vm->max * vm->max (pow).
-		// This means that when dividing frac by vm->max, as above, the
-		// quotient and remainder are both guaranteed to be less than vm->max,
-		// which means we can use bc_num_bigdig2() here and not worry about
-		// overflow.
-		state1 = (BcRand) bc_num_bigdig2(&temp2);
-		state2 = (BcRand) bc_num_bigdig2(&temp);
+		continue;
 	}
-	else state1 = state2 = 0;
 
-	// If there *was* an integer part...
-	if (BC_NUM_NONZERO(&intn))
+	for (; e && bit; bit >>= 1)
 	{
-		// This divmod splits intn into the two inc parts.
-		bc_num_divmod(&intn, &vm->max, &temp, &temp2, 0);
+		len = 0;
+		acc = 1;
 
-		// Because temp2 is the mod of vm->max, from above, it is guaranteed
-		// to be small enough to use bc_num_bigdig2().
-		inc1 = (BcRand) bc_num_bigdig2(&temp2);
+		BC_NUM_POLL;
 
-		// Clamp the second inc part.
-		if (bc_num_cmp(&temp, &vm->max) >= 0)
+		if ((bc_num_legendre(n, 2) - bc_num_legendre(m, 2) -
+		     bc_num_legendre(k, 2)) &
+		    bit)
 		{
-			bc_num_copy(&temp2, &temp);
-			bc_num_mod(&temp2, &vm->max, &temp, 0);
+			acc = 2;
 		}
 
-		// The if statement above ensures that temp is less than vm->max, which
-		// means that we can use bc_num_bigdig2() here.
-		inc2 = (BcRand) bc_num_bigdig2(&temp);
-	}
-	else inc1 = inc2 = 0;
+		// Legendre's formula is bounded by n / (p - 1), so bigger primes
+		// cannot have this bit set.
+		lim = n / bit + 1;
 
-	bc_rand_seed(rng, state1, state2, inc1, inc2);
+		for (i = 1; i <= h && 2 * i + 1 <= lim; ++i)
+		{
+			if (sieve[i]) continue;
+
+			p = (BcBigDig) (2 * i + 1);
+
+			if ((bc_num_legendre(n, p) - bc_num_legendre(m, p) -
+			     bc_num_legendre(k, p)) &
+			    bit)
+			{
+				bc_num_prodDig(s, &len, &acc, p);
+			}
+		}
+
+		bc_num_prodEnd(s, len, acc, prod);
+
+		bc_num_mul(r, r, sq, 0);
+		bc_num_mul(sq, prod, r, 0);
+	}
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&intn);
-	bc_num_free(&frac);
-	bc_num_free(&temp2);
-	bc_num_free(&temp);
+	free(sieve);
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
 	BC_LONGJMP_CONT(vm);
 }
 
-void
-bc_num_createFromRNG(BcNum* restrict n, BcRNG* rng)
+/**
+ * Calculates the falling factorial a(a-1)...(a-k+1) with a product tree.
+ * @param a  The first factor. It must be an integer that is at least @a k.
+ * @param k  The number of factors.
+ * @param r  The return parameter.
+ */
+static void
+bc_num_prodRange(BcNum* restrict a, BcBigDig k, BcNum* restrict r)
 {
-	BcRand s1, s2, i1, i2;
-	BcNum conv, temp1, temp2, temp3;
-	BcDig temp1_num[BC_RAND_NUM_SIZE], temp2_num[BC_RAND_NUM_SIZE];
-	BcDig conv_num[BC_NUM_BIGDIG_LOG10];
+	BcNum t[BC_NUM_PROD_DEPTH + 5];
+	BcNum* s[BC_NUM_PROD_DEPTH + 2];
+	BcNum* x = t + BC_NUM_PROD_DEPTH + 2;
+	BcNum* y = t + BC_NUM_PROD_DEPTH + 3;
+	BcNum* one = t + BC_NUM_PROD_DEPTH + 4;
+	BcNum* temp;
+	size_t i, n = 0;
+	BcBigDig j, top, acc = 1;
 #if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
 #endif // BC_ENABLE_LIBRARY
 
 	BC_SIG_LOCK;
 
-	bc_num_init(&temp3, 2 * BC_RAND_NUM_SIZE);
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	bc_num_setup(&temp1, temp1_num, sizeof(temp1_num) / sizeof(BcDig));
-	bc_num_setup(&temp2, temp2_num, sizeof(temp2_num) / sizeof(BcDig));
-	bc_num_setup(&conv, conv_num, sizeof(conv_num) / sizeof(BcDig));
-
-	// This assert is here because it has to be true. It is also here to justify
-	// the assumption that vm->max is not zero.
-	assert(BC_NUM_NONZERO(&vm->max));
-
-	// Because this is true, we can just ignore math errors that would happen
-	// otherwise.
-	assert(BC_NUM_NONZERO(&vm->max2));
+	for (i = 0; i < BC_NUM_PROD_DEPTH + 2; ++i)
+	{
+		s[i] = t + i;
+	}
 
-	bc_rand_getRands(rng, &s1, &s2, &i1, &i2);
+	if (bc_num_cmp(a, &vm->max) < 0)
+	{
+		top = bc_num_bigdig2(a);
 
-	// Put the second piece of state into a number.
-	bc_num_bigdig2num(&conv, (BcBigDig) s2);
+		for (j = 0; j < k; ++j)
+		{
+			bc_num_prodDig(s, &n, &acc, top - j);
+		}
+	}
+	else
+	{
+		bc_num_copy(x, a);
+		bc_num_one(one);
 
-	assert(BC_NUM_RDX_VALID_NP(conv));
+		// Factors that do not fit in a BcBigDig get a leaf each.
+		for (j = 0; j < k; ++j)
+		{
+			bc_num_copy(s[BC_NUM_PROD_DEPTH], x);
+			bc_num_prodPush(s, &n);
 
-	// Multiply by max to make room for the first piece of state.
-	bc_num_mul(&conv, &vm->max, &temp1, 0);
+			bc_num_sub(x, one, y, 0);
 
-	// Add in the first piece of state.
-	bc_num_bigdig2num(&conv, (BcBigDig) s1);
-	bc_num_add(&conv, &temp1, &temp2, 0);
+			temp = x;
+			x = y;
+			y = temp;
+		}
+	}
 
-	// Divide to make it an entirely fractional part.
-	bc_num_div(&temp2, &vm->max2, &temp3, BC_RAND_STATE_BITS);
+	bc_num_prodEnd(s, n, acc, r);
 
-	// Now start on the increment parts. It's the same process without the
-	// divide, so put the second piece of increment into a number.
-	bc_num_bigdig2num(&conv, (BcBigDig) i2);
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
 
-	assert(BC_NUM_RDX_VALID_NP(conv));
+/**
+ * Calculates the falling factorial a(a-1)...(a-k+1), which is a!/(a-k)!, with
+ * the method that suits the arguments.
+ * @param a  The first factor. It must be an integer that is at least @a k.
+ * @param k  The number of factors.
+ * @param r  The return parameter.
+ */
+static void
+bc_num_falling(BcNum* restrict a, BcBigDig k, BcNum* restrict r)
+{
+	BcBigDig n;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-	// Multiply by max to make room for the first piece of increment.
-	bc_num_mul(&conv, &vm->max, &temp1, 0);
+	// Factoring needs a sieve up to a, so it only pays off when a good part of
+	// the numbers up to a are factors.
+	if (bc_num_cmp(a, &vm->max) < 0)
+	{
+		n = bc_num_bigdig2(a);
 
-	// Add in the first piece of increment.
-	bc_num_bigdig2num(&conv, (BcBigDig) i1);
-	bc_num_add(&conv, &temp1, &temp2, 0);
+		if (n <= BC_NUM_SIEVE_MAX && k >= n / BC_NUM_FALLING_RATIO)
+		{
+			bc_num_factorials(n, n - k, 0, r);
+			return;
+		}
+	}
 
-	// Now add the two together.
-	bc_num_add(&temp2, &temp3, n, 0);
+	bc_num_prodRange(a, k, r);
+}
 
-	assert(BC_NUM_RDX_VALID(n));
+/**
+ * Truncates the absolute values of the arguments of perm() and comb() into
+ * temporaries.
+ * @param a  The first argument.
+ * @param b  The second argument.
+ * @param n  The truncated absolute value of @a a.
+ * @param k  The truncated absolute value of @a b.
+ */
+static void
+bc_num_combArgs(BcNum* a, BcNum* b, BcNum* restrict n, BcNum* restrict k)
+{
+	bc_num_copy(n, a);
+	BC_NUM_NEG_CLR(n);
+	bc_num_truncate(n, n->scale);
 
-err:
-	BC_SIG_MAYLOCK;
-	bc_num_free(&temp3);
-	BC_LONGJMP_CONT(vm);
+	bc_num_copy(k, b);
+	BC_NUM_NEG_CLR(k);
+	bc_num_truncate(k, k->scale);
 }
 
 void
-bc_num_irand(BcNum* restrict a, BcNum* restrict b, BcRNG* restrict rng)
+bc_num_perm(BcNum* a, BcNum* b, BcNum* c, size_t scale)
 {
-	BcNum atemp;
-	size_t i;
+	BcNum t[2];
+	BcNum* n = t;
+	BcNum* k = t + 1;
+	BcBigDig ndig, kdig;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-	assert(a != b);
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
 
-	if (BC_ERR(BC_NUM_NEG(a))) bc_err(BC_ERR_MATH_NEGATIVE);
+	BC_UNUSED(scale);
 
-	// If either of these are true, then the numbers are integers.
-	if (BC_NUM_ZERO(a) || BC_NUM_ONE(a)) return;
+	// Like the math library, this compares before truncating.
+	if (bc_num_cmp(b, a) > 0)
+	{
+		bc_num_setToZero(c, 0);
+		return;
+	}
 
-#if BC_GCC
-	// This is here in GCC to quiet the "maybe-uninitialized" warning.
-	atemp.num = NULL;
-	atemp.len = 0;
-#endif // BC_GCC
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_combArgs(a, b, n, k);
+
+	kdig = bc_num_bigdig(k);
+
+	if (bc_num_cmp(k, n) <= 0) bc_num_falling(n, kdig, c);
+	else
+	{
+		// A negative b can still end up bigger than a. The math library then
+		// divided n! by (k - n)!, truncating. That is only non-zero if k - n is
+		// at most n, or for n = 0 and k = 1.
+		ndig = bc_num_bigdig2(n);
+		kdig -= ndig;
+
+		if (kdig <= ndig) bc_num_falling(n, ndig - kdig, c);
+		else if (!ndig && kdig == 1) bc_num_one(c);
+		else bc_num_setToZero(c, 0);
+	}
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
+
+void
+bc_num_comb(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+{
+	BcNum t[5];
+	BcNum* n = t;
+	BcNum* k = t + 1;
+	BcNum* d = t + 2;
+	BcNum* x = t + 3;
+	BcNum* y = t + 4;
+	BcNum* temp;
+	BcBigDig ndig, kdig;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-	if (BC_ERR(bc_num_nonInt(a, &atemp))) bc_err(BC_ERR_MATH_NON_INTEGER);
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
 
-	assert(atemp.num != NULL);
-	assert(atemp.len);
+	BC_UNUSED(scale);
 
-	if (atemp.len > 2)
+	// Like the math library, this compares before truncating.
+	if (bc_num_cmp(b, a) > 0)
 	{
-		size_t len;
+		bc_num_setToZero(c, 0);
+		return;
+	}
 
-		len = atemp.len - 2;
+	BC_SIG_LOCK;
 
-		// Just generate a random number for each limb.
-		for (i = 0; i < len; i += 2)
-		{
-			BcRand dig;
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-			dig = bc_rand_bounded(rng, BC_BASE_RAND_POW);
+	BC_SETJMP_LOCKED(vm, err);
 
-			b->num[i] = (BcDig) (dig % BC_BASE_POW);
-			b->num[i + 1] = (BcDig) (dig / BC_BASE_POW);
-		}
-	}
-	else
+	BC_SIG_UNLOCK;
+
+	bc_num_combArgs(a, b, n, k);
+
+	// A negative b can still end up bigger than a. The math library then
+	// divided n! by k!(k - n)!, truncating, which is only non-zero for n = 0
+	// and k = 1.
+	if (bc_num_cmp(k, n) > 0)
 	{
-		// We need this set.
-		i = 0;
+		if (BC_NUM_ZERO(n) && BC_NUM_ONE(k)) bc_num_one(c);
+		else bc_num_setToZero(c, 0);
 	}
-
-	// This will be true if there's one full limb after the two limb groups.
-	if (i == atemp.len - 2)
+	else
 	{
-		// Increment this for easy use.
-		i += 1;
+		bc_num_sub(n, k, d, 0);
 
-		// If the last digit is not one, we need to set a bound for it
-		// explicitly. Since there's still an empty limb, we need to fill that.
-		if (atemp.num[i] != 1)
+		// Picking k items is the same as leaving n - k out, so use the smaller.
+		if (bc_num_cmp(d, k) < 0)
 		{
-			BcRand dig;
-			BcRand bound;
-
-			// Set the bound to the bound of the last limb times the amount
-			// needed to fill the second-to-last limb as well.
-			bound = ((BcRand) atemp.num[i]) * BC_BASE_POW;
-
-			dig = bc_rand_bounded(rng, bound);
+			temp = k;
+			k = d;
+			d = temp;
+		}
 
-			// Fill the last two.
-			b->num[i - 1] = (BcDig) (dig % BC_BASE_POW);
-			b->num[i] = (BcDig) (dig / BC_BASE_POW);
+		kdig = bc_num_bigdig(k);
 
-			// Ensure that the length will be correct. If the last limb is zero,
-			// then the length needs to be one less than the bound.
-			b->len = atemp.len - (b->num[i] == 0);
-		}
-		// Here the last limb *is* one, which means the last limb does *not*
-		// need to be filled. Also, the length needs to be one less because the
-		// last limb is 0.
-		else
+		// Factoring avoids a long division, but it needs a sieve up to n. The
+		// division is quadratic in k, and the sieve is linear in n, so factor
+		// if k is at least sqrt(n).
+		if (kdig && bc_num_cmp(n, &vm->max) < 0 &&
+		    (ndig = bc_num_bigdig2(n)) <= BC_NUM_SIEVE_MAX &&
+		    kdig >= ndig / kdig)
 		{
-			b->num[i - 1] = (BcDig) bc_rand_bounded(rng, BC_BASE_POW);
-			b->len = atemp.len - 1;
+			bc_num_factorials(ndig, kdig, ndig - kdig, c);
 		}
-	}
-	// Here, there is only one limb to fill.
-	else
-	{
-		// See above for how this works.
-		if (atemp.num[i] != 1)
+		else
 		{
-			b->num[i] = (BcDig) bc_rand_bounded(rng, (BcRand) atemp.num[i]);
-			b->len = atemp.len - (b->num[i] == 0);
+			bc_num_falling(n, kdig, x);
+			bc_num_falling(k, kdig, y);
+			bc_num_div(x, y, c, 0);
 		}
-		else b->len = atemp.len - 1;
 	}
 
-	bc_num_clean(b);
-
-	assert(BC_NUM_RDX_VALID(b));
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
-#endif // BC_ENABLE_EXTRA_MATH
 
-size_t
-bc_num_addReq(const BcNum* a, const BcNum* b, size_t scale)
+void
+bc_num_fib(BcNum* restrict a, BcNum* restrict b, size_t scale)
 {
-	size_t aint, bint, ardx, brdx;
+	BcNum t[5];
+	BcNum* f = t;
+	BcNum* g = t + 1;
+	BcNum* x = t + 2;
+	BcNum* y = t + 3;
+	BcNum* two = t + 4;
+	BcNum* temp;
+	BcBigDig n, bit;
+	bool odd = true;
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+#endif // BC_ENABLE_LIBRARY
 
-	// Addition and subtraction require the max of the length of the two numbers
-	// plus 1.
+	assert(a != NULL && b != NULL && a != b);
 
 	BC_UNUSED(scale);
 
-	ardx = BC_NUM_RDX_VAL(a);
-	aint = bc_num_int(a);
-	assert(aint <= a->len && ardx <= a->len);
+	// Like the math library, fib(0) is 0.
+	if (BC_NUM_ZERO(a))
+	{
+		bc_num_setToZero(b, 0);
+		return;
+	}
 
-	brdx = BC_NUM_RDX_VAL(b);
-	bint = bc_num_int(b);
-	assert(bint <= b->len && brdx <= b->len);
+	BC_SIG_LOCK;
 
-	ardx = BC_MAX(ardx, brdx);
-	aint = BC_MAX(aint, bint);
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-	return bc_vm_growSize(bc_vm_growSize(ardx, aint), 1);
-}
+	BC_SETJMP_LOCKED(vm, err);
 
-size_t
-bc_num_mulReq(const BcNum* a, const BcNum* b, size_t scale)
-{
-	size_t max, rdx;
+	BC_SIG_UNLOCK;
 
-	// Multiplication requires the sum of the lengths of the numbers.
+	// The math library truncated the absolute value, and anything that
+	// truncated to 0 still went through its loop once, returning 1.
+	bc_num_copy(x, a);
+	BC_NUM_NEG_CLR(x);
+	bc_num_truncate(x, x->scale);
 
-	rdx = bc_vm_growSize(BC_NUM_RDX_VAL(a), BC_NUM_RDX_VAL(b));
+	n = bc_num_bigdig(x);
+	if (!n) n = 1;
 
-	max = BC_NUM_RDX(scale);
+	bc_num_bigdig2num(two, 2);
 
-	max = bc_vm_growSize(BC_MAX(max, rdx), 1);
-	rdx = bc_vm_growSize(bc_vm_growSize(bc_num_int(a), bc_num_int(b)), max);
+	// f is F(k) and g is F(k - 1), starting at k = 1.
+	bc_num_one(f);
 
-	return rdx;
-}
+	// Find the top bit of n; it is k = 1, so skip it.
+	bit = 1;
+	while (bit <= n / 2) bit <<= 1;
 
-size_t
-bc_num_divReq(const BcNum* a, const BcNum* b, size_t scale)
-{
-	size_t max, rdx;
+	// Fast doubling with two squares per bit:
+	//
+	// F(2k - 1) = F(k)^2 + F(k - 1)^2
+	// F(2k + 1) = 4 * F(k)^2 - F(k - 1)^2 + 2 * (-1)^k
+	// F(2k) = F(2k + 1) - F(2k - 1)
+	//
+	// Everything stays a non-negative integer, which is what lets
+	// bc_num_mulArray() do the multiply by 4.
+	for (bit >>= 1; bit; bit >>= 1)
+	{
+		bc_num_mul(f, f, x, 0);
+		bc_num_mul(g, g, y, 0);
 
-	// Division requires the length of the dividend plus the scale.
+		bc_num_add(x, y, g, 0);
+		bc_num_mulArray(x, 4, f);
+		bc_num_sub(f, y, x, 0);
 
-	rdx = bc_vm_growSize(BC_NUM_RDX_VAL(a), BC_NUM_RDX_VAL(b));
+		if (odd) bc_num_sub(x, two, f, 0);
+		else bc_num_add(x, two, f, 0);
 
-	max = BC_NUM_RDX(scale);
+		bc_num_sub(f, g, y, 0);
 
-	max = bc_vm_growSize(BC_MAX(max, rdx), 1);
-	rdx = bc_vm_growSize(bc_num_int(a), max);
+		// y is F(2k), so it replaces g if the bit moves to 2k + 1, and f if it
+		// stays at 2k.
+		odd = ((n & bit) != 0);
 
-	return rdx;
-}
+		if (odd)
+		{
+			temp = g;
+			g = y;
+			y = temp;
+		}
+		else
+		{
+			temp = f;
+			f = y;
+			y = temp;
+		}
+	}
 
-size_t
-bc_num_powReq(const BcNum* a, const BcNum* b, size_t scale)
-{
-	BC_UNUSED(scale);
-	return bc_vm_growSize(bc_vm_growSize(a->len, b->len), 1);
-}
+	bc_num_copy(b, f);
 
-#if BC_ENABLE_EXTRA_MATH
-size_t
-bc_num_placesReq(const BcNum* a, const BcNum* b, size_t scale)
-{
-	BC_UNUSED(scale);
-	return a->len + b->len - BC_NUM_RDX_VAL(a) - BC_NUM_RDX_VAL(b);
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
-#endif // BC_ENABLE_EXTRA_MATH
 
-void
-bc_num_add(BcNum* a, BcNum* b, BcNum* c, size_t scale)
-{
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, false, bc_num_as, bc_num_addReq(a, b, scale));
-}
+#if BC_ENABLE_LIBRARY
 
-void
-bc_num_sub(BcNum* a, BcNum* b, BcNum* c, size_t scale)
-{
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, true, bc_num_as, bc_num_addReq(a, b, scale));
-}
+/// atan(1) to 64 places. This is the constant that the bc math library uses
+/// when scale is less than 65.
+static const char bc_num_atan1[] =
+	".7853981633974483096156608458198757210492923498437764552437361480";
 
-void
-bc_num_mul(BcNum* a, BcNum* b, BcNum* c, size_t scale)
-{
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_m, bc_num_mulReq(a, b, scale));
-}
+/// atan(.2) to 64 places. This is the constant that the bc math library uses
+/// when scale is less than 65.
+static const char bc_num_atanFifth[] =
+	".1973955598498807583700497651947902934475851037878521015176889402";
 
-void
-bc_num_div(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+/**
+ * Sets a preallocated number to a decimal constant.
+ * @param n    The number.
+ * @param val  The constant.
+ */
+static void
+bc_num_const(BcNum* restrict n, const char* restrict val)
 {
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_d, bc_num_divReq(a, b, scale));
+	bc_num_parse(n, val, strlen(val), BC_BASE);
 }
 
-void
-bc_num_mod(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+/**
+ * Truncates or extends a number to a scale. This is the places operator.
+ * @param n      The number.
+ * @param scale  The new scale.
+ */
+static void
+bc_num_toScale(BcNum* restrict n, size_t scale)
 {
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_rem, bc_num_divReq(a, b, scale));
+	if (scale < n->scale) bc_num_truncate(n, n->scale - scale);
+	else bc_num_extend(n, scale - n->scale);
 }
 
 void
-bc_num_pow(BcNum* a, BcNum* b, BcNum* c, size_t scale)
+bc_num_exp(BcNum* restrict a, BcNum* restrict b, size_t scale)
 {
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_p, bc_num_powReq(a, b, scale));
-}
+	BcNum t[8];
+	BcNum* x = t;
+	BcNum* r = t + 1;
+	BcNum* p = t + 2;
+	BcNum* f = t + 3;
+	BcNum* v = t + 4;
+	BcNum* i = t + 5;
+	BcNum* one = t + 6;
+	BcNum* two = t + 7;
+	size_t s, rs, d = 0;
+	bool neg;
+	BcVm* vm = bcl_getspecific();
 
-#if BC_ENABLE_EXTRA_MATH
-void
-bc_num_places(BcNum* a, BcNum* b, BcNum* c, size_t scale)
-{
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_place, bc_num_placesReq(a, b, scale));
-}
+	assert(a != NULL && b != NULL && a != b);
 
-void
-bc_num_lshift(BcNum* a, BcNum* b, BcNum* c, size_t scale)
-{
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_left, bc_num_placesReq(a, b, scale));
-}
+	BC_SIG_LOCK;
 
-void
-bc_num_rshift(BcNum* a, BcNum* b, BcNum* c, size_t scale)
-{
-	assert(BC_NUM_RDX_VALID(a));
-	assert(BC_NUM_RDX_VALID(b));
-	bc_num_binary(a, b, c, scale, bc_num_right, bc_num_placesReq(a, b, scale));
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_one(one);
+	bc_num_bigdig2num(two, 2);
+
+	bc_num_copy(x, a);
+	neg = BC_NUM_NEG(x);
+	BC_NUM_NEG_CLR(x);
+
+	// This is the working scale: 6+scale+.44*x, truncated.
+	bc_num_const(p, ".44");
+	bc_num_mul(p, x, p, scale);
+	bc_num_truncate(p, p->scale);
+	rs = bc_vm_growSize(scale + 6, (size_t) bc_num_bigdig(p));
+
+	// Halve x until it is not greater than 1; the result will be squared that
+	// many times.
+	s = x->scale + 1;
+
+	while (bc_num_cmp(x, one) > 0)
+	{
+		d += 1;
+		bc_num_div(x, two, x, s);
+		s += 1;
+	}
+
+	// This is the Taylor series.
+	bc_num_add(x, one, r, rs);
+	bc_num_copy(p, x);
+	bc_num_one(f);
+	bc_num_one(v);
+	bc_num_copy(i, two);
+
+	while (BC_NUM_NONZERO(v))
+	{
+		bc_num_mul(p, x, p, rs);
+		bc_num_mul(f, i, f, rs);
+		bc_num_div(p, f, v, rs);
+		bc_num_add(r, v, r, rs);
+		bc_num_add(i, one, i, rs);
+	}
+
+	while (d--)
+	{
+		bc_num_mul(r, r, r, rs);
+	}
+
+	if (neg) bc_num_div(one, r, b, scale);
+	else bc_num_div(r, one, b, scale);
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
-#endif // BC_ENABLE_EXTRA_MATH
 
 void
-bc_num_sqrt(BcNum* restrict a, BcNum* restrict b, size_t scale)
+bc_num_ln(BcNum* restrict a, BcNum* restrict b, size_t scale)
 {
-	BcNum num1, num2, half, f, fprime;
-	BcNum* x0;
-	BcNum* x1;
+	BcNum t[10];
+	BcNum* x = t;
+	BcNum* y = t + 1;
+	BcNum* r = t + 2;
+	BcNum* p = t + 3;
+	BcNum* q = t + 4;
+	BcNum* u = t + 5;
+	BcNum* v = t + 6;
+	BcNum* i = t + 7;
+	BcNum* one = t + 8;
+	BcNum* two = t + 9;
 	BcNum* temp;
-	// realscale is meant to quiet a warning on GCC about longjmp() clobbering.
-	// This one is real.
-	size_t pow, len, rdx, req, resscale, realscale;
-	BcDig half_digs[1];
-#if BC_ENABLE_LIBRARY
+	size_t s;
 	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
 
-	assert(a != NULL && b != NULL && a != b);
+	assert(a != NULL && b != NULL && a != b);
+
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-	if (BC_ERR(BC_NUM_NEG(a))) bc_err(BC_ERR_MATH_NEGATIVE);
+	BC_SETJMP_LOCKED(vm, err);
 
-	// We want to calculate to a's scale if it is bigger so that the result will
-	// truncate properly.
-	if (a->scale > scale) realscale = a->scale;
-	else realscale = scale;
+	BC_SIG_UNLOCK;
 
-	// Set parameters for the result.
-	len = bc_vm_growSize(bc_num_intDigits(a), 1);
-	rdx = BC_NUM_RDX(realscale);
+	bc_num_one(one);
+	bc_num_bigdig2num(two, 2);
 
-	// Square root needs half of the length of the parameter.
-	req = bc_vm_growSize(BC_MAX(rdx, BC_NUM_RDX_VAL(a)), len >> 1);
-	req = bc_vm_growSize(req, 1);
+	// The bc math library returns 1-10^scale for numbers that have no
+	// logarithm.
+	if (bc_num_cmpZero(a) <= 0)
+	{
+		bc_num_bigdig2num(u, BC_BASE);
+		bc_num_bigdig2num(v, (BcBigDig) scale);
+		bc_num_pow(u, v, p, scale);
+		bc_num_sub(one, p, r, scale);
+		bc_num_div(r, one, b, scale);
+		goto err;
+	}
 
-	BC_SIG_LOCK;
+	s = bc_vm_growSize(scale, 6);
 
-	// Unlike the binary operators, this function is the only single parameter
-	// function and is expected to initialize the result. This means that it
-	// expects that b is *NOT* preallocated. We allocate it here.
-	bc_num_init(b, req);
+	bc_num_copy(x, a);
+	bc_num_copy(p, two);
 
-	BC_SIG_UNLOCK;
+	// Take square roots until x is between .5 and 2.
+	while (bc_num_cmp(x, two) >= 0)
+	{
+		bc_num_mul(p, two, p, s);
+		bc_num_sqrtInto(x, y, s);
 
-	assert(a != NULL && b != NULL && a != b);
-	assert(a->num != NULL && b->num != NULL);
+		temp = x;
+		x = y;
+		y = temp;
+	}
 
-	// Easy case.
-	if (BC_NUM_ZERO(a))
+	bc_num_const(v, ".5");
+
+	while (bc_num_cmp(x, v) <= 0)
 	{
-		bc_num_setToZero(b, realscale);
-		return;
+		bc_num_mul(p, two, p, s);
+		bc_num_sqrtInto(x, y, s);
+
+		temp = x;
+		x = y;
+		y = temp;
 	}
 
-	// Another easy case.
-	if (BC_NUM_ONE(a))
+	// This is the series for the inverse hyperbolic tangent of (x-1)/(x+1).
+	bc_num_sub(x, one, u, s);
+	bc_num_add(x, one, v, s);
+	bc_num_div(u, v, u, s);
+
+	bc_num_copy(r, u);
+	bc_num_mul(u, u, q, s);
+	bc_num_one(v);
+	bc_num_bigdig2num(i, 3);
+
+	while (BC_NUM_NONZERO(v))
 	{
-		bc_num_one(b);
-		bc_num_extend(b, realscale);
-		return;
+		bc_num_mul(u, q, u, s);
+		bc_num_div(u, i, v, s);
+		bc_num_add(r, v, r, s);
+		bc_num_add(i, two, i, s);
 	}
 
-	// Set the parameters again.
-	rdx = BC_NUM_RDX(realscale);
-	rdx = BC_MAX(rdx, BC_NUM_RDX_VAL(a));
-	len = bc_vm_growSize(a->len, rdx);
+	bc_num_mul(r, p, r, s);
+	bc_num_div(r, one, b, scale);
 
-	BC_SIG_LOCK;
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
 
-	bc_num_init(&num1, len);
-	bc_num_init(&num2, len);
-	bc_num_setup(&half, half_digs, sizeof(half_digs) / sizeof(BcDig));
+void
+bc_num_atan(BcNum* restrict a, BcNum* restrict b, size_t scale)
+{
+	BcNum t[10];
+	BcNum* x = t;
+	BcNum* r = t + 1;
+	BcNum* u = t + 2;
+	BcNum* f = t + 3;
+	BcNum* v = t + 4;
+	BcNum* w = t + 5;
+	BcNum* m = t + 6;
+	BcNum* at = t + 7;
+	BcNum* one = t + 8;
+	BcNum* fifth = t + 9;
+	size_t s;
+	bool neg;
+	BcVm* vm = bcl_getspecific();
 
-	// There is a division by two in the formula. We set up a number that's 1/2
-	// so that we can use multiplication instead of heavy division.
-	bc_num_setToZero(&half, 1);
-	half.num[0] = BC_BASE_POW / 2;
-	half.len = 1;
-	BC_NUM_RDX_SET_NP(half, 1);
+	assert(a != NULL && b != NULL && a != b);
 
-	bc_num_init(&f, len);
-	bc_num_init(&fprime, len);
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	// Pointers for easy switching.
-	x0 = &num1;
-	x1 = &num2;
+	bc_num_copy(x, a);
+	neg = BC_NUM_NEG(x);
+	BC_NUM_NEG_CLR(x);
 
-	// Start with 1.
-	bc_num_one(x0);
+	// The divisor that gives the result its sign.
+	bc_num_one(one);
+	bc_num_copy(w, one);
+	if (neg) BC_NUM_NEG_TGL(w);
 
-	// The power of the operand is needed for the estimate.
-	pow = bc_num_intDigits(a);
+	bc_num_const(fifth, ".2");
 
-	// The code in this if statement calculates the initial estimate. First, if
-	// a is less than 1, then 0 is a good estimate. Otherwise, we want something
-	// in the same ballpark. That ballpark is half of pow because the result
-	// will have half the digits.
-	if (pow)
+	// The math library has the answers for 1 and .2 when scale is small.
+	if (scale < 65)
 	{
-		// An odd number is served by starting with 2^((pow-1)/2), and an even
-		// number is served by starting with 6^((pow-2)/2). Why? Because math.
-		if (pow & 1) x0->num[0] = 2;
-		else x0->num[0] = 6;
+		if (!bc_num_cmp(x, one))
+		{
+			bc_num_const(v, bc_num_atan1);
+			bc_num_div(v, w, b, scale);
+			goto err;
+		}
 
-		pow -= 2 - (pow & 1);
-		bc_num_shiftLeft(x0, pow / 2);
+		if (!bc_num_cmp(x, fifth))
+		{
+			bc_num_const(v, bc_num_atanFifth);
+			bc_num_div(v, w, b, scale);
+			goto err;
+		}
 	}
 
-	// I can set the rdx here directly because neg should be false.
-	x0->scale = x0->rdx = 0;
-	resscale = (realscale + BC_BASE_DIGS) + 2;
-
-	// This is the calculation loop. This compare goes to 0 eventually as the
-	// difference between the two numbers gets smaller than resscale.
-	while (bc_num_cmp(x1, x0))
+	if (bc_num_cmp(x, fifth) > 0)
 	{
-		assert(BC_NUM_NONZERO(x0));
+		bc_num_atan(fifth, at, bc_vm_growSize(scale, 5));
+	}
 
-		// This loop directly corresponds to the iteration in Newton's method.
-		// If you know the formula, this loop makes sense. Go study the formula.
+	s = bc_vm_growSize(scale, 3);
 
-		bc_num_div(a, x0, &f, resscale);
-		bc_num_add(x0, &f, &fprime, resscale);
+	// Reduce x with atan(x) = atan(.2) + atan((x-.2)/(1+.2*x)).
+	while (bc_num_cmp(x, fifth) > 0)
+	{
+		bc_num_add(m, one, m, s);
 
-		assert(BC_NUM_RDX_VALID_NP(fprime));
-		assert(BC_NUM_RDX_VALID_NP(half));
+		bc_num_mul(fifth, x, v, s);
+		bc_num_add(one, v, v, s);
+		bc_num_sub(x, fifth, f, s);
+		bc_num_div(f, v, x, s);
+	}
 
-		bc_num_mul(&fprime, &half, x1, resscale);
+	// This is the Taylor series.
+	bc_num_copy(r, x);
+	bc_num_copy(u, x);
+	bc_num_copy(v, x);
+	if (BC_NUM_NONZERO(v)) BC_NUM_NEG_TGL(v);
+	bc_num_mul(v, x, f, s);
+	bc_num_one(v);
+	bc_num_bigdig2num(x, 3);
 
-		// Switch.
-		temp = x0;
-		x0 = x1;
-		x1 = temp;
+	while (BC_NUM_NONZERO(v))
+	{
+		bc_num_mul(u, f, u, s);
+		bc_num_div(u, x, v, s);
+		bc_num_add(r, v, r, s);
+		bc_num_add(x, one, x, s);
+		bc_num_add(x, one, x, s);
 	}
 
-	// Copy to the result and truncate.
-	bc_num_copy(b, x0);
-	if (b->scale > realscale) bc_num_truncate(b, b->scale - realscale);
-
-	assert(!BC_NUM_NEG(b) || BC_NUM_NONZERO(b));
-	assert(BC_NUM_RDX_VALID(b));
-	assert(BC_NUM_RDX_VAL(b) <= b->len || !b->len);
-	assert(!b->len || b->num[b->len - 1] || BC_NUM_RDX_VAL(b) == b->len);
+	bc_num_mul(m, at, v, scale);
+	bc_num_add(v, r, v, scale);
+	bc_num_div(v, w, b, scale);
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&fprime);
-	bc_num_free(&f);
-	bc_num_free(&num2);
-	bc_num_free(&num1);
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
 	BC_LONGJMP_CONT(vm);
 }
 
 void
-bc_num_divmod(BcNum* a, BcNum* b, BcNum* c, BcNum* d, size_t scale)
+bc_num_sin(BcNum* restrict a, BcNum* restrict b, size_t scale)
 {
-	size_t ts, len;
-	BcNum *ptr_a, num2;
-	// This is volatile to quiet a warning on GCC about clobbering with
-	// longjmp().
-	volatile bool init = false;
-#if BC_ENABLE_LIBRARY
+	BcNum t[9];
+	BcNum* x = t;
+	BcNum* r = t + 1;
+	BcNum* u = t + 2;
+	BcNum* q = t + 3;
+	BcNum* v = t + 4;
+	BcNum* i = t + 5;
+	BcNum* at = t + 6;
+	BcNum* one = t + 7;
+	BcNum* four = t + 8;
+	size_t s;
+	bool neg;
 	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
 
-	// The bulk of this function is just doing what bc_num_binary() does for the
-	// binary operators. However, it assumes that only c and a can be equal.
+	assert(a != NULL && b != NULL && a != b);
 
-	// Set up the parameters.
-	ts = BC_MAX(scale + b->scale, a->scale);
-	len = bc_num_mulReq(a, b, ts);
+	BC_SIG_LOCK;
 
-	assert(a != NULL && b != NULL && c != NULL && d != NULL);
-	assert(c != d && a != d && b != d && b != c);
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-	// Initialize or expand as necessary.
-	if (c == a)
-	{
-		// NOLINTNEXTLINE
-		memcpy(&num2, c, sizeof(BcNum));
-		ptr_a = &num2;
+	BC_SETJMP_LOCKED(vm, err);
 
-		BC_SIG_LOCK;
+	BC_SIG_UNLOCK;
 
-		bc_num_init(c, len);
+	// Negative numbers use sin(-x) = -sin(x).
+	bc_num_copy(x, a);
+	neg = BC_NUM_NEG(x);
+	BC_NUM_NEG_CLR(x);
 
-		init = true;
+	bc_num_one(one);
+	bc_num_bigdig2num(four, 4);
 
-		BC_SETJMP_LOCKED(vm, err);
+	// This is pi/4 at 1.1*scale+2.
+	bc_num_atan(one, at, bc_vm_growSize(scale + scale / 10, 2));
 
-		BC_SIG_UNLOCK;
-	}
-	else
+	// Reduce x by multiples of pi/2 at scale 0 like the math library does.
+	bc_num_div(x, at, q, 0);
+	bc_num_bigdig2num(v, 2);
+	bc_num_add(q, v, q, 0);
+	bc_num_div(q, four, q, 0);
+
+	bc_num_mul(four, q, v, 0);
+	bc_num_mul(v, at, v, 0);
+	bc_num_sub(x, v, x, 0);
+
+	bc_num_bigdig2num(v, 2);
+	bc_num_mod(q, v, v, 0);
+	if (BC_NUM_NONZERO(v) && BC_NUM_NONZERO(x)) BC_NUM_NEG_TGL(x);
+
+	s = bc_vm_growSize(scale, 2);
+
+	// This is the Taylor series.
+	bc_num_copy(r, x);
+	bc_num_copy(u, x);
+	bc_num_copy(v, x);
+	if (BC_NUM_NONZERO(v)) BC_NUM_NEG_TGL(v);
+	bc_num_mul(v, x, q, s);
+	bc_num_bigdig2num(i, 3);
+
+	while (BC_NUM_NONZERO(u))
 	{
-		ptr_a = a;
-		bc_num_expand(c, len);
+		bc_num_sub(i, one, v, s);
+		bc_num_mul(i, v, v, s);
+		bc_num_div(q, v, v, s);
+		bc_num_mul(u, v, u, s);
+		bc_num_add(r, u, r, s);
+		bc_num_add(i, one, i, s);
+		bc_num_add(i, one, i, s);
 	}
 
-	// Do the quick version if possible.
-	if (BC_NUM_NONZERO(a) && !BC_NUM_RDX_VAL(a) && !BC_NUM_RDX_VAL(b) &&
-	    b->len == 1 && !scale)
-	{
-		BcBigDig rem;
+	bc_num_div(r, one, b, scale);
+	if (neg && BC_NUM_NONZERO(b)) BC_NUM_NEG_TGL(b);
 
-		bc_num_divArray(ptr_a, (BcBigDig) b->num[0], c, &rem);
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
 
-		assert(rem < BC_BASE_POW);
+void
+bc_num_cos(BcNum* restrict a, BcNum* restrict b, size_t scale)
+{
+	BcNum t[4];
+	BcNum* at = t;
+	BcNum* v = t + 1;
+	BcNum* w = t + 2;
+	BcNum* one = t + 3;
+	size_t s;
+	BcVm* vm = bcl_getspecific();
 
-		d->num[0] = (BcDig) rem;
-		d->len = (rem != 0);
-	}
-	// Do the slow method.
-	else bc_num_r(ptr_a, b, c, d, scale, ts);
+	assert(a != NULL && b != NULL && a != b);
 
-	assert(!BC_NUM_NEG(c) || BC_NUM_NONZERO(c));
-	assert(BC_NUM_RDX_VALID(c));
-	assert(BC_NUM_RDX_VAL(c) <= c->len || !c->len);
-	assert(!c->len || c->num[c->len - 1] || BC_NUM_RDX_VAL(c) == c->len);
-	assert(!BC_NUM_NEG(d) || BC_NUM_NONZERO(d));
-	assert(BC_NUM_RDX_VALID(d));
-	assert(BC_NUM_RDX_VAL(d) <= d->len || !d->len);
-	assert(!d->len || d->num[d->len - 1] || BC_NUM_RDX_VAL(d) == d->len);
+	BC_SIG_LOCK;
+
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// cos(x) = sin(pi/2+x) at 1.2*scale.
+	s = scale + scale / 5;
+
+	bc_num_one(one);
+	bc_num_atan(one, at, s);
+	bc_num_bigdig2num(v, 2);
+	bc_num_mul(v, at, v, s);
+	bc_num_add(v, a, v, s);
+	bc_num_sin(v, w, s);
+	bc_num_div(w, one, b, scale);
 
 err:
-	// Only cleanup if we initialized.
-	if (init)
-	{
-		BC_SIG_MAYLOCK;
-		bc_num_free(&num2);
-		BC_LONGJMP_CONT(vm);
-	}
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
 }
 
 void
-bc_num_modexp(BcNum* a, BcNum* b, BcNum* c, BcNum* restrict d)
+bc_num_log(BcNum* a, BcNum* b, BcNum* c, size_t scale)
 {
-	BcNum base, exp, two, temp, atemp, btemp, ctemp;
-	BcDig two_digs[2];
-#if BC_ENABLE_LIBRARY
+	BcNum t[2];
+	size_t s;
 	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
 
-	assert(a != NULL && b != NULL && c != NULL && d != NULL);
-	assert(a != d && b != d && c != d);
+	assert(a != NULL && b != NULL && c != NULL && a != c && b != c);
 
-	if (BC_ERR(BC_NUM_ZERO(c))) bc_err(BC_ERR_MATH_DIVIDE_BY_ZERO);
-	if (BC_ERR(BC_NUM_NEG(b))) bc_err(BC_ERR_MATH_NEGATIVE);
+	BC_SIG_LOCK;
 
-#if BC_DEBUG || BC_GCC
-	// This is entirely for quieting a useless scan-build error.
-	btemp.len = 0;
-	ctemp.len = 0;
-#endif // BC_DEBUG || BC_GCC
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
-	// Eliminate fractional parts that are zero or error if they are not zero.
-	if (BC_ERR(bc_num_nonInt(a, &atemp) || bc_num_nonInt(b, &btemp) ||
-	           bc_num_nonInt(c, &ctemp)))
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	// The logarithms are taken at twice the larger of 20, scale, and the scale
+	// of a.
+	s = BC_MAX(scale, 20);
+	s = BC_MAX(s, a->scale);
+	s = bc_vm_growSize(s, s);
+
+	bc_num_ln(a, t, s);
+	bc_num_ln(b, t + 1, s);
+	bc_num_div(t, t + 1, c, s);
+	bc_num_toScale(c, scale);
+
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
+
+/**
+ * Rounds a number to a number of places like the math library's r() and
+ * ceil().
+ * @param a       The number.
+ * @param b       The return parameter.
+ * @param places  The number of places to round to.
+ * @param up      True if the magnitude should be rounded up (ceil()), false if
+ *                it should be rounded to nearest (r()).
+ */
+static void
+bc_num_roundPlaces(BcNum* restrict a, BcNum* restrict b, size_t places,
+                   bool up)
+{
+	BcNum t[3];
+	BcNum* x = t;
+	BcNum* r = t + 1;
+	BcNum* v = t + 2;
+	bool neg, inc;
+	BcVm* vm = bcl_getspecific();
+
+	assert(a != NULL && b != NULL && a != b);
+
+	if (BC_NUM_ZERO(a))
 	{
-		bc_err(BC_ERR_MATH_NON_INTEGER);
+		bc_num_copy(b, a);
+		return;
 	}
 
-	bc_num_expand(d, ctemp.len);
-
 	BC_SIG_LOCK;
 
-	bc_num_init(&base, ctemp.len);
-	bc_num_setup(&two, two_digs, sizeof(two_digs) / sizeof(BcDig));
-	bc_num_init(&temp, btemp.len + 1);
-	bc_num_createCopy(&exp, &btemp);
+	bc_num_temps(t, sizeof(t) / sizeof(BcNum));
 
 	BC_SETJMP_LOCKED(vm, err);
 
 	BC_SIG_UNLOCK;
 
-	bc_num_one(&two);
-	two.num[0] = 2;
-	bc_num_one(d);
+	bc_num_copy(x, a);
+	neg = BC_NUM_NEG(x);
+	BC_NUM_NEG_CLR(x);
 
-	// We already checked for 0.
-	bc_num_rem(&atemp, &ctemp, &base, 0);
+	bc_num_copy(r, x);
+	bc_num_toScale(r, places);
 
-	// If you know the algorithm I used, the memory-efficient method, then this
-	// loop should be self-explanatory because it is the calculation loop.
-	while (BC_NUM_NONZERO(&exp))
+	if (up) inc = (bc_num_cmp(r, x) < 0);
+	else if (places < x->scale)
 	{
-		// Num two cannot be 0, so no errors.
-		bc_num_divmod(&exp, &two, &exp, &temp, 0);
+		// Round up if the part that was cut off is at least 5>>(places+1).
+		bc_num_sub(x, r, v, 0);
+		bc_num_bigdig2num(x, 5);
+		bc_num_shiftRight(x, places + 1);
+		inc = (bc_num_cmp(v, x) >= 0);
+	}
+	else inc = false;
 
-		if (BC_NUM_ONE(&temp) && !BC_NUM_NEG_NP(temp))
-		{
-			assert(BC_NUM_RDX_VALID(d));
-			assert(BC_NUM_RDX_VALID_NP(base));
+	// Add 1>>places. For ceil(), the math library adds it to x, not the
+	// truncated number, but since it truncates after, the result is the same.
+	if (inc)
+	{
+		bc_num_one(v);
+		bc_num_shiftRight(v, places);
+		bc_num_add(r, v, b, 0);
+	}
+	else bc_num_copy(b, r);
 
-			bc_num_mul(d, &base, &temp, 0);
+	if (neg && BC_NUM_NONZERO(b)) BC_NUM_NEG_TGL(b);
 
-			// We already checked for 0.
-			bc_num_rem(&temp, &ctemp, d, 0);
-		}
+err:
+	BC_SIG_MAYLOCK;
+	bc_num_tempsFree(t, sizeof(t) / sizeof(BcNum));
+	BC_LONGJMP_CONT(vm);
+}
 
-		assert(BC_NUM_RDX_VALID_NP(base));
+void
+bc_num_round(BcNum* restrict a, BcNum* restrict b, size_t places)
+{
+	bc_num_roundPlaces(a, b, places, false);
+}
 
-		bc_num_mul(&base, &base, &temp, 0);
+void
+bc_num_ceil(BcNum* restrict a, BcNum* restrict b, size_t places)
+{
+	bc_num_roundPlaces(a, b, places, true);
+}
 
-		// We already checked for 0.
-		bc_num_rem(&temp, &ctemp, &base, 0);
-	}
+void
+bc_num_fact(BcNum* restrict a, BcNum* restrict b, size_t scale)
+{
+	BcNum n;
+	BcVm* vm = bcl_getspecific();
+
+	assert(a != NULL && b != NULL && a != b);
+
+	BC_UNUSED(scale);
+
+	BC_SIG_LOCK;
+
+	BC_NUM_INIT(&n, BC_NUM_DEF_SIZE);
+
+	BC_SETJMP_LOCKED(vm, err);
+
+	BC_SIG_UNLOCK;
+
+	bc_num_copy(&n, a);
+	BC_NUM_NEG_CLR(&n);
+	bc_num_truncate(&n, n.scale);
+
+	bc_num_falling(&n, bc_num_bigdig(&n), b);
 
 err:
 	BC_SIG_MAYLOCK;
-	bc_num_free(&exp);
-	bc_num_free(&temp);
-	bc_num_free(&base);
+	BC_NUM_FREE(&n);
 	BC_LONGJMP_CONT(vm);
-	assert(!BC_NUM_NEG(d) || d->len);
-	assert(BC_NUM_RDX_VALID(d));
-	assert(!d->len || d->num[d->len - 1] || BC_NUM_RDX_VAL(d) == d->len);
 }
 
+#endif // BC_ENABLE_LIBRARY
+
 #if BC_DEBUG_CODE
 void
 bc_num_printDebug(const BcNum* n, const char* name, bool emptyline)
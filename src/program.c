@@ -121,47 +121,60 @@ bc_program_string(BcProgram* p, const BcNum* n)
 /**
  * Prepares the globals for a function call. This is only called when global
  * stacks are on because it pushes a copy of the current globals onto each of
- * their respective stacks.
- * @param p  The program.
+ * their respective stacks. Only the globals that the function can modify are
+ * pushed; the rest are shared with the caller.
+ * @param p        The program.
+ * @param globals  The globals that the function can modify.
  */
 static void
-bc_program_prepGlobals(BcProgram* p)
+bc_program_prepGlobals(BcProgram* p, uint8_t globals)
 {
 	size_t i;
 
 	for (i = 0; i < BC_PROG_GLOBALS_LEN; ++i)
 	{
-		bc_vec_push(p->globals_v + i, p->globals + i);
+		if (globals & BC_FUNC_GLOBAL(BC_INST_IBASE + i))
+		{
+			bc_vec_push(p->globals_v + i, p->globals + i);
+		}
 	}
 
 #if BC_ENABLE_EXTRA_MATH
-	bc_rand_push(&p->rng);
+	if (globals & BC_FUNC_GLOBAL(BC_INST_SEED)) bc_rand_push(&p->rng);
 #endif // BC_ENABLE_EXTRA_MATH
 }
 
 /**
  * Pops globals stacks on returning from a function, or in the case of reset,
  * pops all but one item on each global stack.
- * @param p      The program.
- * @param reset  True if all but one item on each stack should be popped, false
- *               otherwise.
+ * @param p        The program.
+ * @param globals  The globals that the function can modify, which are the ones
+ *                 that bc_program_prepGlobals() pushed. This is ignored on
+ *                 reset.
+ * @param reset    True if all but one item on each stack should be popped,
+ *                 false otherwise.
  */
 static void
-bc_program_popGlobals(BcProgram* p, bool reset)
+bc_program_popGlobals(BcProgram* p, uint8_t globals, bool reset)
 {
 	size_t i;
 
 	BC_SIG_ASSERT_LOCKED;
 
+	if (reset) globals = BC_FUNC_GLOBALS_ALL;
+
 	for (i = 0; i < BC_PROG_GLOBALS_LEN; ++i)
 	{
 		BcVec* v = p->globals_v + i;
+
+		if (!(globals & BC_FUNC_GLOBAL(BC_INST_IBASE + i))) continue;
+
 		bc_vec_npop(v, reset ? v->len - 1 : 1);
 		p->globals[i] = BC_PROG_GLOBAL(v);
 	}
 
 #if BC_ENABLE_EXTRA_MATH
-	bc_rand_pop(&p->rng, reset);
+	if (globals & BC_FUNC_GLOBAL(BC_INST_SEED)) bc_rand_pop(&p->rng, reset);
 #endif // BC_ENABLE_EXTRA_MATH
 }
 
@@ -269,11 +282,81 @@ bc_program_search(BcProgram* p, const char* name, bool var)
 	{
 		BcVec* temp = bc_vec_pushEmpty(v);
 		bc_array_init(temp, var);
+
+#if BC_ENABLED
+		// New variables are not used by any function yet.
+		if (BC_IS_BC && var)
+		{
+			bool dyn = false;
+			bc_vec_push(&p->var_dyn, &dyn);
+		}
+#endif // BC_ENABLED
 	}
 
 	return ((BcId*) bc_vec_item(map, i))->idx;
 }
 
+#if BC_ENABLED
+
+void
+bc_program_dynVar(BcProgram* p, size_t idx)
+{
+	size_t i, j;
+
+	// Functions are only defined when none are executing, which is good
+	// because the locals of executing functions could not be moved.
+	assert(p->stack.len == 1);
+
+	if (BC_PROG_VAR_DYN(p, idx)) return;
+
+	BC_PROG_VAR_DYN(p, idx) = true;
+
+	// Take every local with the name out of its slot.
+	for (i = 0; i < p->fns.len; ++i)
+	{
+		BcFunc* f = bc_vec_item(&p->fns, i);
+
+		for (j = 0; j < f->autos.len; ++j)
+		{
+			BcAuto* a = bc_vec_item(&f->autos, j);
+			if (a->idx == idx && a->type == BC_TYPE_VAR) a->slot = false;
+		}
+	}
+}
+
+size_t
+bc_program_readLocal(const BcProgram* p, size_t idx)
+{
+	size_t i, j, top = p->locals.len;
+
+	// The main function, at the bottom, has no locals.
+	for (i = p->stack.len - 1; i > 0; --i)
+	{
+		BcInstPtr* ip = bc_vec_item(&p->stack, i);
+		BcFunc* f = bc_vec_item(&p->fns, ip->func);
+
+		// Get the start of the frame of the function.
+		top -= f->autos.len;
+
+		for (j = 0; j < f->autos.len; ++j)
+		{
+			BcAuto* a = bc_vec_item(&f->autos, j);
+
+			if (a->idx != idx || a->type != BC_TYPE_VAR) continue;
+
+			// If the local is not in a slot, it is the top of the variable
+			// stack.
+			if (!a->slot) return BC_VEC_INVALID_IDX;
+
+			return p->locals.len - 1 - (top + j);
+		}
+	}
+
+	return BC_VEC_INVALID_IDX;
+}
+
+#endif // BC_ENABLED
+
 /**
  * Returns the correct variable or array stack for the type.
  * @param p     The program.
@@ -395,6 +478,14 @@ bc_program_num(BcProgram* p, BcResult* r)
 			break;
 		}
 
+#if BC_ENABLED
+		case BC_RESULT_LOCAL:
+		{
+			n = bc_vec_item(&p->locals, r->d.loc.loc);
+			break;
+		}
+#endif // BC_ENABLED
+
 		case BC_RESULT_ZERO:
 		{
 			n = &vm->zero;
@@ -649,21 +740,21 @@ bc_program_const(BcProgram* p, const char* code, size_t* bgn)
 	// Only reparse if the base changed.
 	if (c->base != base)
 	{
+		size_t len = strlen(c->val);
+
 		// Allocate if we haven't yet.
 		if (c->num.num == NULL)
 		{
 			// The plus 1 is in case of overflow with lack of clamping.
-			size_t len = strlen(c->val) + (BC_DIGIT_CLAMP == 0);
-
 			BC_SIG_LOCK;
-			bc_num_init(&c->num, BC_NUM_RDX(len));
+			bc_num_init(&c->num, BC_NUM_RDX(len + (BC_DIGIT_CLAMP == 0)));
 			BC_SIG_UNLOCK;
 		}
 		// We need to zero an already existing number.
 		else bc_num_zero(&c->num);
 
 		// bc_num_parse() should only do operations that cannot fail.
-		bc_num_parse(&c->num, c->val, base);
+		bc_num_parse(&c->num, c->val, len, base);
 
 		c->base = base;
 	}
@@ -775,6 +866,9 @@ bc_program_read(BcProgram* p)
 	// Set up the lexer and the read function.
 	bc_lex_file(&vm->read_prs.l, bc_program_stdin_name);
 	bc_vec_popAll(&f->code);
+#if BC_ENABLED
+	f->globals = 0;
+#endif // BC_ENABLED
 
 	// Read a line.
 	if (!BC_R) s = bc_read_line(&vm->read_buf, "");
@@ -797,11 +891,6 @@ bc_program_read(BcProgram* p)
 		bc_err(BC_ERR_EXEC_READ_EXPR);
 	}
 
-#if BC_ENABLED
-	// Push on the globals stack if necessary.
-	if (BC_G) bc_program_prepGlobals(p);
-#endif // BC_ENABLED
-
 	// Set up a new BcInstPtr.
 	ip.func = BC_PROG_READ;
 	ip.idx = 0;
@@ -810,6 +899,12 @@ bc_program_read(BcProgram* p)
 	// Update this pointer, just in case.
 	f = bc_vec_item(&p->fns, BC_PROG_READ);
 
+#if BC_ENABLED
+	// Push on the globals stack if necessary. The parser has just found which
+	// globals the expression can modify.
+	if (BC_G) bc_program_prepGlobals(p, f->globals);
+#endif // BC_ENABLED
+
 	// We want a return instruction to simplify things.
 	bc_vec_pushByte(&f->code, vm->read_ret);
 
@@ -1448,8 +1543,12 @@ bc_program_assign(BcProgram* p, uchar inst)
 		}
 #endif // BC_ENABLED
 
-		// If we are assigning to an array element...
+		// If we are assigning to an array element or a local in a slot...
+#if BC_ENABLED
+		if (left->t == BC_RESULT_ARRAY_ELEM || left->t == BC_RESULT_LOCAL)
+#else // BC_ENABLED
 		if (left->t == BC_RESULT_ARRAY_ELEM)
+#endif // BC_ENABLED
 		{
 			BC_SIG_LOCK;
 
@@ -1656,6 +1755,52 @@ bc_program_pushVar(BcProgram* p, const char* restrict code,
 	bc_vec_push(&p->results, &r);
 }
 
+#if BC_ENABLED
+
+/**
+ * Pushes a local variable onto the results stack. If the local is not in a
+ * slot, it is on its variable stack, so this pushes that instead.
+ * @param p     The program.
+ * @param f     The function that is executing.
+ * @param code  The bytecode vector to pull the local's offset out of.
+ * @param bgn   An in/out parameter; the start of the index in the bytecode
+ *              vector, and will be updated to point after the index on return.
+ */
+static void
+bc_program_pushLocal(BcProgram* p, const BcFunc* f, const char* restrict code,
+                     size_t* restrict bgn)
+{
+	BcResult r;
+	size_t off = bc_program_index(code, bgn);
+
+	// Only read() expressions reach past the locals of the function, and they
+	// only do so for locals in slots.
+	if (off < f->autos.len)
+	{
+		BcAuto* a = bc_vec_item_rev(&f->autos, off);
+
+		if (!a->slot)
+		{
+			BcVec* v = bc_program_vec(p, a->idx, BC_TYPE_VAR);
+
+			r.t = BC_RESULT_VAR;
+			r.d.loc.loc = a->idx;
+			r.d.loc.stack_idx = v->len - 1;
+
+			bc_vec_push(&p->results, &r);
+
+			return;
+		}
+	}
+
+	r.t = BC_RESULT_LOCAL;
+	r.d.loc.loc = p->locals.len - 1 - off;
+
+	bc_vec_push(&p->results, &r);
+}
+
+#endif // BC_ENABLED
+
 /**
  * Pushes an array or an array element onto the results stack.
  * @param p     The program.
@@ -1760,6 +1905,353 @@ exit:
 	BC_LONGJMP_CONT(vm);
 }
 
+/**
+ * Adds a number to a memo hash. Equal numbers can have different numbers of
+ * fractional limbs, so fractional limbs that are zero are skipped, and the
+ * others are hashed with their place after the radix.
+ * @param hash  The hash so far.
+ * @param n     The number to add.
+ * @return      The new hash.
+ */
+static size_t
+bc_program_memoHash(size_t hash, const BcNum* n)
+{
+	size_t i, rdx = BC_NUM_RDX_VAL(n);
+
+	hash = hash * 31 + n->scale;
+	hash = hash * 31 + (BC_NUM_NEG(n) != 0);
+
+	for (i = 0; i < rdx; ++i)
+	{
+		if (!n->num[i]) continue;
+		hash = hash * 31 + (rdx - i);
+		hash = hash * 31 + (size_t) n->num[i];
+	}
+
+	for (i = rdx; i < n->len; ++i)
+	{
+		hash = hash * 31 + (size_t) n->num[i];
+	}
+
+	return hash;
+}
+
+/**
+ * Returns true if two numbers are the same memo key. They must have the same
+ * scale as well as the same value, since a function can look at the scale.
+ * @param a  The first number.
+ * @param b  The second number.
+ * @return   True if @a a and @a b are the same key, false otherwise.
+ */
+static bool
+bc_program_memoEq(const BcNum* a, const BcNum* b)
+{
+	return a->scale == b->scale && !bc_num_cmp(a, b);
+}
+
+/**
+ * Looks up a call to a pure function in its memo. If the result is there, the
+ * arguments are replaced by it. Otherwise, the call is recorded so that
+ * bc_program_return() can memoize its result.
+ * @param p      The program.
+ * @param f      The pure function.
+ * @param nargs  The number of arguments on the results stack.
+ * @return       True if the result was in the memo, false otherwise.
+ */
+static bool
+bc_program_memoFind(BcProgram* p, BcFunc* f, size_t nargs)
+{
+	BcMemoCall call;
+	BcMemo* m;
+	BcNum* n;
+	BcResult* res;
+	size_t i, j, idx, args = p->results.len - nargs;
+
+	// NOLINTNEXTLINE
+	memcpy(call.globals, p->globals, sizeof(call.globals));
+
+	call.stack_len = p->stack.len + 1;
+	call.impure = false;
+	call.hash = 0;
+
+	for (i = 0; i < BC_MEMO_GLOBALS; ++i)
+	{
+		call.hash = call.hash * 31 + (size_t) call.globals[i];
+	}
+
+	for (i = 0; i < nargs; ++i)
+	{
+		res = bc_vec_item(&p->results, args + i);
+
+		// Anything that is not a number is left for bc_program_call() to deal
+		// with. That may just be an error.
+		if (res->t == BC_RESULT_VOID || res->t == BC_RESULT_ARRAY) return false;
+
+		n = bc_program_num(p, res);
+		if (BC_PROG_STR(n)) return false;
+
+		call.hash = bc_program_memoHash(call.hash, n);
+	}
+
+	// The table is empty until the first result is memoized.
+	idx = f->memo_table.len ?
+	          *((size_t*) bc_vec_item(&f->memo_table,
+	                                  BC_PROG_MEMO_BUCKET(call.hash))) :
+	          BC_MEMO_NONE;
+
+	for (; idx != BC_MEMO_NONE; idx = m->next)
+	{
+		m = bc_vec_item(&f->memo, idx);
+
+		if (m->hash != call.hash ||
+		    memcmp(m->globals, call.globals, sizeof(call.globals)))
+		{
+			continue;
+		}
+
+		n = bc_vec_item(&f->memo_nums, idx * (nargs + 1));
+
+		for (j = 0; j < nargs; ++j)
+		{
+			res = bc_vec_item(&p->results, args + j);
+			if (!bc_program_memoEq(bc_program_num(p, res), n + j)) break;
+		}
+
+		if (j < nargs) continue;
+
+		m->used = true;
+
+		BC_SIG_LOCK;
+
+		// Replace the arguments with a copy of the result.
+		bc_vec_npop(&p->results, nargs);
+		res = bc_program_prepResult(p);
+		bc_num_createCopy(&res->d.n, n + nargs);
+
+		BC_SIG_UNLOCK;
+
+		return true;
+	}
+
+	BC_SIG_LOCK;
+
+	bc_vec_push(&p->memos, &call);
+
+	for (i = 0; i < nargs; ++i)
+	{
+		res = bc_vec_item(&p->results, args + i);
+		n = bc_vec_pushEmpty(&p->memo_args);
+		bc_num_createCopy(n, bc_program_num(p, res));
+	}
+
+	BC_SIG_UNLOCK;
+
+	return false;
+}
+
+/**
+ * Finishes a call recorded by bc_program_memoFind(), memoizing the result if
+ * nothing made it impure. The result must be on top of the results stack.
+ * @param p  The program.
+ * @param f  The pure function that is returning.
+ */
+static void
+bc_program_memoSave(BcProgram* p, BcFunc* f)
+{
+	BcMemoCall* call = bc_vec_top(&p->memos);
+	BcResult* res = bc_vec_top(&p->results);
+	BcNum* n;
+	BcMemo* m;
+	size_t* bucket;
+	size_t i, idx, nargs = f->nparams, args = p->memo_args.len - nargs;
+	bool impure;
+
+	BC_SIG_ASSERT_LOCKED;
+
+	// Changing ibase, obase, or scale for the caller is a side effect, and so
+	// is returning a string.
+	impure = (call->impure || res->t == BC_RESULT_STR ||
+	          memcmp(call->globals, p->globals, sizeof(call->globals)));
+
+	if (!impure)
+	{
+		// Create the table with every bucket empty.
+		if (!f->memo_table.len)
+		{
+			idx = BC_MEMO_NONE;
+
+			bc_vec_expand(&f->memo_table, BC_PROG_MEMO_MAX);
+
+			for (i = 0; i < BC_PROG_MEMO_MAX; ++i)
+			{
+				bc_vec_push(&f->memo_table, &idx);
+			}
+		}
+
+		if (f->memo.len < BC_PROG_MEMO_MAX)
+		{
+			idx = f->memo.len;
+			m = bc_vec_pushEmpty(&f->memo);
+
+			for (i = 0; i < nargs; ++i)
+			{
+				n = bc_vec_pushEmpty(&f->memo_nums);
+				bc_num_createCopy(n, bc_vec_item(&p->memo_args, args + i));
+			}
+
+			n = bc_vec_pushEmpty(&f->memo_nums);
+			bc_num_createCopy(n, &res->d.n);
+		}
+		else
+		{
+			// Move the clock hand to the first entry that was not used since
+			// the hand last passed it, clearing the used flag of the others.
+			// Each flag that is cleared was set by a use, so this takes
+			// constant time on average.
+			for (;;)
+			{
+				m = bc_vec_item(&f->memo, f->memo_hand);
+				if (!m->used) break;
+				m->used = false;
+				f->memo_hand = (f->memo_hand + 1) % BC_PROG_MEMO_MAX;
+			}
+
+			idx = f->memo_hand;
+			f->memo_hand = (f->memo_hand + 1) % BC_PROG_MEMO_MAX;
+
+			// Unlink the entry from its bucket. Buckets are short, so this
+			// takes constant time on average too.
+			bucket = bc_vec_item(&f->memo_table, BC_PROG_MEMO_BUCKET(m->hash));
+			while (*bucket != idx)
+			{
+				bucket = &((BcMemo*) bc_vec_item(&f->memo, *bucket))->next;
+			}
+			*bucket = m->next;
+
+			n = bc_vec_item(&f->memo_nums, idx * (nargs + 1));
+
+			for (i = 0; i < nargs; ++i)
+			{
+				bc_num_copy(n + i, bc_vec_item(&p->memo_args, args + i));
+			}
+
+			bc_num_copy(n + nargs, &res->d.n);
+		}
+
+		// Link the entry at the front of its bucket.
+		bucket = bc_vec_item(&f->memo_table, BC_PROG_MEMO_BUCKET(call->hash));
+		m->hash = call->hash;
+		m->next = *bucket;
+		m->used = true;
+		*bucket = idx;
+
+		// NOLINTNEXTLINE
+		memcpy(m->globals, call->globals, sizeof(m->globals));
+	}
+
+	bc_vec_npop(&p->memo_args, nargs);
+	bc_vec_pop(&p->memos);
+
+	// Whatever made this call impure happened inside of any outer pure call.
+	if (impure && p->memos.len)
+	{
+		call = bc_vec_top(&p->memos);
+		call->impure = true;
+	}
+}
+
+/**
+ * Moves the argument on top of the results stack into the slot of a parameter.
+ * @param p  The program.
+ * @param n  The slot of the parameter. It must be cleared.
+ */
+static void
+bc_program_copyToLocal(BcProgram* p, BcNum* n)
+{
+	BcResult* ptr;
+	BcNum* num;
+	bool move;
+
+	bc_program_operand(p, &ptr, &num, 0);
+	bc_program_type_match(ptr, BC_TYPE_VAR);
+
+	// Temporaries, like in assignment, are not needed anymore, so their
+	// numbers can just be moved. Strings have nothing to copy.
+	move = (ptr->t == BC_RESULT_TEMP || ptr->t >= BC_RESULT_IBASE);
+
+	BC_SIG_LOCK;
+
+	if (move || BC_PROG_STR(num))
+	{
+		// NOLINTNEXTLINE
+		memcpy(n, num, sizeof(BcNum));
+
+		// This prevents the number from being freed.
+		if (move) ptr->t = BC_RESULT_ZERO;
+	}
+	else bc_num_createCopy(n, num);
+
+	bc_vec_pop(&p->results);
+
+	BC_SIG_UNLOCK;
+}
+
+/**
+ * Returns true if a call can replace the frame of its caller instead of
+ * pushing a new one. That is only true when the call is immediately returned,
+ * as in `return f(x)`, and when nothing could tell the difference: the caller
+ * must have nothing to restore on return, and the callee must not be able to
+ * see the caller's locals by name.
+ * @param p      The program.
+ * @param f      The function being called.
+ * @param nargs  The number of arguments on the results stack.
+ * @param code   The bytecode vector of the caller.
+ * @param idx    The index of the instruction after the call.
+ * @return       True if the call is a tail call, false otherwise.
+ */
+static bool
+bc_program_isTailCall(BcProgram* p, const BcFunc* f, size_t nargs,
+                      const char* restrict code, size_t idx)
+{
+	BcInstPtr* ip = bc_vec_top(&p->stack);
+	BcFunc* caller;
+	size_t i;
+
+	// main() and read() have no frames to replace. Every other function ends
+	// with a return, so there is always an instruction after the call.
+	if (ip->func == BC_PROG_MAIN || ip->func == BC_PROG_READ) return false;
+	if ((uchar) code[idx] != BC_INST_RET) return false;
+
+	// Pure calls need their own frame to be memoized, and returning the result
+	// of a void function is an error that needs to happen in the caller.
+	if (f->pure || f->voidfn) return false;
+
+	// There should be nothing but the arguments on the results stack.
+	if (p->results.len - nargs != ip->len) return false;
+
+	caller = bc_vec_item(&p->fns, ip->func);
+
+	// The caller's globals would need to be restored when it returns.
+	if (BC_G && caller->globals) return false;
+
+	// The caller might be memoized when it returns.
+	if (p->memos.len)
+	{
+		BcMemoCall* call = bc_vec_top(&p->memos);
+		if (call->stack_len == p->stack.len) return false;
+	}
+
+	// Locals that are not in slots, including all arrays, are visible to the
+	// callee through dynamic scoping.
+	for (i = 0; i < caller->autos.len; ++i)
+	{
+		BcAuto* a = bc_vec_item(&caller->autos, i);
+		if (!a->slot) return false;
+	}
+
+	return true;
+}
+
 /**
  * Executes a function call for bc.
  * @param p     The program.
@@ -1773,11 +2265,13 @@ static void
 bc_program_call(BcProgram* p, const char* restrict code, size_t* restrict bgn)
 {
 	BcInstPtr ip;
-	size_t i, nargs;
+	size_t i, nargs, base;
 	BcFunc* f;
 	BcVec* v;
 	BcAuto* a;
 	BcResult* arg;
+	BcNum* n;
+	bool tail;
 
 	// Pull the number of arguments out of the bytecode vector.
 	nargs = bc_program_index(code, bgn);
@@ -1794,40 +2288,84 @@ bc_program_call(BcProgram* p, const char* restrict code, size_t* restrict bgn)
 		bc_verr(BC_ERR_EXEC_PARAMS, f->nparams, nargs);
 	}
 
+	// A pure function might not need to be called at all. And calling any
+	// other function means that outer pure calls cannot be memoized.
+	if (f->pure)
+	{
+		if (bc_program_memoFind(p, f, nargs)) return;
+	}
+	else if (p->memos.len)
+	{
+		BcMemoCall* call = bc_vec_top(&p->memos);
+		call->impure = true;
+	}
+
 	// Set the length of the results stack. We discount the argument, of course.
 	ip.len = p->results.len - nargs;
 
 	assert(BC_PROG_STACK(&p->results, nargs));
 
+	tail = bc_program_isTailCall(p, f, nargs, code, *bgn);
+
 	// Prepare the globals' stacks.
-	if (BC_G) bc_program_prepGlobals(p);
+	if (BC_G) bc_program_prepGlobals(p, f->globals);
+
+	BC_SIG_LOCK;
+
+	// Push the frame of the function, with every local cleared. This is done
+	// first because pushing could move the locals of the caller, which the
+	// arguments could be.
+	base = p->locals.len;
+
+	for (i = 0; i < f->autos.len; ++i)
+	{
+		n = bc_vec_pushEmpty(&p->locals);
+		bc_num_clear(n);
+	}
+
+	BC_SIG_UNLOCK;
 
-	// Push the arguments onto the stacks of their respective parameters.
+	// Push the arguments into the slots or onto the stacks of their respective
+	// parameters.
 	for (i = 0; i < nargs; ++i)
 	{
+		size_t idx = nargs - 1 - i;
+
 		arg = bc_vec_top(&p->results);
 		if (BC_ERR(arg->t == BC_RESULT_VOID)) bc_err(BC_ERR_EXEC_VOID_VAL);
 
 		// Get the corresponding parameter.
-		a = bc_vec_item(&f->autos, nargs - 1 - i);
+		a = bc_vec_item(&f->autos, idx);
 
-		// Actually push the value onto the parameter's stack.
-		bc_program_copyToVar(p, a->idx, a->type);
+		// Actually put the value in the parameter.
+		if (a->slot)
+		{
+			bc_program_copyToLocal(p, bc_vec_item(&p->locals, base + idx));
+		}
+		else bc_program_copyToVar(p, a->idx, a->type);
 	}
 
 	BC_SIG_LOCK;
 
-	// Push zeroes onto the stacks of the auto variables.
+	// Set the auto variables to 0.
 	for (; i < f->autos.len; ++i)
 	{
 		// Get the auto and its stack.
 		a = bc_vec_item(&f->autos, i);
+
+		// Variables in slots just need their slot initialized.
+		if (a->slot)
+		{
+			bc_num_init(bc_vec_item(&p->locals, base + i), BC_NUM_DEF_SIZE);
+			continue;
+		}
+
 		v = bc_program_vec(p, a->idx, a->type);
 
 		// If a variable, just push a 0; otherwise, push an array.
 		if (a->type == BC_TYPE_VAR)
 		{
-			BcNum* n = bc_vec_pushEmpty(v);
+			n = bc_vec_pushEmpty(v);
 			bc_num_init(n, BC_NUM_DEF_SIZE);
 		}
 		else
@@ -1841,8 +2379,38 @@ bc_program_call(BcProgram* p, const char* restrict code, size_t* restrict bgn)
 		}
 	}
 
+	if (tail)
+	{
+		BcInstPtr* top = bc_vec_top(&p->stack);
+		BcFunc* caller = bc_vec_item(&p->fns, top->func);
+		BcTailCall* t;
+
+		// Pop the frame of the caller, which is below the new one, now that the
+		// arguments are out of it. All of its locals are in slots, so there are
+		// no other stacks to pop. Then the callee takes the caller's place on
+		// the execution stack.
+		if (f->autos.len)
+		{
+			bc_vec_npopAt(&p->locals, caller->autos.len,
+			              base - caller->autos.len);
+		}
+		else bc_vec_npop(&p->locals, caller->autos.len);
+		*top = ip;
+
+		// Count the tail call for stack traces.
+		t = p->tails.len ? bc_vec_top(&p->tails) : NULL;
+
+		if (t == NULL || t->stack_len != p->stack.len)
+		{
+			t = bc_vec_pushEmpty(&p->tails);
+			t->stack_len = p->stack.len;
+			t->calls = 0;
+		}
+
+		t->calls += 1;
+	}
 	// Push the instruction pointer onto the execution stack.
-	bc_vec_push(&p->stack, &ip);
+	else bc_vec_push(&p->stack, &ip);
 
 	BC_SIG_UNLOCK;
 }
@@ -1922,18 +2490,40 @@ bc_program_return(BcProgram* p, uchar inst)
 	for (i = 0; i < f->autos.len; ++i)
 	{
 		BcAuto* a = bc_vec_item(&f->autos, i);
-		BcVec* v = bc_program_vec(p, a->idx, a->type);
+		BcVec* v;
 
+		if (a->slot) continue;
+
+		v = bc_program_vec(p, a->idx, a->type);
 		bc_vec_pop(v);
 	}
 
 	BC_SIG_LOCK;
 
+	// Pop the frame. This frees the locals in slots.
+	bc_vec_npop(&p->locals, f->autos.len);
+
 	// When we retire, pop all of the unused results.
 	bc_program_retire(p, 1, nresults);
 
 	// Pop the globals, if necessary.
-	if (BC_G) bc_program_popGlobals(p, false);
+	if (BC_G) bc_program_popGlobals(p, f->globals, false);
+
+	// If this is a call recorded by bc_program_memoFind(), finish it. This
+	// happens after popping the globals so that ibase, obase, and scale are
+	// what the caller will see.
+	if (p->memos.len)
+	{
+		BcMemoCall* call = bc_vec_top(&p->memos);
+		if (call->stack_len == p->stack.len) bc_program_memoSave(p, f);
+	}
+
+	// Forget the tail calls that replaced this frame.
+	if (p->tails.len)
+	{
+		BcTailCall* t = bc_vec_top(&p->tails);
+		if (t->stack_len == p->stack.len) bc_vec_pop(&p->tails);
+	}
 
 	// Pop the stack. This is what causes the function to actually "return."
 	bc_vec_pop(&p->stack);
@@ -1956,11 +2546,7 @@ bc_program_builtin(BcProgram* p, uchar inst)
 	bool len = (inst == BC_INST_LENGTH);
 
 	// Ensure we have a valid builtin.
-#if BC_ENABLE_EXTRA_MATH
-	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_IRAND);
-#else // BC_ENABLE_EXTRA_MATH
-	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_IS_STRING);
-#endif // BC_ENABLE_EXTRA_MATH
+	assert(inst >= BC_INST_LENGTH && inst <= BC_INST_FIB);
 
 #ifndef BC_PROG_NO_STACK_CHECK
 	// Check stack for dc.
@@ -2039,6 +2625,18 @@ bc_program_builtin(BcProgram* p, uchar inst)
 
 #endif // BC_ENABLE_EXTRA_MATH
 
+	// fib() is easy too.
+	else if (inst == BC_INST_FIB)
+	{
+		BC_SIG_LOCK;
+
+		bc_num_init(&res->d.n, BC_NUM_DEF_SIZE);
+
+		BC_SIG_UNLOCK;
+
+		bc_num_fib(num, &res->d.n, BC_PROG_SCALE(p));
+	}
+
 	// Everything else is...not easy.
 	else
 	{
@@ -2147,6 +2745,36 @@ bc_program_divmod(BcProgram* p)
 	bc_program_retire(p, 2, 2);
 }
 
+/**
+ * Executes a builtin that takes two numbers, like root() or gcd().
+ * @param p     The program.
+ * @param inst  The instruction corresponding to the builtin.
+ */
+static void
+bc_program_func(BcProgram* p, uchar inst)
+{
+	BcResult* opd1;
+	BcResult* opd2;
+	BcResult* res;
+	BcNum* n1;
+	BcNum* n2;
+
+	res = bc_program_prepResult(p);
+
+	bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2, 1);
+
+	BC_SIG_LOCK;
+
+	// These functions expand the result as needed.
+	bc_num_init(&res->d.n, BC_NUM_DEF_SIZE);
+
+	BC_SIG_UNLOCK;
+
+	bc_program_funcs[inst - BC_INST_ROOT](n1, n2, &res->d.n, BC_PROG_SCALE(p));
+
+	bc_program_retire(p, 1, 2);
+}
+
 /**
  * Executes modular exponentiation.
  * @param p  The program.
@@ -2795,8 +3423,17 @@ bc_program_insertFunc(BcProgram* p, const char* name)
 	// bc has to reset the function because it's about to be redefined.
 	else if (BC_IS_BC)
 	{
+		size_t i;
 		BcFunc* func = bc_vec_item(&p->fns, idx);
+
 		bc_func_reset(func);
+
+		// Memoized results could depend on the old definition through calls.
+		for (i = 0; i < p->fns.len; ++i)
+		{
+			func = bc_vec_item(&p->fns, i);
+			bc_func_forget(func);
+		}
 	}
 #endif // BC_ENABLED
 
@@ -2839,7 +3476,15 @@ bc_program_free(BcProgram* p)
 	bc_num_free(&p->asciify);
 
 #if BC_ENABLED
-	if (BC_IS_BC) bc_num_free(&p->last);
+	if (BC_IS_BC)
+	{
+		bc_num_free(&p->last);
+		bc_vec_free(&p->memos);
+		bc_vec_free(&p->memo_args);
+		bc_vec_free(&p->locals);
+		bc_vec_free(&p->var_dyn);
+		bc_vec_free(&p->tails);
+	}
 #endif // BC_ENABLED
 
 #if BC_ENABLE_EXTRA_MATH
@@ -2904,7 +3549,15 @@ bc_program_init(BcProgram* p)
 #endif // BC_ENABLE_EXTRA_MATH
 
 #if BC_ENABLED
-	if (BC_IS_BC) bc_num_init(&p->last, BC_NUM_DEF_SIZE);
+	if (BC_IS_BC)
+	{
+		bc_num_init(&p->last, BC_NUM_DEF_SIZE);
+		bc_vec_init(&p->memos, sizeof(BcMemoCall), BC_DTOR_NONE);
+		bc_vec_init(&p->memo_args, sizeof(BcNum), BC_DTOR_NUM);
+		bc_vec_init(&p->locals, sizeof(BcNum), BC_DTOR_NUM);
+		bc_vec_init(&p->var_dyn, sizeof(bool), BC_DTOR_NONE);
+		bc_vec_init(&p->tails, sizeof(BcTailCall), BC_DTOR_NONE);
+	}
 #endif // BC_ENABLED
 
 #if BC_DEBUG
@@ -2938,6 +3591,9 @@ void
 bc_program_printStackTrace(BcProgram* p)
 {
 	size_t i, max_digits;
+#if BC_ENABLED
+	size_t tail = 0;
+#endif // BC_ENABLED
 
 	max_digits = bc_vm_numDigits(p->stack.len - 1);
 
@@ -2963,6 +3619,18 @@ bc_program_printStackTrace(BcProgram* p)
 		{
 			bc_file_puts(&vm->ferr, bc_flush_none, "()");
 		}
+
+		// Show how many frames were replaced by tail calls in this one.
+		if (BC_IS_BC && tail < p->tails.len)
+		{
+			BcTailCall* t = bc_vec_item_rev(&p->tails, tail);
+
+			if (t->stack_len == p->stack.len - i)
+			{
+				bc_file_printf(&vm->ferr, " (tail calls: %zu)", t->calls);
+				tail += 1;
+			}
+		}
 #endif // BC_ENABLED
 
 		bc_file_putchar(&vm->ferr, bc_flush_none, '\n');
@@ -2988,7 +3656,16 @@ bc_program_reset(BcProgram* p)
 
 #if BC_ENABLED
 	// Clear the globals' stacks.
-	if (BC_G) bc_program_popGlobals(p, true);
+	if (BC_G) bc_program_popGlobals(p, BC_FUNC_GLOBALS_ALL, true);
+
+	// Forget the pure calls that were executing, and pop their frames.
+	if (BC_IS_BC)
+	{
+		bc_vec_popAll(&p->memos);
+		bc_vec_popAll(&p->memo_args);
+		bc_vec_popAll(&p->locals);
+		bc_vec_popAll(&p->tails);
+	}
 #endif // BC_ENABLED
 
 	// Clear the bytecode vector of the main function.
@@ -3288,6 +3965,16 @@ bc_program_exec(BcProgram* p)
 				BC_PROG_JUMP(inst, code, ip);
 			}
 
+#if BC_ENABLED
+			// clang-format off
+			BC_PROG_LBL(BC_INST_LOCAL):
+			// clang-format on
+			{
+				bc_program_pushLocal(p, func, code, &ip->idx);
+				BC_PROG_JUMP(inst, code, ip);
+			}
+#endif // BC_ENABLED
+
 			// clang-format off
 			BC_PROG_LBL(BC_INST_ARRAY_ELEM):
 			BC_PROG_LBL(BC_INST_ARRAY):
@@ -3327,6 +4014,7 @@ bc_program_exec(BcProgram* p)
 #if BC_ENABLE_EXTRA_MATH
 			BC_PROG_LBL(BC_INST_IRAND):
 #endif // BC_ENABLE_EXTRA_MATH
+			BC_PROG_LBL(BC_INST_FIB):
 			// clang-format on
 			{
 				bc_program_builtin(p, inst);
@@ -3530,6 +4218,19 @@ bc_program_exec(BcProgram* p)
 				BC_PROG_JUMP(inst, code, ip);
 			}
 
+			// clang-format off
+			BC_PROG_LBL(BC_INST_ROOT):
+			BC_PROG_LBL(BC_INST_GCD):
+			BC_PROG_LBL(BC_INST_LCM):
+			BC_PROG_LBL(BC_INST_MODINV):
+			BC_PROG_LBL(BC_INST_PERM):
+			BC_PROG_LBL(BC_INST_COMB):
+			// clang-format on
+			{
+				bc_program_func(p, inst);
+				BC_PROG_JUMP(inst, code, ip);
+			}
+
 			// clang-format off
 			BC_PROG_LBL(BC_INST_PRINT_STREAM):
 			// clang-format on
@@ -3795,7 +4496,7 @@ bc_program_printInst(const BcProgram* p, const char* restrict code,
 	             (unsigned long) inst);
 
 	if (inst == BC_INST_VAR || inst == BC_INST_ARRAY_ELEM ||
-	    inst == BC_INST_ARRAY)
+	    inst == BC_INST_ARRAY || inst == BC_INST_LOCAL)
 	{
 		bc_program_printIndex(code, bgn);
 	}
@@ -916,6 +916,20 @@ bc_vm_putchar(int c, BcFlushType type)
 #endif // BC_ENABLE_LIBRARY
 }
 
+void
+bc_vm_write(const char* buf, size_t n, BcFlushType type)
+{
+	assert(memchr(buf, '\n', n) == NULL);
+
+#if BC_ENABLE_LIBRARY
+	BcVm* vm = bcl_getspecific();
+	bc_vec_npush(&vm->out, n, buf);
+#else // BC_ENABLE_LIBRARY
+	bc_file_write(&vm->fout, type, buf, n);
+	vm->nchars = (uint16_t) (vm->nchars + n);
+#endif // BC_ENABLE_LIBRARY
+}
+
 #if !BC_ENABLE_LIBRARY
 
 #ifdef __OpenBSD__
@@ -1605,6 +1619,9 @@ bc_vm_boot(int argc, char* argv[])
 	bc_file_init(&vm->fout, STDOUT_FILENO, output_bufs, BC_VM_STDOUT_BUF_SIZE,
 	             false);
 
+	// If nobody is watching stdout, we can let it buffer more between flushes.
+	if (!ttyout) bc_file_setMax(&vm->fout, BC_VM_STDOUT_BUF_MAX);
+
 	// Set the input buffer to the rest of the global buffer.
 	vm->buf = output_bufs + BC_VM_STDOUT_BUF_SIZE + BC_VM_STDERR_BUF_SIZE;
 #endif // BC_ENABLE_LINE_LIB
@@ -1797,17 +1814,13 @@ bc_vm_init(void)
 void
 bc_vm_atexit(void)
 {
-#if BC_DEBUG
-#if BC_ENABLE_LIBRARY
 	BcVm* vm = bcl_getspecific();
-#endif // BC_ENABLE_LIBRARY
-#endif // BC_DEBUG
 
 	bc_vm_shutdown();
 
-#if BC_DEBUG
+	// The vm is freed right after this, and with thread pools, there can be
+	// many of them, so this must be freed even in release builds.
 	bc_vec_free(&vm->jmp_bufs);
-#endif // BC_DEBUG
 }
 #else // BC_ENABLE_LIBRARY
 BcStatus